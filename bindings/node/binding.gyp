@@ -5,8 +5,10 @@
       "sources": [
         "src/addon.cpp",
         "../../src/audio_utils.cpp",
+        "../../src/audio_sink.cpp",
         "../../src/tokenizer.cpp",
         "../../src/pocket_tts.cpp",
+        "../../src/voice_store.cpp",
         "../../src/pocket_tts_c.cpp"
       ],
       "dependencies": [
@@ -11,4 +11,66 @@ if (process.platform === "win32") {
   }
 }
 
-module.exports = load(path.join(__dirname));
+const addon = load(path.join(__dirname));
+
+// Async iterator over streamed chunks (Float32Array each). The native side
+// stops generating once `highWaterMark` chunks are waiting here, and
+// breaking out of the loop cancels the generation.
+addon.PocketTTS.prototype.stream = function stream(text, voice, options = {}) {
+  const queue = [];
+  let pending = null;
+  let finished = false;
+  let failure = null;
+
+  const flush = () => {
+    if (!pending) return;
+    if (queue.length > 0) {
+      const { resolve } = pending;
+      pending = null;
+      controller.consumed();
+      resolve({ value: queue.shift(), done: false });
+    } else if (finished) {
+      const { resolve, reject } = pending;
+      pending = null;
+      if (failure) {
+        const error = failure;
+        failure = null;
+        reject(error);
+      } else {
+        resolve({ value: undefined, done: true });
+      }
+    }
+  };
+
+  const controller = this.generateStreaming(text, voice, options, (error, samples) => {
+    if (samples) {
+      queue.push(samples);
+    } else {
+      finished = true;
+      failure = error;
+    }
+    flush();
+  });
+
+  return {
+    [Symbol.asyncIterator]() {
+      return this;
+    },
+    next() {
+      if (pending) {
+        return Promise.reject(new Error("stream(): wait for the previous next() to settle"));
+      }
+      return new Promise((resolve, reject) => {
+        pending = { resolve, reject };
+        flush();
+      });
+    },
+    return() {
+      if (!finished) controller.cancel();
+      queue.length = 0;
+      return Promise.resolve({ value: undefined, done: true });
+    }
+  };
+};
+
+module.exports = addon;
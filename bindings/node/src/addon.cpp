@@ -2,8 +2,15 @@
 
 #include "pocket_tts/pocket_tts_c.h"
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace {
 
@@ -16,6 +23,254 @@ void throwLastError(const Napi::Env& env, const std::string& prefix) {
     }
 }
 
+Napi::Object statsToObject(const Napi::Env& env, const PocketTTSStats& stats) {
+    auto session = [&env](int runs, double ms) {
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("runs", Napi::Number::New(env, runs));
+        obj.Set("totalMs", Napi::Number::New(env, ms));
+        return obj;
+    };
+
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("textTokens", Napi::Number::New(env, stats.text_tokens));
+    obj.Set("framesGenerated", Napi::Number::New(env, stats.frames_generated));
+    obj.Set("eosStep", Napi::Number::New(env, stats.eos_step));
+    obj.Set("audioSamples", Napi::Number::New(env, stats.audio_samples));
+    obj.Set("voicePrefixCached", Napi::Boolean::New(env, stats.voice_prefix_cached != 0));
+    obj.Set("textConditioner", session(stats.text_conditioner_runs, stats.text_conditioner_ms));
+    obj.Set("flowLmMain", session(stats.flow_lm_main_runs, stats.flow_lm_main_ms));
+    obj.Set("flowLmFlow", session(stats.flow_lm_flow_runs, stats.flow_lm_flow_ms));
+    obj.Set("mimiDecoder", session(stats.mimi_decoder_runs, stats.mimi_decoder_ms));
+    obj.Set("stateBytesCopied", Napi::Number::New(env, static_cast<double>(stats.state_bytes_copied)));
+    obj.Set("stateBytesAllocated", Napi::Number::New(env, static_cast<double>(stats.state_bytes_allocated)));
+    obj.Set("timeToFirstAudioMs", Napi::Number::New(env, stats.time_to_first_audio_ms));
+    obj.Set("totalMs", Napi::Number::New(env, stats.total_ms));
+    obj.Set("textCached", Napi::Boolean::New(env, stats.text_cached != 0));
+    obj.Set("audioCached", Napi::Boolean::New(env, stats.audio_cached != 0));
+    // BigInt: random seeds use 63 bits, more than a Number holds exactly
+    obj.Set("seed", Napi::BigInt::New(env, stats.seed));
+    obj.Set("lmStateBytes", Napi::Number::New(env, static_cast<double>(stats.lm_state_bytes)));
+    obj.Set("contextReprimes", Napi::Number::New(env, stats.context_reprimes));
+    obj.Set("prefetched", Napi::Boolean::New(env, stats.prefetched != 0));
+    obj.Set("cancelled", Napi::Boolean::New(env, stats.cancelled != 0));
+    return obj;
+}
+
+// A seed given as a Number or BigInt; false (with a pending exception) if invalid
+bool parseSeed(const Napi::Env& env, const Napi::Value& value, uint64_t& seed) {
+    if (value.IsBigInt()) {
+        bool lossless = false;
+        seed = value.As<Napi::BigInt>().Uint64Value(&lossless);
+        if (lossless && seed <= static_cast<uint64_t>(INT64_MAX)) return true;
+    } else if (value.IsNumber()) {
+        const double number = value.As<Napi::Number>().DoubleValue();
+        if (number >= 0 && number <= 9007199254740991.0 && number == static_cast<double>(static_cast<uint64_t>(number))) {
+            seed = static_cast<uint64_t>(number);
+            return true;
+        }
+    }
+    Napi::RangeError::New(env, "seed must be a non-negative integer below 2^63").ThrowAsJavaScriptException();
+    return false;
+}
+
+// Owns the strings a PocketTTSConfig points into
+struct ParsedConfig {
+    PocketTTSConfig config {};
+    bool useConfig = false;
+    std::string modelsDir;
+    std::string tokenizerPath;
+    std::string precision;
+    std::string threadAffinity;
+    std::string executionProvider;
+    std::string optimizedModelCacheDir;
+    std::string arenaExtendStrategy;
+
+    const PocketTTSConfig* get() const {
+        return useConfig ? &config : nullptr;
+    }
+};
+
+bool parseConfig(const Napi::Env& env, const Napi::Value& value, ParsedConfig& parsed) {
+    if (value.IsUndefined() || value.IsNull()) {
+        return true;
+    }
+
+    if (!value.IsObject()) {
+        Napi::TypeError::New(env, "config must be an object").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    Napi::Object cfg = value.As<Napi::Object>();
+
+    if (cfg.Has("modelsDir")) {
+        parsed.modelsDir = cfg.Get("modelsDir").As<Napi::String>().Utf8Value();
+        parsed.config.models_dir = parsed.modelsDir.c_str();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("tokenizerPath")) {
+        parsed.tokenizerPath = cfg.Get("tokenizerPath").As<Napi::String>().Utf8Value();
+        parsed.config.tokenizer_path = parsed.tokenizerPath.c_str();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("precision")) {
+        parsed.precision = cfg.Get("precision").As<Napi::String>().Utf8Value();
+        parsed.config.precision = parsed.precision.c_str();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("temperature")) {
+        parsed.config.temperature = cfg.Get("temperature").As<Napi::Number>().FloatValue();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("lsdSteps")) {
+        parsed.config.lsd_steps = cfg.Get("lsdSteps").As<Napi::Number>().Int32Value();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("flowSolver")) {
+        const std::string solver = cfg.Get("flowSolver").As<Napi::String>().Utf8Value();
+        if (solver != "euler" && solver != "heun") {
+            Napi::TypeError::New(env, "flowSolver must be \"euler\" or \"heun\"").ThrowAsJavaScriptException();
+            return false;
+        }
+        parsed.config.flow_solver = solver == "heun" ? POCKET_TTS_FLOW_HEUN : POCKET_TTS_FLOW_EULER;
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("flowSchedule")) {
+        const std::string schedule = cfg.Get("flowSchedule").As<Napi::String>().Utf8Value();
+        if (schedule == "uniform") {
+            parsed.config.flow_schedule = POCKET_TTS_SCHEDULE_UNIFORM;
+        } else if (schedule == "cosine") {
+            parsed.config.flow_schedule = POCKET_TTS_SCHEDULE_COSINE;
+        } else if (schedule == "quadratic") {
+            parsed.config.flow_schedule = POCKET_TTS_SCHEDULE_QUADRATIC;
+        } else {
+            Napi::TypeError::New(env, "flowSchedule must be \"uniform\", \"cosine\" or \"quadratic\"")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("postEosSteps")) {
+        parsed.config.post_eos_lsd_steps = cfg.Get("postEosSteps").As<Napi::Number>().Int32Value();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("seed")) {
+        if (!parseSeed(env, cfg.Get("seed"), parsed.config.seed)) {
+            return false;
+        }
+        parsed.config.fixed_seed = 1;
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("textCacheMb")) {
+        parsed.config.text_cache_mb = cfg.Get("textCacheMb").As<Napi::Number>().Int32Value();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("audioCacheMb")) {
+        parsed.config.audio_cache_mb = cfg.Get("audioCacheMb").As<Napi::Number>().Int32Value();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("maxFrames")) {
+        parsed.config.max_frames = cfg.Get("maxFrames").As<Napi::Number>().Int32Value();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("contextWindowFrames")) {
+        parsed.config.context_window_frames = cfg.Get("contextWindowFrames").As<Napi::Number>().Int32Value();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("contextKeepFrames")) {
+        parsed.config.context_keep_frames = cfg.Get("contextKeepFrames").As<Napi::Number>().Int32Value();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("intraOpThreads")) {
+        parsed.config.intra_op_threads = cfg.Get("intraOpThreads").As<Napi::Number>().Int32Value();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("interOpThreads")) {
+        parsed.config.inter_op_threads = cfg.Get("interOpThreads").As<Napi::Number>().Int32Value();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("allowSpinning")) {
+        parsed.config.disable_spinning = cfg.Get("allowSpinning").As<Napi::Boolean>().Value() ? 0 : 1;
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("threadAffinity")) {
+        parsed.threadAffinity = cfg.Get("threadAffinity").As<Napi::String>().Utf8Value();
+        parsed.config.thread_affinity = parsed.threadAffinity.c_str();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("executionProvider")) {
+        parsed.executionProvider = cfg.Get("executionProvider").As<Napi::String>().Utf8Value();
+        parsed.config.execution_provider = parsed.executionProvider.c_str();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("deviceId")) {
+        parsed.config.device_id = cfg.Get("deviceId").As<Napi::Number>().Int32Value();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("optimizedModelCacheDir")) {
+        parsed.optimizedModelCacheDir = cfg.Get("optimizedModelCacheDir").As<Napi::String>().Utf8Value();
+        parsed.config.optimized_model_cache_dir = parsed.optimizedModelCacheDir.c_str();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("lazyLoad")) {
+        parsed.config.lazy_load = cfg.Get("lazyLoad").As<Napi::Boolean>().Value() ? 1 : 0;
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("globalThreadPools")) {
+        parsed.config.global_thread_pools = cfg.Get("globalThreadPools").As<Napi::Boolean>().Value() ? 1 : 0;
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("cpuArena")) {
+        parsed.config.disable_cpu_arena = cfg.Get("cpuArena").As<Napi::Boolean>().Value() ? 0 : 1;
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("sharedArena")) {
+        parsed.config.shared_arena = cfg.Get("sharedArena").As<Napi::Boolean>().Value() ? 1 : 0;
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("arenaExtendStrategy")) {
+        parsed.arenaExtendStrategy = cfg.Get("arenaExtendStrategy").As<Napi::String>().Utf8Value();
+        parsed.config.arena_extend_strategy = parsed.arenaExtendStrategy.c_str();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("arenaMaxMb")) {
+        parsed.config.arena_max_mb = cfg.Get("arenaMaxMb").As<Napi::Number>().Int32Value();
+        parsed.useConfig = true;
+    }
+
+    if (cfg.Has("arenaShrinkage")) {
+        parsed.config.arena_shrinkage = cfg.Get("arenaShrinkage").As<Napi::Boolean>().Value() ? 1 : 0;
+        parsed.useConfig = true;
+    }
+
+    return true;
+}
+
 class VoiceWrap final : public Napi::ObjectWrap<VoiceWrap> {
 public:
     static Napi::FunctionReference constructor;
@@ -56,12 +311,29 @@ public:
     }
 
     VoiceHandle handle() const {
-        return handle_;
+        return freePending_ ? nullptr : handle_;
+    }
+
+    // Pin the handle for an async operation; free() waits for release()
+    void acquire() {
+        ++uses_;
+        Ref();
+    }
+
+    void release() {
+        if (--uses_ == 0 && freePending_) {
+            reset();
+        }
+        Unref();
     }
 
 private:
     Napi::Value free(const Napi::CallbackInfo& info) {
-        reset();
+        if (uses_ > 0) {
+            freePending_ = true;
+        } else {
+            reset();
+        }
         return info.Env().Undefined();
     }
 
@@ -71,14 +343,384 @@ private:
         }
         handle_ = nullptr;
         ownsHandle_ = false;
+        freePending_ = false;
     }
 
     VoiceHandle handle_;
     bool ownsHandle_;
+    int uses_ = 0;
+    bool freePending_ = false;
 };
 
 Napi::FunctionReference VoiceWrap::constructor;
 
+class PocketTTSModelWrap final : public Napi::ObjectWrap<PocketTTSModelWrap> {
+public:
+    static Napi::FunctionReference constructor;
+
+    static void init(Napi::Env env, Napi::Object exports) {
+        Napi::Function ctor = DefineClass(
+            env,
+            "PocketTTSModel",
+            {
+                InstanceMethod("close", &PocketTTSModelWrap::close)
+            });
+
+        constructor = Napi::Persistent(ctor);
+        constructor.SuppressDestruct();
+        exports.Set("PocketTTSModel", ctor);
+    }
+
+    explicit PocketTTSModelWrap(const Napi::CallbackInfo& info)
+        : Napi::ObjectWrap<PocketTTSModelWrap>(info),
+          handle_(nullptr) {
+        Napi::Env env = info.Env();
+
+        ParsedConfig config;
+        if (!parseConfig(env, info.Length() > 0 ? info[0] : env.Undefined(), config)) {
+            return;
+        }
+
+        handle_ = pocket_tts_model_create(config.get());
+        if (!handle_) {
+            throwLastError(env, "Failed to load PocketTTS model");
+        }
+    }
+
+    ~PocketTTSModelWrap() override {
+        reset();
+    }
+
+    PocketTTSModelHandle handle() const {
+        return handle_;
+    }
+
+private:
+    Napi::Value close(const Napi::CallbackInfo& info) {
+        reset();
+        return info.Env().Undefined();
+    }
+
+    // Instances created from the model keep their own reference to it
+    void reset() {
+        if (handle_) {
+            pocket_tts_model_destroy(handle_);
+            handle_ = nullptr;
+        }
+    }
+
+    PocketTTSModelHandle handle_;
+};
+
+Napi::FunctionReference PocketTTSModelWrap::constructor;
+
+// Hand generated audio to JS without copying; the buffer finalizer returns
+// it to pocket_tts_free_audio
+Napi::Float32Array adoptAudio(Napi::Env env, AudioResult& result) {
+    const size_t count = result.sample_count > 0 ? static_cast<size_t>(result.sample_count) : 0;
+#ifdef NODE_API_NO_EXTERNAL_BUFFERS_ALLOWED
+    Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, count * sizeof(float));
+    if (count > 0) {
+        std::memcpy(buffer.Data(), result.data, count * sizeof(float));
+    }
+    pocket_tts_free_audio(&result);
+#else
+    Napi::ArrayBuffer buffer;
+    if (count == 0) {
+        pocket_tts_free_audio(&result);
+        buffer = Napi::ArrayBuffer::New(env, 0);
+    } else {
+        auto* owned = new AudioResult(result);
+        buffer = Napi::ArrayBuffer::New(
+            env,
+            owned->data,
+            count * sizeof(float),
+            [](Napi::Env, void*, AudioResult* audio) {
+                pocket_tts_free_audio(audio);
+                delete audio;
+            },
+            owned);
+        result = AudioResult {};
+    }
+#endif
+    return Napi::Float32Array::New(env, count, buffer, 0);
+}
+
+// Same for a streamed chunk copied out of the native callback
+Napi::Float32Array adoptSamples(Napi::Env env, std::vector<float>* samples) {
+    const size_t count = samples->size();
+#ifdef NODE_API_NO_EXTERNAL_BUFFERS_ALLOWED
+    Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, count * sizeof(float));
+    if (count > 0) {
+        std::memcpy(buffer.Data(), samples->data(), count * sizeof(float));
+    }
+    delete samples;
+#else
+    Napi::ArrayBuffer buffer;
+    if (count == 0) {
+        delete samples;
+        buffer = Napi::ArrayBuffer::New(env, 0);
+    } else {
+        buffer = Napi::ArrayBuffer::New(
+            env,
+            samples->data(),
+            count * sizeof(float),
+            [](Napi::Env, void*, std::vector<float>* owned) { delete owned; },
+            samples);
+    }
+#endif
+    return Napi::Float32Array::New(env, count, buffer, 0);
+}
+
+Napi::Object audioObject(Napi::Env env, AudioResult& result) {
+    const int sampleRate = result.sample_rate;
+    Napi::Object output = Napi::Object::New(env);
+    output.Set("sampleRate", Napi::Number::New(env, sampleRate));
+    output.Set("samples", adoptAudio(env, result));
+    return output;
+}
+
+std::string lastErrorMessage(const std::string& prefix) {
+    const char* lastError = pocket_tts_get_last_error();
+    if (lastError && std::strlen(lastError) > 0) {
+        return prefix + ": " + lastError;
+    }
+    return prefix;
+}
+
+// Runs pocket_tts_generate on the libuv pool and settles a Promise
+class GenerateWorker final : public Napi::AsyncWorker {
+public:
+    GenerateWorker(Napi::Env env, PocketTTSHandle tts, VoiceHandle voice, std::string text,
+                   std::function<void()> release)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          tts_(tts),
+          voice_(voice),
+          text_(std::move(text)),
+          release_(std::move(release)) {}
+
+    Napi::Promise promise() const {
+        return deferred_.Promise();
+    }
+
+protected:
+    void Execute() override {
+        if (pocket_tts_generate(tts_, text_.c_str(), voice_, &result_) != 0) {
+            SetError(lastErrorMessage("Failed to generate audio"));
+        }
+    }
+
+    void OnOK() override {
+        release_();
+        deferred_.Resolve(audioObject(Env(), result_));
+    }
+
+    void OnError(const Napi::Error& error) override {
+        release_();
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    PocketTTSHandle tts_;
+    VoiceHandle voice_;
+    std::string text_;
+    std::function<void()> release_;
+    AudioResult result_ {};
+};
+
+// Runs pocket_tts_encode_voice on the libuv pool and settles a Promise
+class EncodeVoiceWorker final : public Napi::AsyncWorker {
+public:
+    EncodeVoiceWorker(Napi::Env env, PocketTTSHandle tts, std::string audioPath,
+                      std::function<void()> release)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          tts_(tts),
+          audioPath_(std::move(audioPath)),
+          release_(std::move(release)) {}
+
+    ~EncodeVoiceWorker() override {
+        if (voice_) {
+            pocket_tts_free_voice(voice_);
+        }
+    }
+
+    Napi::Promise promise() const {
+        return deferred_.Promise();
+    }
+
+protected:
+    void Execute() override {
+        voice_ = pocket_tts_encode_voice(tts_, audioPath_.c_str());
+        if (!voice_) {
+            SetError(lastErrorMessage("Failed to encode voice"));
+        }
+    }
+
+    void OnOK() override {
+        release_();
+        VoiceHandle voice = voice_;
+        voice_ = nullptr;
+        deferred_.Resolve(VoiceWrap::newInstance(Env(), voice));
+    }
+
+    void OnError(const Napi::Error& error) override {
+        release_();
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    PocketTTSHandle tts_;
+    std::string audioPath_;
+    std::function<void()> release_;
+    VoiceHandle voice_ = nullptr;
+};
+
+// Shared by the generation thread, the JS-thread chunk delivery and the
+// controller returned to JS
+struct StreamState {
+    PocketTTSHandle tts = nullptr;
+    VoiceHandle voice = nullptr;
+    std::string text;
+    StreamingConfig config {};
+    std::vector<int> chunkSchedule;
+    Napi::ThreadSafeFunction tsfn;
+    std::function<void()> release;  // JS thread only
+    PocketTTSCancelToken cancelToken = pocket_tts_cancel_token_create();  // This stream only
+
+    ~StreamState() { pocket_tts_cancel_token_destroy(cancelToken); }
+
+    // Backpressure: chunks handed to JS that the consumer hasn't taken yet
+    std::mutex mutex;
+    std::condition_variable wake;
+    int inFlight = 0;
+    int highWaterMark = 4;
+    bool cancelled = false;
+    bool finished = false;  // JS thread only
+};
+
+struct StreamEvent {
+    std::shared_ptr<StreamState> state;
+    std::vector<float>* samples = nullptr;
+    bool isFinal = false;
+    bool done = false;
+    int totalSamples = 0;
+    std::string error;
+};
+
+// JS thread: onEvent(error, samples, isFinal); samples is null once the
+// stream has ended
+void deliverStreamEvent(Napi::Env env, Napi::Function onEvent, StreamEvent* event) {
+    std::unique_ptr<StreamEvent> owned(event);
+    if (!env) {
+        delete owned->samples;  // Environment shutting down
+        return;
+    }
+
+    if (!owned->done) {
+        onEvent.Call({env.Null(), adoptSamples(env, owned->samples), Napi::Boolean::New(env, owned->isFinal)});
+        return;
+    }
+
+    owned->state->finished = true;
+    owned->state->release();
+    Napi::Value error = owned->error.empty()
+        ? env.Null()
+        : Napi::Error::New(env, owned->error).Value();
+    onEvent.Call({error, env.Null(), Napi::Boolean::New(env, true)});
+}
+
+// Native chunk callback on the generation (or decoder) thread; blocks while
+// JS is highWaterMark chunks behind
+void onStreamChunk(const float* samples, int sampleCount, int isFinal, void* userData) {
+    auto& state = *static_cast<std::shared_ptr<StreamState>*>(userData);
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->wake.wait(lock, [&] { return state->cancelled || state->inFlight < state->highWaterMark; });
+        if (state->cancelled) {
+            return;
+        }
+        ++state->inFlight;
+    }
+
+    auto* event = new StreamEvent();
+    event->state = state;
+    event->samples = new std::vector<float>(samples, samples + std::max(0, sampleCount));
+    event->isFinal = isFinal != 0;
+    if (state->tsfn.BlockingCall(event, deliverStreamEvent) != napi_ok) {
+        delete event->samples;
+        delete event;
+    }
+}
+
+void runStream(std::shared_ptr<StreamState> state) {
+    StreamingConfig config = state->config;
+    config.user_data = &state;
+    config.cancel_token = state->cancelToken;
+    const int total = pocket_tts_generate_streaming(
+        state->tts, state->text.c_str(), state->voice, onStreamChunk, &config);
+
+    auto* event = new StreamEvent();
+    event->state = state;
+    event->done = true;
+    event->totalSamples = total;
+    if (total < 0) {
+        event->error = lastErrorMessage("Streaming failed");
+    }
+    if (state->tsfn.BlockingCall(event, deliverStreamEvent) != napi_ok) {
+        delete event;
+    }
+    state->tsfn.Release();
+}
+
+bool parseStreamOptions(const Napi::Env& env, const Napi::Value& value, StreamState& state) {
+    state.config.chunk_size_frames = 5;
+    if (value.IsUndefined() || value.IsNull()) {
+        return true;
+    }
+    if (!value.IsObject()) {
+        Napi::TypeError::New(env, "options must be an object").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    Napi::Object opts = value.As<Napi::Object>();
+    auto intOption = [&opts](const char* name, int& target) {
+        if (opts.Has(name)) target = opts.Get(name).As<Napi::Number>().Int32Value();
+    };
+    auto floatOption = [&opts](const char* name, float& target) {
+        if (opts.Has(name)) target = opts.Get(name).As<Napi::Number>().FloatValue();
+    };
+
+    intOption("chunkSizeFrames", state.config.chunk_size_frames);
+    intOption("firstChunkFrames", state.config.first_chunk_frames);
+    floatOption("chunkGrowth", state.config.chunk_growth);
+    floatOption("targetLatencyMs", state.config.target_latency_ms);
+    intOption("queueDepth", state.config.queue_depth);
+    intOption("highWaterMark", state.highWaterMark);
+    state.highWaterMark = std::max(1, state.highWaterMark);
+    if (opts.Has("pipelined")) {
+        state.config.pipelined = opts.Get("pipelined").As<Napi::Boolean>().Value() ? 1 : 0;
+    }
+    if (opts.Has("chunkSchedule")) {
+        Napi::Array schedule = opts.Get("chunkSchedule").As<Napi::Array>();
+        for (uint32_t i = 0; i < schedule.Length(); ++i) {
+            state.chunkSchedule.push_back(schedule.Get(i).As<Napi::Number>().Int32Value());
+        }
+        state.config.chunk_schedule = state.chunkSchedule.data();
+        state.config.chunk_schedule_length = static_cast<int>(state.chunkSchedule.size());
+    }
+    if (opts.Has("seed")) {
+        if (!parseSeed(env, opts.Get("seed"), state.config.seed)) {
+            return false;
+        }
+        state.config.fixed_seed = 1;
+    }
+    return true;
+}
+
 class PocketTTSWrap final : public Napi::ObjectWrap<PocketTTSWrap> {
 public:
     static Napi::FunctionReference constructor;
@@ -89,8 +731,14 @@ public:
             "PocketTTS",
             {
                 InstanceMethod("encodeVoice", &PocketTTSWrap::encodeVoice),
+                InstanceMethod("encodeVoiceAsync", &PocketTTSWrap::encodeVoiceAsync),
                 InstanceMethod("encodeVoiceFromSamples", &PocketTTSWrap::encodeVoiceFromSamples),
                 InstanceMethod("generate", &PocketTTSWrap::generate),
+                InstanceMethod("generateAsync", &PocketTTSWrap::generateAsync),
+                InstanceMethod("generateStreaming", &PocketTTSWrap::generateStreaming),
+                InstanceMethod("getLastStats", &PocketTTSWrap::getLastStats),
+                InstanceMethod("getMemoryUsage", &PocketTTSWrap::getMemoryUsage),
+                InstanceMethod("prefetch", &PocketTTSWrap::prefetch),
                 InstanceMethod("close", &PocketTTSWrap::close),
                 InstanceMethod("version", &PocketTTSWrap::version)
             });
@@ -105,56 +753,29 @@ public:
           handle_(nullptr) {
         Napi::Env env = info.Env();
 
-        PocketTTSConfig config {};
-        bool useConfig = false;
-
-        std::string modelsDir;
-        std::string tokenizerPath;
-        std::string precision;
-
-        if (info.Length() > 0 && !info[0].IsUndefined() && !info[0].IsNull()) {
-            if (!info[0].IsObject()) {
-                Napi::TypeError::New(env, "config must be an object").ThrowAsJavaScriptException();
+        if (info.Length() > 0 && info[0].IsObject() &&
+            info[0].As<Napi::Object>().InstanceOf(PocketTTSModelWrap::constructor.Value())) {
+            PocketTTSModelWrap* model =
+                Napi::ObjectWrap<PocketTTSModelWrap>::Unwrap(info[0].As<Napi::Object>());
+            if (!model || !model->handle()) {
+                Napi::Error::New(env, "PocketTTSModel instance already closed")
+                    .ThrowAsJavaScriptException();
                 return;
             }
 
-            Napi::Object cfg = info[0].As<Napi::Object>();
-
-            if (cfg.Has("modelsDir")) {
-                modelsDir = cfg.Get("modelsDir").As<Napi::String>().Utf8Value();
-                config.models_dir = modelsDir.c_str();
-                useConfig = true;
-            }
-
-            if (cfg.Has("tokenizerPath")) {
-                tokenizerPath = cfg.Get("tokenizerPath").As<Napi::String>().Utf8Value();
-                config.tokenizer_path = tokenizerPath.c_str();
-                useConfig = true;
-            }
-
-            if (cfg.Has("precision")) {
-                precision = cfg.Get("precision").As<Napi::String>().Utf8Value();
-                config.precision = precision.c_str();
-                useConfig = true;
-            }
-
-            if (cfg.Has("temperature")) {
-                config.temperature = cfg.Get("temperature").As<Napi::Number>().FloatValue();
-                useConfig = true;
-            }
-
-            if (cfg.Has("lsdSteps")) {
-                config.lsd_steps = cfg.Get("lsdSteps").As<Napi::Number>().Int32Value();
-                useConfig = true;
+            handle_ = pocket_tts_create_from_model(model->handle());
+            if (!handle_) {
+                throwLastError(env, "Failed to create PocketTTS instance");
             }
+            return;
+        }
 
-            if (cfg.Has("maxFrames")) {
-                config.max_frames = cfg.Get("maxFrames").As<Napi::Number>().Int32Value();
-                useConfig = true;
-            }
+        ParsedConfig config;
+        if (!parseConfig(env, info.Length() > 0 ? info[0] : env.Undefined(), config)) {
+            return;
         }
 
-        handle_ = pocket_tts_create(useConfig ? &config : nullptr);
+        handle_ = pocket_tts_create(config.get());
         if (!handle_) {
             throwLastError(env, "Failed to create PocketTTS instance");
         }
@@ -165,11 +786,64 @@ public:
     }
 
 private:
+    bool checkOpen(const Napi::Env& env) {
+        if (!handle_ || closePending_) {
+            Napi::Error::New(env, "PocketTTS instance already closed").ThrowAsJavaScriptException();
+            return false;
+        }
+        return true;
+    }
+
+    // One generation at a time per instance: its generation state isn't
+    // shareable. Concurrent syntheses use one PocketTTS per request over a
+    // shared PocketTTSModel.
+    bool checkIdle(const Napi::Env& env) {
+        if (!checkOpen(env)) {
+            return false;
+        }
+        if (generating_) {
+            Napi::Error::New(env, "PocketTTS instance is busy; use one instance per concurrent request")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        return true;
+    }
+
+    // Keep this object (and its handle) alive while a worker uses it
+    std::function<void()> beginOp(bool generating) {
+        ++activeOps_;
+        generating_ = generating_ || generating;
+        Ref();
+        return [this, generating]() {
+            if (generating) generating_ = false;
+            --activeOps_;
+            if (activeOps_ == 0 && closePending_) {
+                reset();
+            }
+            Unref();
+        };
+    }
+
+    VoiceWrap* voiceArg(const Napi::Env& env, const Napi::Value& value) {
+        if (!value.IsObject() || !value.As<Napi::Object>().InstanceOf(VoiceWrap::constructor.Value())) {
+            Napi::TypeError::New(env, "voice must be a Voice instance")
+                .ThrowAsJavaScriptException();
+            return nullptr;
+        }
+
+        VoiceWrap* voice = Napi::ObjectWrap<VoiceWrap>::Unwrap(value.As<Napi::Object>());
+        if (!voice || !voice->handle()) {
+            Napi::TypeError::New(env, "voice must be a live Voice handle")
+                .ThrowAsJavaScriptException();
+            return nullptr;
+        }
+        return voice;
+    }
+
     Napi::Value encodeVoice(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
 
-        if (!handle_) {
-            Napi::Error::New(env, "PocketTTS instance already closed").ThrowAsJavaScriptException();
+        if (!checkOpen(env)) {
             return env.Null();
         }
 
@@ -189,11 +863,31 @@ private:
         return VoiceWrap::newInstance(env, voice);
     }
 
+    Napi::Value encodeVoiceAsync(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (!checkOpen(env)) {
+            return env.Null();
+        }
+
+        if (info.Length() != 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "encodeVoiceAsync(audioPath) expects a string path")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        // Encoding only touches the shared model, so it may overlap a generation
+        auto* worker = new EncodeVoiceWorker(
+            env, handle_, info[0].As<Napi::String>().Utf8Value(), beginOp(false));
+        Napi::Promise promise = worker->promise();
+        worker->Queue();
+        return promise;
+    }
+
     Napi::Value encodeVoiceFromSamples(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
 
-        if (!handle_) {
-            Napi::Error::New(env, "PocketTTS instance already closed").ThrowAsJavaScriptException();
+        if (!checkOpen(env)) {
             return env.Null();
         }
 
@@ -231,8 +925,7 @@ private:
     Napi::Value generate(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
 
-        if (!handle_) {
-            Napi::Error::New(env, "PocketTTS instance already closed").ThrowAsJavaScriptException();
+        if (!checkIdle(env)) {
             return env.Null();
         }
 
@@ -242,17 +935,8 @@ private:
             return env.Null();
         }
 
-        Napi::Object voiceObject = info[1].As<Napi::Object>();
-        if (!voiceObject.InstanceOf(VoiceWrap::constructor.Value())) {
-            Napi::TypeError::New(env, "voice must be a Voice instance")
-                .ThrowAsJavaScriptException();
-            return env.Null();
-        }
-
-        VoiceWrap* voice = Napi::ObjectWrap<VoiceWrap>::Unwrap(voiceObject);
-        if (!voice || !voice->handle()) {
-            Napi::TypeError::New(env, "voice must be a live Voice handle")
-                .ThrowAsJavaScriptException();
+        VoiceWrap* voice = voiceArg(env, info[1]);
+        if (!voice) {
             return env.Null();
         }
 
@@ -265,51 +949,197 @@ private:
             return env.Null();
         }
 
-        const int sampleCount = result.sample_count;
-        const int sampleRate = result.sample_rate;
+        return audioObject(env, result);
+    }
 
-        Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(
-            env,
-            static_cast<size_t>(sampleCount) * sizeof(float));
+    Napi::Value generateAsync(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
 
-        if (sampleCount > 0) {
-            std::memcpy(
-                buffer.Data(),
-                result.data,
-                static_cast<size_t>(sampleCount) * sizeof(float));
+        if (!checkIdle(env)) {
+            return env.Null();
         }
-        pocket_tts_free_audio(&result);
 
-        Napi::Float32Array samples = Napi::Float32Array::New(
-            env,
-            static_cast<size_t>(sampleCount),
-            buffer,
-            0);
+        if (info.Length() != 2 || !info[0].IsString() || !info[1].IsObject()) {
+            Napi::TypeError::New(env, "generateAsync(text, voice) expects (string, Voice)")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
 
-        Napi::Object output = Napi::Object::New(env);
-        output.Set("sampleRate", Napi::Number::New(env, sampleRate));
-        output.Set("samples", samples);
+        VoiceWrap* voice = voiceArg(env, info[1]);
+        if (!voice) {
+            return env.Null();
+        }
 
-        return output;
+        voice->acquire();
+        auto release = beginOp(true);
+        auto* worker = new GenerateWorker(
+            env, handle_, voice->handle(), info[0].As<Napi::String>().Utf8Value(),
+            [release, voice]() {
+                voice->release();
+                release();
+            });
+        Napi::Promise promise = worker->promise();
+        worker->Queue();
+        return promise;
     }
 
-    Napi::Value close(const Napi::CallbackInfo& info) {
-        reset();
-        return info.Env().Undefined();
+    // generateStreaming(text, voice, options, onEvent) -> { cancel(), consumed() }
+    // onEvent(error, samples, isFinal) runs on the JS thread per chunk and
+    // once more with samples = null at the end. index.js wraps this in
+    // PocketTTS#stream(), an async iterator.
+    Napi::Value generateStreaming(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (!checkIdle(env)) {
+            return env.Null();
+        }
+
+        if (info.Length() != 4 || !info[0].IsString() || !info[1].IsObject() || !info[3].IsFunction()) {
+            Napi::TypeError::New(
+                env,
+                "generateStreaming(text, voice, options, onEvent) expects (string, Voice, object, function)")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        VoiceWrap* voice = voiceArg(env, info[1]);
+        if (!voice) {
+            return env.Null();
+        }
+
+        auto state = std::make_shared<StreamState>();
+        if (!parseStreamOptions(env, info[2], *state)) {
+            return env.Null();
+        }
+        state->tts = handle_;
+        state->voice = voice->handle();
+        state->text = info[0].As<Napi::String>().Utf8Value();
+        state->tsfn = Napi::ThreadSafeFunction::New(env, info[3].As<Napi::Function>(), "PocketTTSStream", 0, 1);
+
+        voice->acquire();
+        auto release = beginOp(true);
+        state->release = [release, voice]() {
+            voice->release();
+            release();
+        };
+
+        std::thread(runStream, state).detach();
+
+        Napi::Object controller = Napi::Object::New(env);
+        controller.Set("cancel", Napi::Function::New(env, [state](const Napi::CallbackInfo& cbInfo) {
+            if (state->finished) {
+                return cbInfo.Env().Undefined();  // Already ended; nothing to stop
+            }
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->cancelled = true;
+            }
+            state->wake.notify_all();
+            pocket_tts_cancel_token_cancel(state->cancelToken);
+            return cbInfo.Env().Undefined();
+        }));
+        controller.Set("consumed", Napi::Function::New(env, [state](const Napi::CallbackInfo& cbInfo) {
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->inFlight = std::max(0, state->inFlight - 1);
+            }
+            state->wake.notify_all();
+            return cbInfo.Env().Undefined();
+        }));
+        return controller;
+    }
+
+    Napi::Value getLastStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (!checkOpen(env)) {
+            return env.Null();
+        }
+
+        PocketTTSStats stats {};
+        if (pocket_tts_get_last_stats(handle_, &stats) != 0) {
+            throwLastError(env, "Failed to get stats");
+            return env.Null();
+        }
+        return statsToObject(env, stats);
+    }
+
+    // Allowed while async work is in flight: that is when prefetching pays off
+    Napi::Value prefetch(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (!checkOpen(env)) {
+            return env.Null();
+        }
+
+        if (info.Length() != 2 || !info[0].IsString() || !info[1].IsObject()) {
+            Napi::TypeError::New(env, "prefetch(text, voice) expects (string, Voice)")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        VoiceWrap* voice = voiceArg(env, info[1]);
+        if (!voice) {
+            return env.Null();
+        }
+
+        const std::string text = info[0].As<Napi::String>().Utf8Value();
+        if (pocket_tts_prefetch(handle_, text.c_str(), voice->handle()) != 0) {
+            throwLastError(env, "Failed to prefetch");
+            return env.Null();
+        }
+        return env.Undefined();
+    }
+
+    Napi::Value getMemoryUsage(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+
+        if (!checkOpen(env)) {
+            return env.Null();
+        }
+
+        PocketTTSMemoryUsage usage {};
+        if (pocket_tts_get_memory_usage(handle_, &usage) != 0) {
+            throwLastError(env, "Failed to get memory usage");
+            return env.Null();
+        }
+        auto bytes = [&env](uint64_t value) { return Napi::Number::New(env, static_cast<double>(value)); };
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("residentBytes", bytes(usage.resident_bytes));
+        obj.Set("peakResidentBytes", bytes(usage.peak_resident_bytes));
+        obj.Set("modelFileBytes", bytes(usage.model_file_bytes));
+        obj.Set("voiceCacheBytes", bytes(usage.voice_cache_bytes));
+        obj.Set("textCacheBytes", bytes(usage.text_cache_bytes));
+        obj.Set("audioCacheBytes", bytes(usage.audio_cache_bytes));
+        return obj;
     }
 
     Napi::Value version(const Napi::CallbackInfo& info) {
         return Napi::String::New(info.Env(), pocket_tts_version());
     }
 
+    // Closing while work is in flight defers the destroy until it finishes
+    Napi::Value close(const Napi::CallbackInfo& info) {
+        if (activeOps_ > 0) {
+            closePending_ = true;
+        } else {
+            reset();
+        }
+        return info.Env().Undefined();
+    }
+
     void reset() {
         if (handle_) {
             pocket_tts_destroy(handle_);
             handle_ = nullptr;
         }
+        closePending_ = false;
     }
 
     PocketTTSHandle handle_;
+    int activeOps_ = 0;
+    bool generating_ = false;
+    bool closePending_ = false;
 };
 
 Napi::FunctionReference PocketTTSWrap::constructor;
@@ -320,6 +1150,7 @@ Napi::Value addonVersion(const Napi::CallbackInfo& info) {
 
 Napi::Object initAddon(Napi::Env env, Napi::Object exports) {
     VoiceWrap::init(env, exports);
+    PocketTTSModelWrap::init(env, exports);
     PocketTTSWrap::init(env, exports);
     exports.Set("version", Napi::Function::New(env, addonVersion));
     return exports;
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "pocket_tts/pocket_tts.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pocket_tts {
+
+/**
+ * @brief Destination for encoded bytes (PCM16 samples, Opus packets, ...)
+ * @param data Encoded bytes, valid only for the duration of the call
+ * @param size Number of bytes
+ */
+using EncodedChunkCallback = std::function<void(const uint8_t* data, size_t size)>;
+
+/**
+ * @brief Consumer of streamed audio attached to StreamingConfig::sinks
+ *
+ * Sinks receive each decoded chunk (float32, 24 kHz mono) on the thread
+ * that decoded it, which is the decoder thread in pipelined mode, so the
+ * conversion and encoding stay off the LM loop. finish() is called once
+ * per generateStreaming() call after the last chunk, also when generation
+ * was cancelled. A sink may be reused for the next utterance afterwards
+ * unless documented otherwise. One sink must not be attached to two
+ * concurrent generations.
+ */
+class POCKET_TTS_API AudioSink {
+public:
+    virtual ~AudioSink() = default;
+
+    /// Consume one chunk of 24 kHz mono audio
+    virtual void write(const float* samples, size_t count) = 0;
+
+    /// End of the utterance: emit anything still buffered
+    virtual void finish() {}
+};
+
+/**
+ * @brief Converts to little-endian signed 16-bit PCM
+ *
+ * Optionally resamples first (e.g. 8 or 16 kHz for telephony) and adds
+ * triangular (TPDF) dither of +-1 LSB before rounding. Conversion is
+ * vectorized with SSE2 / NEON and saturates out-of-range samples.
+ */
+class POCKET_TTS_API Pcm16Sink : public AudioSink {
+public:
+    /**
+     * @param output Receives 2 * samples bytes per chunk
+     * @param sampleRate Output sample rate
+     * @param dither Add TPDF dither (set false for bit-exact tests)
+     */
+    explicit Pcm16Sink(EncodedChunkCallback output, int sampleRate = 24000, bool dither = true);
+    ~Pcm16Sink() override;
+
+    void write(const float* samples, size_t count) override;
+    void finish() override;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/// Sample encoding of a WavFileSink
+enum class WavSampleFormat {
+    Pcm16,    ///< Signed 16-bit PCM with TPDF dither
+    Float32   ///< IEEE float, as written by AudioUtils::saveWav
+};
+
+/**
+ * @brief Writes a WAV file incrementally as chunks arrive
+ *
+ * The header is written up front with zero sizes and patched in finish(),
+ * so the file is complete as soon as generation ends. Each finish() ends
+ * the file; later chunks throw. So does a chunk that would take the data
+ * past the 4 GB WAV limit; it is not written, so the file stays valid.
+ *
+ * @throws std::runtime_error if the file cannot be created
+ */
+class POCKET_TTS_API WavFileSink : public AudioSink {
+public:
+    WavFileSink(const std::string& filepath, int sampleRate = 24000,
+                WavSampleFormat format = WavSampleFormat::Pcm16);
+    ~WavFileSink() override;
+
+    void write(const float* samples, size_t count) override;
+    void finish() override;
+
+    /// Samples written so far at the output rate
+    size_t samplesWritten() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * @brief Encodes to Opus packets (libopus, VOIP application)
+ *
+ * Audio is cut into frames of frameMs milliseconds; finish() pads the last
+ * one with silence. Each packet is delivered through output as a separate
+ * call; framing into Ogg/WebM/RTP is left to the caller.
+ * Requires a build with POCKET_TTS_USE_OPUS.
+ *
+ * @throws std::runtime_error if Opus support was not compiled in or the
+ *         encoder cannot be created (sampleRate must be 8, 12, 16, 24 or
+ *         48 kHz; frameMs 10, 20, 40 or 60)
+ */
+class POCKET_TTS_API OpusSink : public AudioSink {
+public:
+    explicit OpusSink(EncodedChunkCallback output, int sampleRate = 24000,
+                      int bitrate = 24000, int frameMs = 20);
+    ~OpusSink() override;
+
+    void write(const float* samples, size_t count) override;
+    void finish() override;
+
+    /// True when the library was built with Opus support
+    static bool available();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace pocket_tts
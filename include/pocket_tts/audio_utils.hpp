@@ -2,7 +2,9 @@
 
 #include <string>
 #include <vector>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 
 namespace pocket_tts {
 
@@ -16,13 +18,37 @@ public:
     
     /**
      * @brief Load a WAV file and resample to target sample rate
+     * 
+     * Reads PCM 8/16/24/32-bit, float 32/64-bit and WAVE_FORMAT_EXTENSIBLE
+     * files with any channel count (downmixed to mono). The file is
+     * memory-mapped and only the frames that reach the first maxSamples
+     * outputs are decoded, so long files cost no more than short ones.
+     * The result is peak-normalized over the returned samples.
+     * 
      * @param filepath Path to the WAV file
      * @param targetSampleRate Target sample rate (default: 24000 Hz)
+     * @param maxSamples Keep at most this many output samples (0 = whole file)
      * @return Vector of audio samples (mono, float32)
      * @throws std::runtime_error if file cannot be loaded
      */
     static std::vector<float> loadWav(
         const std::string& filepath,
+        int targetSampleRate = TARGET_SAMPLE_RATE,
+        size_t maxSamples = 0
+    );
+    
+    /**
+     * @brief Load the start of a WAV file into a caller-provided buffer
+     * 
+     * Same decoding as loadWav(), writing at most capacity samples.
+     * 
+     * @return Number of samples written
+     * @throws std::runtime_error if file cannot be loaded
+     */
+    static size_t loadWavInto(
+        const std::string& filepath,
+        float* output,
+        size_t capacity,
         int targetSampleRate = TARGET_SAMPLE_RATE
     );
     
@@ -41,15 +67,21 @@ public:
     
     /**
      * @brief Resample audio data to a different sample rate
+     * 
+     * Lanczos-8 polyphase filter; the filter bank of each rate pair is
+     * built once and shared. Long inputs are split across threads.
+     * 
      * @param input Input audio samples
      * @param inputSampleRate Sample rate of input
      * @param outputSampleRate Desired output sample rate
+     * @param numThreads Worker threads for long inputs (0 = hardware threads)
      * @return Resampled audio data
      */
     static std::vector<float> resample(
         const std::vector<float>& input,
         int inputSampleRate,
-        int outputSampleRate
+        int outputSampleRate,
+        int numThreads = 0
     );
     
     /**
@@ -67,4 +99,41 @@ public:
     static std::vector<float> normalize(const std::vector<float>& audio);
 };
 
+/**
+ * @brief Incremental resampler for audio that arrives in chunks
+ * 
+ * Feeding a signal through process() in any chunking and then flush()
+ * yields the same samples as AudioUtils::resample() on the whole signal,
+ * holding only about one filter length of input. Use it to convert the
+ * 24 kHz output to a playback rate while streaming.
+ */
+class StreamingResampler {
+public:
+    /// @throws std::invalid_argument for non-positive rates or rate pairs
+    ///         whose reduced ratio has more than 4096 output phases
+    StreamingResampler(int inputSampleRate, int outputSampleRate);
+    ~StreamingResampler();
+    
+    StreamingResampler(StreamingResampler&&) noexcept;
+    StreamingResampler& operator=(StreamingResampler&&) noexcept;
+    
+    /// Append input and the output samples it completes to output
+    void process(const float* input, size_t count, std::vector<float>& output);
+    
+    /// End of the signal: append the remaining output, then reset()
+    void flush(std::vector<float>& output);
+    
+    /// Start a new signal
+    void reset();
+    
+    int inputSampleRate() const { return inputRate_; }
+    int outputSampleRate() const { return outputRate_; }
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+    int inputRate_;
+    int outputRate_;
+};
+
 } // namespace pocket_tts
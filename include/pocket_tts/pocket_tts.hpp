@@ -5,6 +5,9 @@
 #include <memory>
 #include <map>
 #include <functional>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 
 /* Platform-specific export macros */
 #ifdef _WIN32
@@ -21,14 +24,36 @@
 
 namespace pocket_tts {
 
+class AudioSink;
+
 /**
  * @brief Callback for audio chunks during streaming generation
  * @param samples Audio samples (float32, 24kHz mono)
  * @param sampleCount Number of samples in this chunk
- * @param isFinal True if this is the final chunk
+ * @param isFinal True if this is the final chunk. Every request ends with
+ *        one, including a cancelled request, whose final chunk is empty
  */
 using AudioChunkCallback = std::function<void(const float* samples, int sampleCount, bool isFinal)>;
 
+/**
+ * @brief Cancellation flag of one request
+ * 
+ * Copies share the flag: keep one, pass another in StreamingConfig or
+ * BatchRequest, and cancel() from any thread. Generation checks it at
+ * every frame boundary, so a cancelled request stops within one frame and
+ * releases its cores (barge-in).
+ */
+class POCKET_TTS_API CancellationToken {
+public:
+    CancellationToken() : flag_(std::make_shared<std::atomic<bool>>(false)) {}
+    
+    void cancel() const { flag_->store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return flag_->load(std::memory_order_relaxed); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag_;
+};
+
 /**
  * @brief Callback for generation progress (optional)
  * @param currentFrame Current frame being generated
@@ -36,6 +61,108 @@ using AudioChunkCallback = std::function<void(const float* samples, int sampleCo
  */
 using ProgressCallback = std::function<void(int currentFrame, int totalFrames)>;
 
+/// Pipeline stages reported through PocketTTSConfig::onStageTiming
+enum class Stage {
+    Tokenize,         // SentencePiece encode of the request text (skipped on text cache hits)
+    TextConditioner,  // text_conditioner run (skipped on text cache hits)
+    VoicePrefill,     // Voice conditioning pass (skipped on prefix cache hits)
+    TextPrefill,      // Text conditioning pass through flow_lm_main
+    MainStep,         // One autoregressive flow_lm_main step
+    Flow,             // All LSD steps of one frame (or one batched frame)
+    Decode            // One mimi_decoder call
+};
+
+/// Stable lowercase name of a stage ("main_step", ...), for reports
+POCKET_TTS_API const char* stageName(Stage stage);
+
+/**
+ * @brief Callback receiving the duration of each pipeline stage
+ * 
+ * Invoked from whichever thread runs the stage, so it must be thread-safe
+ * and must not throw.
+ * @param stage Stage that finished
+ * @param milliseconds Wall-clock duration
+ */
+using StageTimingCallback = std::function<void(Stage stage, double milliseconds)>;
+
+/// Number of runs of one ONNX session and their total wall time
+struct POCKET_TTS_API SessionStats {
+    int runs = 0;
+    double totalMs = 0.0;
+};
+
+/**
+ * @brief Counters collected for one generate call
+ * 
+ * Filled by every generation method and returned by PocketTTS::lastStats().
+ * Collection only touches plain counters and a steady clock per session
+ * run, so it is always on.
+ */
+struct POCKET_TTS_API GenerationStats {
+    int textTokens = 0;
+    int framesGenerated = 0;
+    int eosStep = -1;                // Frame EOS was detected at (-1 = hit maxFrames)
+    int audioSamples = 0;
+    bool voicePrefixCached = false;  // Voice pass skipped via the prefix cache
+    bool textCached = false;         // Tokenizer and text conditioner skipped via the text cache
+    bool audioCached = false;        // Whole result served from the audio cache
+    bool prefetched = false;         // Prefill done ahead of time by PocketTTS::prefetch()
+    bool cancelled = false;          // Stopped early by cancelStreaming() or a CancellationToken
+    uint64_t seed = 0;               // Noise seed used; pass to setSeed() to reproduce
+    
+    /// Session runs; batched flow runs count once for every request in the batch
+    SessionStats textConditioner;
+    SessionStats flowLmMain;         // Voice/text prefill plus one run per frame
+    SessionStats flowLmFlow;         // Runs per frame set by FlowConfig (1 with fusedFlow)
+    SessionStats mimiDecoder;
+    
+    /// State tensor bytes copied from one buffer to another. Fixed-shape
+    /// state is updated in place and grown state is moved, so this is 0
+    /// unless a path has to fall back to copying.
+    uint64_t stateBytesCopied = 0;
+    /// State buffers allocated during the request: growing KV caches
+    /// re-emitted by flow_lm_main and the spares a request gets when it
+    /// diverges from a shared voice prefix
+    uint64_t stateBytesAllocated = 0;
+    /// Peak size of the flow_lm_main state (KV caches) during the request
+    uint64_t lmStateBytes = 0;
+    int contextReprimes = 0;         // Re-primes of a bounded context (contextWindowFrames)
+    
+    double timeToFirstAudioMs = 0.0; // Until the first callback (or the result)
+    double totalMs = 0.0;
+};
+
+/// Memory held by a model and its process (PocketTTSModel::memoryUsage)
+struct POCKET_TTS_API MemoryUsage {
+    size_t residentBytes = 0;        // Process resident set size (0 if unknown)
+    size_t peakResidentBytes = 0;
+    size_t modelFileBytes = 0;       // .onnx files loaded so far
+    size_t voiceCacheBytes = 0;      // Encoded voices plus cached voice-prefix LM states
+    size_t textCacheBytes = 0;
+    size_t audioCacheBytes = 0;
+};
+
+/// Hit/miss counters and size of one model cache
+struct POCKET_TTS_API CacheCounters {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+/// Caches shared by every context on a model (see PocketTTSModel::cacheStats)
+struct POCKET_TTS_API CacheStats {
+    CacheCounters text;    // Token ids + text-conditioner output per normalized text
+    CacheCounters audio;   // Memoized results at temperature 0 or with a fixed seed
+};
+
+/**
+ * @brief Callback receiving the stats of every finished generate call
+ * 
+ * Runs on the thread that finished the request; must not throw.
+ */
+using GenerationStatsCallback = std::function<void(const GenerationStats& stats)>;
+
 /**
  * @brief Configuration for streaming generation
  */
@@ -45,11 +172,102 @@ struct POCKET_TTS_API StreamingConfig {
     /// Default: 5 frames (~400ms of audio)
     int chunkSizeFrames = 5;
     
+    /// Explicit chunk sizes in frames, e.g. {1, 2, 4, 8}; the last entry
+    /// repeats. Takes precedence over the other sizing modes when non-empty.
+    std::vector<int> chunkSchedule;
+    
+    /// Geometric ramp: the first chunk has firstChunkFrames frames, and each
+    /// following chunk is chunkGrowth times larger, up to chunkSizeFrames.
+    /// 0 = every chunk is chunkSizeFrames.
+    int firstChunkFrames = 0;
+    float chunkGrowth = 2.0f;
+    
+    /// Target-latency mode: > 0 sizes each chunk from measured per-frame LM
+    /// and decoder times so producing it takes about this long, capped at
+    /// chunkSizeFrames. The first chunk is a single frame.
+    float targetLatencyMs = 0.0f;
+    
     /// Optional progress callback
     ProgressCallback onProgress = nullptr;
     
-    /// Enable cancellation support (adds overhead for atomic checks)
+    /// Kept for compatibility: cancelStreaming() and cancellation are now
+    /// always checked (one relaxed load per frame)
     bool enableCancellation = false;
+    
+    /// Stops this request at the next frame boundary once cancelled; unlike
+    /// cancelStreaming() it can never hit a later request on the context.
+    /// Latents not yet decoded are dropped and the callback gets an empty
+    /// final chunk.
+    CancellationToken cancellation;
+    
+    /// Decode on a dedicated thread so the LM loop never waits on mimi_decoder
+    /// or on the callback. The callback is then invoked from that thread.
+    bool pipelined = false;
+    
+    /// Chunks that may wait for the decoder thread before generation blocks
+    /// (backpressure against a slow callback). Pipelined mode only.
+    int queueDepth = 4;
+    
+    /// Encoders fed each chunk right after decoding, on the same thread as
+    /// the callback (see audio_sink.hpp: PCM16, WAV file, Opus). The
+    /// callback may be null when at least one sink is attached.
+    std::vector<std::shared_ptr<AudioSink>> sinks;
+    
+    /// Noise seed of this request (< 0 = the context's, see PocketTTS::setSeed)
+    int64_t seed = -1;
+};
+
+/**
+ * @brief Configuration for long-form (document) synthesis
+ */
+struct POCKET_TTS_API LongFormConfig {
+    /// Upper bound on tokens per segment; text is split at sentence, then
+    /// clause, then word boundaries to stay under it
+    int maxTokensPerSegment = 50;
+    
+    /// Segments synthesized concurrently (0 = hardware threads / intraOpThreads)
+    int numThreads = 0;
+    
+    /// Crossfade between consecutive segments
+    int crossfadeMs = 10;
+    
+    /// Optional progress callback (segments delivered, total segments)
+    ProgressCallback onProgress = nullptr;
+};
+
+/// Time grid of the flow integration (noise at 0, latent at 1)
+enum class FlowSchedule {
+    Uniform,    ///< Equal steps
+    Cosine,     ///< Shorter steps near both ends
+    Quadratic   ///< Shorter steps near the noise end
+};
+
+/// Integrator driving flow_lm_flow
+enum class FlowSolver {
+    Euler,  ///< One flow_lm_flow run per step, along the mean velocity over the step
+    Heun    ///< Trapezoidal steps on the instantaneous velocity: two runs per step, second order
+};
+
+/// Lower-case names ("euler", "heun", "uniform", "cosine", "quadratic")
+POCKET_TTS_API const char* flowSolverName(FlowSolver solver);
+POCKET_TTS_API const char* flowScheduleName(FlowSchedule schedule);
+/// Parse those names; throw std::invalid_argument on anything else
+POCKET_TTS_API FlowSolver parseFlowSolver(const std::string& name);
+POCKET_TTS_API FlowSchedule parseFlowSchedule(const std::string& name);
+
+/**
+ * @brief Quality / speed settings of the per-frame flow integration
+ * 
+ * flow_lm_flow runs are most of the per-frame compute; their count per
+ * frame is steps (Euler) or 2 * steps (Heun). GenerationStats::flowLmFlow
+ * reports what a request actually used.
+ */
+struct POCKET_TTS_API FlowConfig {
+    int steps = 0;                                 ///< 0 = PocketTTSConfig::lsdSteps
+    FlowSolver solver = FlowSolver::Euler;
+    FlowSchedule schedule = FlowSchedule::Uniform;
+    /// Steps for frames after EOS was detected (trailing audio); 0 = steps
+    int postEosSteps = 0;
 };
 
 /**
@@ -58,15 +276,273 @@ struct POCKET_TTS_API StreamingConfig {
 struct POCKET_TTS_API PocketTTSConfig {
     std::string modelsDir = "models/onnx";
     std::string tokenizerPath = "models/tokenizer.model";
-    std::string precision = "int8";  // "int8" or "fp32"
+    std::string precision = "int8";  // "int8", "fp16" (*_fp16.onnx) or "fp32"
     float temperature = 0.7f;
     int lsdSteps = 10;               // Flow matching steps
     int maxFrames = 500;
     int framesAfterEos = 3;
+    
+    /// Bounded LM context. flow_lm_main state (and per-frame cost) grows
+    /// with every frame; with a window, once an utterance has fed this many
+    /// frames since its last prime the state is rebuilt from the voice and
+    /// text passes plus the latest contextKeepFrames latents, so memory and
+    /// step latency stay flat and maxFrames can be raised freely.
+    /// GenerationStats::lmStateBytes reports the footprint. (0 = unbounded)
+    int contextWindowFrames = 0;
+    int contextKeepFrames = 0;       // Latents replayed on re-prime; 0 = half the window
     bool loadVoiceEncoder = true;    // Load mimi_encoder.onnx
+    
+    /// Noise seed of every request; a fixed seed makes output reproducible
+    /// (and memoizable, see audioCacheBytes). < 0 = a fresh seed per request,
+    /// reported in GenerationStats::seed. Overridable per context
+    /// (PocketTTS::setSeed) and per request (StreamingConfig, BatchRequest).
+    int64_t seed = -1;
+    
+    /// Run the whole Euler loop of a frame in one session run using
+    /// flow_lm_flow_fused[_int8].onnx (inputs c [1,D], x [1,32], s [N], t [N];
+    /// output x_out [1,32]). Default: one flow_lm_flow run per LSD step.
+    /// The fused graph applies its own Euler loop, so FlowConfig::solver
+    /// has no effect with it.
+    bool fusedFlow = false;
+    
+    /// Default flow integration of every context (see PocketTTS::setFlowConfig)
+    FlowConfig flow;
+    
+    /// generate() hands each group of 15 latent frames to mimi_decoder on a
+    /// second thread while the LM keeps going, so its total time is close
+    /// to the LM time alone. Output is identical either way.
+    bool overlapDecode = true;
+    
+    /// Voices whose LM state after the voice conditioning pass is kept in
+    /// memory, so requests for them skip that prefill (0 = disabled)
+    int voicePrefixCacheSize = 16;
+    
+    /// Byte budget of the encoded-voice cache, keyed by audio content hash
+    /// and evicted least recently used first (0 = disabled)
+    size_t voiceCacheBytes = 64 * 1024 * 1024;
+    
+    /// Byte budget of the text cache: token ids and text-conditioner output
+    /// per normalized text, so repeated prompts skip tokenization and the
+    /// text_conditioner run. LRU, shared by all contexts (0 = disabled).
+    size_t textCacheBytes = 16 * 1024 * 1024;
+    
+    /// Byte budget for whole generate() results, memoized by normalized
+    /// text, voice, flow settings and seed. Used only at temperature 0 or
+    /// with a fixed seed, where the output depends on nothing else, so a
+    /// repeated prompt costs a lookup.
+    /// Streaming and batched requests are not memoized. (0 = disabled)
+    size_t audioCacheBytes = 0;
+    
+    /// ONNX Runtime threading, shared by all sessions unless overridden below
+    int intraOpThreads = 3;          // 0 = let ONNX Runtime decide
+    int interOpThreads = 1;          // > 1 runs independent graph nodes in parallel
+    bool allowSpinning = true;       // Busy-wait between ops (lower latency, more CPU)
+    /// Intra-op thread affinity in ONNX Runtime syntax, one group per thread
+    /// after the first, e.g. "1;2" or "1-2;3-4". Empty = no pinning.
+    std::string threadAffinity;
+    
+    /// Intra-/inter-op pools shared by every session in the process instead
+    /// of one pool per session, sized by intraOpThreads / interOpThreads.
+    /// Set by the first model loaded; models alive at the same time must
+    /// agree. Per-model thread overrides and threadAffinity are ignored.
+    bool globalThreadPools = false;
+    
+    /// Per-model intra-op thread overrides (0 = use intraOpThreads)
+    int textConditionerThreads = 0;
+    int flowLmMainThreads = 0;
+    int flowLmFlowThreads = 0;
+    int mimiDecoderThreads = 0;
+    int mimiEncoderThreads = 0;
+    
+    /// Execution provider: "cpu", "cuda", "coreml", "dml" or "xnnpack".
+    /// Nodes the provider can't run fall back to the CPU provider.
+    std::string executionProvider = "cpu";
+    int deviceId = 0;                // GPU index for cuda / dml
+    
+    /// Startup. Optimized graphs are written to optimizedModelCacheDir on the
+    /// first start and loaded without re-optimizing afterwards (empty = off);
+    /// they are specific to the CPU and execution provider that wrote them,
+    /// and are rebuilt when the source .onnx is newer.
+    std::string optimizedModelCacheDir;
+    bool lazyLoad = false;              // Create mimi_encoder / text_conditioner on first use
+    bool sharePrepackedWeights = true;  // Prepack identical weights once per process
+    bool mapModelFiles = true;          // Create sessions from memory-mapped model bytes
+    
+    /// CPU memory. By default every session owns an arena that grows to its
+    /// peak and keeps it; PocketTTSModel::memoryUsage() reports the result.
+    bool cpuArena = true;               // false = plain malloc / free per tensor
+    /// One arena for all sessions of the process (first model's settings win)
+    bool sharedArena = false;
+    /// Shared arena growth: "next_power_of_two" or "same_as_requested" (tighter)
+    std::string arenaExtendStrategy = "next_power_of_two";
+    size_t arenaMaxBytes = 0;           // Shared arena cap (0 = unlimited)
+    /// Return unused arena chunks to the OS after every session run, so RSS
+    /// falls back after a long utterance (costs some reallocation per run)
+    bool arenaShrinkage = false;
+    
+    /// Optional per-stage timing hook (benchmarks, tracing); no cost when unset
+    StageTimingCallback onStageTiming = nullptr;
+    /// Optional hook receiving GenerationStats after every request (metrics export)
+    GenerationStatsCallback onGenerationStats = nullptr;
     bool verbose = true;
 };
 
+/// Tag stored with saved voices; bumped when the encoder's embedding space changes
+constexpr const char* VOICE_MODEL_VERSION = "pocket-tts-mimi-v1";
+
+/**
+ * @brief Voice conditioning embeddings with their provenance
+ */
+struct POCKET_TTS_API VoiceEmbedding {
+    std::vector<float> embeddings;
+    std::vector<int64_t> shape;      // [1, N, 1024]
+    uint64_t sourceHash = 0;         // hashAudio() of the 24 kHz reference audio
+    std::string modelVersion = VOICE_MODEL_VERSION;
+};
+
+/// Admission class of a BatchRequest; lower values go first
+enum class RequestPriority {
+    Interactive = 0,  ///< Live conversation: preempts lower classes when the batch is full
+    Normal = 1,
+    Bulk = 2          ///< Offline rendering: runs when nothing else is waiting
+};
+
+/// Where a BatchScheduler request is (BatchScheduler::status)
+enum class RequestStatus {
+    Queued,     ///< Waiting for a batch slot
+    Running,    ///< Stepped every frame
+    Paused,     ///< Preempted by a higher-priority request; state kept, resumes later
+    Completed,
+    Failed,     ///< takeResult() rethrows the error
+    Cancelled,  ///< takeResult() returns the audio decoded before cancellation
+    Expired,    ///< Not admitted before its deadline; no audio
+    Unknown     ///< Never submitted, or its result was already taken
+};
+
+/**
+ * @brief One utterance submitted to batched generation
+ */
+struct POCKET_TTS_API BatchRequest {
+    std::string text;
+    std::vector<float> voiceEmbeddings;
+    std::vector<int64_t> voiceEmbeddingShape;
+    
+    /// Optional: stream audio every chunkSizeFrames frames. Called from the
+    /// scheduler's worker threads; isFinal marks the request's last chunk.
+    /// Streamed audio is not kept, so takeResult() returns an empty vector.
+    AudioChunkCallback callback = nullptr;
+    int chunkSizeFrames = 5;
+    
+    /// Noise seed of this request (< 0 = the context's, see PocketTTS::setSeed)
+    int64_t seed = -1;
+    
+    /// Scheduling. Queued requests are admitted by priority, then earliest
+    /// deadline, then submission order; a request still queued at its
+    /// deadline expires without running.
+    RequestPriority priority = RequestPriority::Normal;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    /// Cancels the request, queued, paused or running, at the next frame.
+    /// As in StreamingConfig, latents not yet decoded are dropped and a
+    /// streaming request's callback gets an empty final chunk.
+    CancellationToken cancellation;
+};
+
+class BatchScheduler;
+class PocketTTS;
+
+/**
+ * @brief Loaded Pocket TTS weights, shared across generation contexts
+ * 
+ * Holds the ONNX sessions, tokenizer and shared caches. A model
+ * is immutable after loading and safe to use from many threads: create one
+ * and hand it to any number of PocketTTS contexts, which then share a
+ * single copy of the weights.
+ */
+class POCKET_TTS_API PocketTTSModel {
+public:
+    /**
+     * @brief Load all models described by config
+     * @throws std::runtime_error / Ort::Exception if loading fails
+     */
+    static std::shared_ptr<PocketTTSModel> load(const PocketTTSConfig& config = PocketTTSConfig{});
+    
+    explicit PocketTTSModel(const PocketTTSConfig& config);
+    ~PocketTTSModel();
+    
+    PocketTTSModel(const PocketTTSModel&) = delete;
+    PocketTTSModel& operator=(const PocketTTSModel&) = delete;
+    
+    /// Configuration the model was loaded with
+    const PocketTTSConfig& config() const;
+    
+    /**
+     * @brief Encode a voice file to embeddings (thread-safe, cached by a
+     *        hash of the decoded audio, so renamed or copied files hit)
+     * @param audioPath Path to voice audio file
+     * @return Voice embeddings
+     */
+    std::vector<float> encodeVoice(const std::string& audioPath) const;
+    
+    /**
+     * @brief Encode a voice file with its shape and content hash
+     * @param audioPath Path to voice audio file
+     * @return Embeddings ready for saveVoice() or generateWithEmbeddings()
+     */
+    VoiceEmbedding encodeVoiceEmbedding(const std::string& audioPath) const;
+    
+    /**
+     * @brief Encode a voice from audio in memory (no temporary files)
+     * @param samples Mono float samples
+     * @param count Number of samples
+     * @param sampleRate Sample rate of samples (resampled to 24 kHz)
+     */
+    VoiceEmbedding encodeVoiceFromSamples(const float* samples, size_t count, int sampleRate) const;
+    
+    /**
+     * @brief Save the LM state after this voice's conditioning pass
+     * 
+     * The file is tied to the flow_lm_main model it was produced with.
+     * @throws std::runtime_error if the file cannot be written
+     */
+    void saveVoicePrefix(const VoiceEmbedding& voice, const std::string& path) const;
+    
+    /**
+     * @brief Add a saved voice prefix to the in-memory prefix cache
+     * 
+     * Requests for that voice then skip the voice conditioning pass.
+     * Has no effect when voicePrefixCacheSize is 0.
+     * @throws std::runtime_error if the file doesn't match the loaded model
+     */
+    void loadVoicePrefix(const std::string& path) const;
+    
+    /// Counters of the text and audio caches (textCacheBytes, audioCacheBytes)
+    CacheStats cacheStats() const;
+    
+    /// Drop every entry of the text and audio caches; counters are kept
+    void clearCaches() const;
+    
+    /// Process RSS and the bytes held by this model's caches
+    MemoryUsage memoryUsage() const;
+    
+    /**
+     * @brief Warm the text and voice-prefix caches for an upcoming request
+     * 
+     * Runs tokenization, text_conditioner and the voice pass now (on the
+     * calling thread) so whichever context takes the request later skips
+     * them. Meant for request queues: call it for the next queued request
+     * from an idle thread. Thread-safe.
+     */
+    void prefetch(const std::string& text,
+                  const std::vector<float>& voiceEmbeddings,
+                  const std::vector<int64_t>& voiceEmbeddingShape) const;
+
+private:
+    friend class PocketTTS;
+    
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
 /**
  * @brief Pure C++ ONNX inference engine for Pocket TTS
  * 
@@ -74,6 +550,11 @@ struct POCKET_TTS_API PocketTTSConfig {
  * - Offline (batch) generation
  * - Voice cloning from audio files
  * - Temperature control for generation diversity
+ * 
+ * A PocketTTS instance is a generation context: it owns the RNG, the
+ * per-request LM/decoder state and the cancellation flag, and runs one
+ * generation at a time. For concurrent callers, load a PocketTTSModel once
+ * and give each thread its own context built from it.
  */
 class POCKET_TTS_API PocketTTS {
 public:
@@ -86,6 +567,12 @@ public:
      * @param config Configuration options
      */
     explicit PocketTTS(const PocketTTSConfig& config = PocketTTSConfig{});
+    
+    /**
+     * @brief Construct a lightweight context over an already loaded model
+     * @param model Shared model; kept alive by this context
+     */
+    explicit PocketTTS(std::shared_ptr<PocketTTSModel> model);
     ~PocketTTS();
     
     // Disable copy
@@ -96,6 +583,9 @@ public:
     PocketTTS(PocketTTS&&) noexcept;
     PocketTTS& operator=(PocketTTS&&) noexcept;
     
+    /// Model this context generates with
+    std::shared_ptr<PocketTTSModel> model() const;
+    
     /**
      * @brief Generate audio from text with voice cloning
      * @param text Text to synthesize
@@ -114,6 +604,22 @@ public:
      */
     std::vector<float> encodeVoice(const std::string& audioPath);
     
+    /**
+     * @brief Encode a voice file with its shape and content hash
+     * @param audioPath Path to voice audio file
+     * @return Embeddings ready for saveVoice() or generateWithEmbeddings()
+     */
+    VoiceEmbedding encodeVoiceEmbedding(const std::string& audioPath);
+    
+    /**
+     * @brief Encode a voice from audio in memory (no temporary files)
+     * @param samples Mono float samples
+     * @param count Number of samples
+     * @param sampleRate Sample rate of samples (resampled to 24 kHz)
+     * @return Embeddings, cached by a hash of the audio content
+     */
+    VoiceEmbedding encodeVoiceFromSamples(const float* samples, size_t count, int sampleRate);
+    
     /**
      * @brief Generate with pre-computed voice embeddings
      * @param text Text to synthesize
@@ -127,6 +633,26 @@ public:
         const std::vector<int64_t>& voiceEmbeddingShape
     );
     
+    /**
+     * @brief Generate straight into a caller-provided buffer
+     * 
+     * Decoder output is written to output as it is produced, with no
+     * intermediate vector. Audio beyond capacity is dropped; size the
+     * buffer with maxSamples() to never truncate.
+     * 
+     * @return Total samples of the utterance (may exceed capacity)
+     */
+    size_t generateInto(
+        const std::string& text,
+        const std::vector<float>& voiceEmbeddings,
+        const std::vector<int64_t>& voiceEmbeddingShape,
+        float* output,
+        size_t capacity
+    );
+    
+    /// Upper bound on the samples one generate call returns (maxFrames worth)
+    size_t maxSamples() const;
+    
     /**
      * @brief Generate audio with streaming callback
      * 
@@ -149,13 +675,183 @@ public:
         const StreamingConfig& streamConfig = StreamingConfig{}
     );
     
+    /**
+     * @brief Synthesize a long document with segments generated in parallel
+     * 
+     * Splits text into sentence-sized segments, synthesizes them on
+     * longFormConfig.numThreads worker contexts sharing this model, and
+     * delivers the stitched audio in order through callback on the calling
+     * thread. Each segment stays well below maxFrames, so length is no
+     * longer capped and wall-clock time scales with core count.
+     * Stops early on cancelStreaming().
+     * 
+     * @return Total number of samples delivered
+     */
+    int generateLongForm(
+        const std::string& text,
+        const std::vector<float>& voiceEmbeddings,
+        const std::vector<int64_t>& voiceEmbeddingShape,
+        AudioChunkCallback callback,
+        const LongFormConfig& longFormConfig = LongFormConfig{}
+    );
+    
+    /**
+     * @brief Choose the flow integrator for the following requests on this context
+     * 
+     * Starts as PocketTTSConfig::flow. In a BatchScheduler the context's
+     * setting applies to the whole batch, and postEosSteps is ignored so
+     * requests stay in lockstep.
+     */
+    void setFlowConfig(const FlowConfig& flow);
+    
+    /// Current flow integrator of this context
+    const FlowConfig& flowConfig() const;
+    
+    /**
+     * @brief Noise seed of the following requests on this context
+     * 
+     * Starts as PocketTTSConfig::seed; < 0 draws a fresh seed per request.
+     * Frame f of a request starts from noise that depends only on (seed, f),
+     * so equal seeds give equal audio on any context or thread, and
+     * long-form segments derive their seeds from the request's.
+     */
+    void setSeed(int64_t seed);
+    
+    /// Current seed of this context (< 0 = random per request)
+    int64_t seed() const;
+    
+    /**
+     * @brief Prepare the next utterance while the current one is generating
+     * 
+     * Starts tokenization, text conditioning and the voice and text passes
+     * of text on a background thread and returns immediately. The next
+     * generate or generateStreaming call on this context with the same text
+     * and voice starts at its first frame, so consecutive sentences play
+     * with almost no gap. A different request discards the prefetch (after
+     * waiting for it; its cache entries are still used). May be called
+     * while another thread is generating on this context.
+     */
+    void prefetch(const std::string& text,
+                  const std::vector<float>& voiceEmbeddings,
+                  const std::vector<int64_t>& voiceEmbeddingShape);
+    
     /**
      * @brief Cancel ongoing streaming generation
      * 
-     * This will cause the current generateStreaming call to stop early.
-     * Only works if StreamingConfig.enableCancellation is true.
+     * This will cause the current generateStreaming call to stop early,
+     * at the next frame boundary. To cancel one specific request, use
+     * StreamingConfig::cancellation instead.
      */
     void cancelStreaming();
+    
+    /**
+     * @brief Stats of the most recent generate, generateWithEmbeddings,
+     *        generateStreaming or generateLongForm call on this context
+     * 
+     * Long-form stats are summed over segments; eosStep is that of the
+     * last segment.
+     */
+    const GenerationStats& lastStats() const;
+    
+    /**
+     * @brief Generate several utterances together
+     * 
+     * Convenience wrapper around BatchScheduler: up to maxBatchSize requests
+     * are stepped frame by frame together, and queued requests are admitted
+     * as others finish.
+     * 
+     * @param requests Utterances to synthesize
+     * @param maxBatchSize Maximum number of requests in flight at once
+     * @return Generated audio per request, in request order
+     */
+    std::vector<std::vector<float>> generateBatch(
+        const std::vector<BatchRequest>& requests,
+        int maxBatchSize = 8
+    );
+
+private:
+    friend class BatchScheduler;
+    
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/// Per-caller generation context over a shared PocketTTSModel
+using GenerationContext = PocketTTS;
+
+/**
+ * @brief Continuous batching across concurrent utterances
+ * 
+ * Each step() advances every active request by one frame: the flow_lm_main
+ * steps run in parallel on a worker pool (each request keeps its own KV
+ * state), flow matching runs as one batched flow_lm_flow call per Euler
+ * step when the graph allows it, and each request's latents are decoded
+ * in chunks as they accumulate before it is retired. Requests submitted
+ * at any time are admitted between frames.
+ * 
+ * Frame boundaries are also scheduling points. When the batch is full and
+ * a queued request has a higher RequestPriority than an active one, the
+ * lowest-priority active request is paused (its LM and decoder state are
+ * kept) and resumes once a slot is free. Cancelled requests leave the
+ * batch before their next frame; expired ones never enter it.
+ * 
+ * submit() may be called from any thread; step() must be driven by one
+ * thread at a time and must not overlap other generation calls on the
+ * same PocketTTS instance.
+ */
+class POCKET_TTS_API BatchScheduler {
+public:
+    /**
+     * @param tts Engine to run on (must outlive the scheduler)
+     * @param maxBatchSize Maximum number of requests in flight at once
+     */
+    explicit BatchScheduler(PocketTTS& tts, int maxBatchSize = 8);
+    ~BatchScheduler();
+    
+    BatchScheduler(const BatchScheduler&) = delete;
+    BatchScheduler& operator=(const BatchScheduler&) = delete;
+    
+    /**
+     * @brief Queue a request; it is admitted at the next frame boundary
+     * @return Request id for isDone()/takeResult()
+     */
+    int submit(BatchRequest request);
+    
+    /**
+     * @brief Admit queued requests and advance all active ones by one frame
+     * @return False if there was nothing to do
+     */
+    bool step();
+    
+    /// Step until no active or queued requests remain
+    void runUntilIdle();
+    
+    /// True once the request's audio is available (or it failed)
+    bool isDone(int requestId) const;
+    
+    /// Scheduling state of a request
+    RequestStatus status(int requestId) const;
+    
+    /**
+     * @brief Cancel a request at the next frame boundary
+     * @return False if the request is unknown or already finished
+     */
+    bool cancel(int requestId);
+    
+    /**
+     * @brief Take the finished request's audio
+     * 
+     * Cancelled requests return the audio produced so far and expired ones
+     * an empty vector; use status() first to tell them apart. Requests with
+     * a callback always return an empty vector.
+     * @throws std::runtime_error if the request is unknown or not finished,
+     *         or rethrows the error the request failed with
+     */
+    std::vector<float> takeResult(int requestId);
+    
+    int activeCount() const;
+    int queuedCount() const;
+    int pausedCount() const;
 
 private:
     struct Impl;
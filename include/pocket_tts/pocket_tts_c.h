@@ -1,6 +1,8 @@
 #ifndef POCKET_TTS_C_H
 #define POCKET_TTS_C_H
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -20,16 +22,108 @@ extern "C" {
 
 /* Opaque handles */
 typedef void* PocketTTSHandle;
+typedef void* PocketTTSModelHandle;
 typedef void* VoiceHandle;
+typedef void* PocketTTSCancelToken;
+
+/* Pipeline stages reported to the stage timing callback */
+enum {
+    POCKET_TTS_STAGE_TOKENIZE = 0,
+    POCKET_TTS_STAGE_TEXT_CONDITIONER = 1,
+    POCKET_TTS_STAGE_VOICE_PREFILL = 2,
+    POCKET_TTS_STAGE_TEXT_PREFILL = 3,
+    POCKET_TTS_STAGE_MAIN_STEP = 4,
+    POCKET_TTS_STAGE_FLOW = 5,
+    POCKET_TTS_STAGE_DECODE = 6
+};
+
+/* Flow integrator settings (PocketTTSConfig / pocket_tts_set_flow) */
+enum {
+    POCKET_TTS_FLOW_EULER = 0,      /* One flow_lm_flow run per step */
+    POCKET_TTS_FLOW_HEUN = 1        /* Two runs per step, second order */
+};
+enum {
+    POCKET_TTS_SCHEDULE_UNIFORM = 0,
+    POCKET_TTS_SCHEDULE_COSINE = 1,     /* Shorter steps near both ends */
+    POCKET_TTS_SCHEDULE_QUADRATIC = 2   /* Shorter steps near the noise end */
+};
+
+/**
+ * Callback receiving the duration of one pipeline stage.
+ * Called from generation (and decoder) threads; must be thread-safe.
+ *
+ * @param stage POCKET_TTS_STAGE_* value
+ * @param stage_name Stable name, e.g. "main_step"
+ * @param milliseconds Wall-clock duration
+ * @param user_data stage_timing_user_data from the config
+ */
+typedef void (*StageTimingCallbackC)(
+    int stage,
+    const char* stage_name,
+    double milliseconds,
+    void* user_data
+);
 
 /* Configuration */
 typedef struct {
     const char* models_dir;      /* Default: "models/onnx" */
     const char* tokenizer_path;  /* Default: "models/tokenizer.model" */
-    const char* precision;       /* "int8" or "fp32", default: "int8" */
+    const char* precision;       /* "int8", "fp16" or "fp32", default: "int8" */
     float temperature;           /* 0.0-1.0, default: 0.7 */
     int lsd_steps;              /* Flow matching steps, default: 10 */
     int max_frames;             /* Max frames to generate, default: 500 */
+    
+    /* Threading (0 / NULL = default) */
+    int intra_op_threads;       /* Intra-op threads per model, default: 3 */
+    int inter_op_threads;       /* > 1 enables parallel graph execution, default: 1 */
+    int disable_spinning;       /* 1 = don't busy-wait between ops, default: 0 */
+    const char* thread_affinity; /* e.g. "1;2" or "1-2;3-4", default: none */
+    int text_conditioner_threads; /* Per-model overrides of intra_op_threads */
+    int flow_lm_main_threads;
+    int flow_lm_flow_threads;
+    int mimi_decoder_threads;
+    int mimi_encoder_threads;
+    
+    /* Execution provider */
+    const char* execution_provider; /* "cpu", "cuda", "coreml", "dml", "xnnpack", default: "cpu" */
+    int device_id;              /* GPU index for cuda / dml, default: 0 */
+    
+    /* Optional per-stage timing hook (metrics export), default: none */
+    StageTimingCallbackC stage_timing_callback;
+    void* stage_timing_user_data;
+    
+    /* Startup */
+    const char* optimized_model_cache_dir; /* Reuse optimized graphs across starts, default: off */
+    int lazy_load;              /* 1 = create encoder / text conditioner on first use */
+    int disable_prepacked_sharing; /* 1 = don't share prepacked weights in the process */
+    int disable_model_mapping;  /* 1 = load models by path instead of memory-mapping */
+    
+    /* Flow integration, default: Euler over lsd_steps uniform steps */
+    int flow_solver;            /* POCKET_TTS_FLOW_* */
+    int flow_schedule;          /* POCKET_TTS_SCHEDULE_* */
+    int post_eos_lsd_steps;     /* Steps for frames after EOS, default: lsd_steps */
+    
+    int disable_overlap_decode; /* 1 = pocket_tts_generate decodes on the calling thread */
+    
+    /* Caches shared by all instances of a model */
+    int text_cache_mb;          /* Token ids + text embeddings per prompt, default: 16; < 0 = off */
+    int audio_cache_mb;         /* Memoized results (temperature 0 or fixed seed), default: 0 (off) */
+    
+    /* Reproducible noise: with fixed_seed = 1 every request uses seed */
+    int fixed_seed;             /* Default: 0 (fresh seed per request) */
+    uint64_t seed;              /* Below 2^63 */
+    
+    /* Bounded LM context: re-prime after this many frames, default: 0 (unbounded) */
+    int context_window_frames;
+    int context_keep_frames;    /* Latents replayed on re-prime, default: half the window */
+    
+    /* Memory footprint (see PocketTTSConfig in pocket_tts.hpp) */
+    int global_thread_pools;    /* 1 = process-wide thread pools */
+    int disable_cpu_arena;      /* 1 = plain malloc / free per tensor */
+    int shared_arena;           /* 1 = one CPU arena for the whole process */
+    const char* arena_extend_strategy; /* "next_power_of_two" (default) or "same_as_requested" */
+    int arena_max_mb;           /* Shared arena cap, default: 0 (unlimited) */
+    int arena_shrinkage;        /* 1 = release unused arena memory after every run */
 } PocketTTSConfig;
 
 /* Result structure for audio */
@@ -37,6 +131,7 @@ typedef struct {
     float* data;                /* Audio samples (24kHz mono) */
     int sample_count;           /* Number of samples */
     int sample_rate;            /* Always 24000 */
+    void* owner;                /* Library-owned storage behind data; don't touch */
 } AudioResult;
 
 /*
@@ -52,6 +147,31 @@ POCKET_TTS_API PocketTTSHandle pocket_tts_create(const PocketTTSConfig* config);
  */
 POCKET_TTS_API void pocket_tts_destroy(PocketTTSHandle handle);
 
+/*
+ * Load the models once so several instances can share them.
+ * Each instance created from the model keeps its own generation state,
+ * so different threads can generate concurrently with one copy of the weights.
+ *
+ * @param config Configuration options. Pass NULL for defaults.
+ * @return Model handle, or NULL on error.
+ */
+POCKET_TTS_API PocketTTSModelHandle pocket_tts_model_create(const PocketTTSConfig* config);
+
+/*
+ * Release a model handle. Instances created from it stay valid
+ * and keep the weights alive until they are destroyed.
+ */
+POCKET_TTS_API void pocket_tts_model_destroy(PocketTTSModelHandle model);
+
+/*
+ * Create a lightweight PocketTTS instance over a loaded model.
+ * Destroy it with pocket_tts_destroy.
+ *
+ * @param model Model handle from pocket_tts_model_create
+ * @return Handle to the instance, or NULL on error.
+ */
+POCKET_TTS_API PocketTTSHandle pocket_tts_create_from_model(PocketTTSModelHandle model);
+
 /*
  * Encode a voice from an audio file.
  * The returned handle can be reused for multiple generations.
@@ -78,6 +198,29 @@ POCKET_TTS_API VoiceHandle pocket_tts_encode_voice_from_samples(
     int sample_rate
 );
 
+/*
+ * Load a voice file saved with pocket_tts_save_voice.
+ * The embeddings are read into the handle; no model or voice encoder is needed.
+ *
+ * @param voice_path Path to a .ptv voice file
+ * @return Voice handle, or NULL on error
+ */
+POCKET_TTS_API VoiceHandle pocket_tts_load_voice(const char* voice_path);
+
+/*
+ * Save a voice to the binary voice file format
+ * (embeddings, shape, model version and source-audio hash).
+ *
+ * @return 0 on success, non-zero on error
+ */
+POCKET_TTS_API int pocket_tts_save_voice(VoiceHandle voice, const char* voice_path);
+
+/*
+ * Content hash of the reference audio a voice was encoded from
+ * (0 if unknown).
+ */
+POCKET_TTS_API uint64_t pocket_tts_voice_hash(VoiceHandle voice);
+
 /*
  * Free a voice handle.
  */
@@ -104,12 +247,43 @@ POCKET_TTS_API int pocket_tts_generate(
  */
 POCKET_TTS_API void pocket_tts_free_audio(AudioResult* result);
 
+/*
+ * Generate speech straight into a caller-provided buffer.
+ *
+ * Samples are written as the decoder produces them, with no intermediate
+ * copy. If the audio is longer than capacity, the first capacity samples
+ * are written, sample_count still receives the full length and 1 is
+ * returned (like snprintf). A buffer of pocket_tts_max_samples() samples
+ * never truncates.
+ *
+ * @param buffer Output samples (24kHz mono float); may be NULL when capacity is 0
+ * @param capacity Size of buffer in samples
+ * @param sample_count Receives the total samples of the utterance
+ * @return 0 on success, 1 if truncated, -1 on error
+ */
+POCKET_TTS_API int pocket_tts_generate_into(
+    PocketTTSHandle handle,
+    const char* text,
+    VoiceHandle voice,
+    float* buffer,
+    int capacity,
+    int* sample_count
+);
+
+/*
+ * Upper bound on the samples one generate call produces (max_frames worth).
+ *
+ * @return Sample count, or -1 on error
+ */
+POCKET_TTS_API int pocket_tts_max_samples(PocketTTSHandle handle);
+
 /**
  * Callback for audio chunks during streaming generation.
  * 
  * @param samples Audio samples (24kHz mono float)
  * @param sample_count Number of samples in this chunk
- * @param is_final 1 if this is the final chunk, 0 otherwise
+ * @param is_final 1 if this is the final chunk, 0 otherwise (a cancelled
+ *        stream ends with an empty final chunk)
  * @param user_data User-provided context pointer
  */
 typedef void (*AudioChunkCallbackC)(
@@ -125,6 +299,20 @@ typedef void (*AudioChunkCallbackC)(
 typedef struct {
     int chunk_size_frames;      /* Decode every N frames (default: 5) */
     void* user_data;            /* User context passed to callback */
+    int pipelined;              /* 1 = decode on a separate thread; callback runs there */
+    int queue_depth;            /* Chunks in flight before generation blocks (default: 4) */
+    
+    /* Chunk sizing for lower time-to-first-audio (0 / NULL = fixed chunk_size_frames) */
+    const int* chunk_schedule;  /* Explicit sizes, last entry repeats */
+    int chunk_schedule_length;
+    int first_chunk_frames;     /* Geometric ramp start, capped at chunk_size_frames */
+    float chunk_growth;         /* Ramp factor per chunk (default: 2.0) */
+    float target_latency_ms;    /* Size chunks from measured frame timings */
+    
+    int fixed_seed;             /* 1 = use seed for this request (default: the instance's) */
+    uint64_t seed;              /* Below 2^63 */
+    
+    PocketTTSCancelToken cancel_token;  /* Stops this stream only (NULL = none) */
 } StreamingConfig;
 
 /*
@@ -147,13 +335,127 @@ POCKET_TTS_API int pocket_tts_generate_streaming(
 );
 
 /*
- * Cancel ongoing streaming generation.
- * Only works if streaming was started with cancellation enabled.
+ * Counters of one generate call (see pocket_tts_get_last_stats).
+ * Session times are wall-clock milliseconds summed over all runs.
+ */
+typedef struct {
+    int text_tokens;
+    int frames_generated;
+    int eos_step;               /* -1 if generation hit max_frames */
+    int audio_samples;
+    int voice_prefix_cached;    /* 1 if the voice pass was skipped */
+    
+    int text_conditioner_runs;
+    double text_conditioner_ms;
+    int flow_lm_main_runs;
+    double flow_lm_main_ms;
+    int flow_lm_flow_runs;
+    double flow_lm_flow_ms;
+    int mimi_decoder_runs;
+    double mimi_decoder_ms;
+    
+    uint64_t state_bytes_copied; /* State bytes copied between buffers (0 on the in-place paths) */
+    double time_to_first_audio_ms;
+    double total_ms;
+    
+    int text_cached;            /* 1 if tokenization and text_conditioner were skipped */
+    int audio_cached;           /* 1 if the result came from the audio cache */
+    uint64_t seed;              /* Noise seed used; pass to pocket_tts_set_seed to reproduce */
+    uint64_t lm_state_bytes;    /* Peak flow_lm_main state size */
+    int context_reprimes;       /* Re-primes of a bounded context */
+    int prefetched;             /* 1 if the prefill came from pocket_tts_prefetch */
+    int cancelled;              /* 1 if the generation was cancelled */
+    uint64_t state_bytes_allocated; /* State buffers allocated (grown KV caches, prefix divergence) */
+} PocketTTSStats;
+
+/*
+ * Get the stats of the last pocket_tts_generate or
+ * pocket_tts_generate_streaming call on this instance.
+ *
+ * @return 0 on success, non-zero on error
+ */
+POCKET_TTS_API int pocket_tts_get_last_stats(PocketTTSHandle handle, PocketTTSStats* stats);
+
+/* Process and cache memory of an instance's model, in bytes */
+typedef struct {
+    uint64_t resident_bytes;    /* Process RSS, 0 if unknown */
+    uint64_t peak_resident_bytes;
+    uint64_t model_file_bytes;
+    uint64_t voice_cache_bytes;
+    uint64_t text_cache_bytes;
+    uint64_t audio_cache_bytes;
+} PocketTTSMemoryUsage;
+
+/*
+ * Get the memory usage of the model behind this instance.
+ *
+ * @return 0 on success, non-zero on error
+ */
+POCKET_TTS_API int pocket_tts_get_memory_usage(PocketTTSHandle handle, PocketTTSMemoryUsage* usage);
+
+/*
+ * Start the conditioning passes of the next utterance in the background
+ * and return immediately. The next pocket_tts_generate(_streaming) call on
+ * this instance with the same text and voice skips them, so consecutive
+ * sentences follow each other with almost no gap. May be called while
+ * another thread is generating on this instance.
+ *
+ * @return 0 on success, non-zero on error
+ */
+POCKET_TTS_API int pocket_tts_prefetch(PocketTTSHandle handle, const char* text, VoiceHandle voice);
+
+/*
+ * Set the noise seed of the following requests on this instance.
+ * Equal seeds give equal audio on any instance of the same model.
+ *
+ * @param seed Seed below 2^63, or negative for a fresh seed per request
+ * @return 0 on success, non-zero on error
+ */
+POCKET_TTS_API int pocket_tts_set_seed(PocketTTSHandle handle, int64_t seed);
+
+/*
+ * Change the flow integrator for the following requests on this instance.
+ *
+ * @param solver POCKET_TTS_FLOW_*
+ * @param schedule POCKET_TTS_SCHEDULE_*
+ * @param steps Steps per frame (0 = lsd_steps of the config)
+ * @param post_eos_steps Steps for frames after EOS (0 = steps)
+ * @return 0 on success, non-zero on error
+ */
+POCKET_TTS_API int pocket_tts_set_flow(
+    PocketTTSHandle handle,
+    int solver,
+    int schedule,
+    int steps,
+    int post_eos_steps
+);
+
+/*
+ * Cancel ongoing streaming generation of this instance.
+ * Takes effect at the next frame; use a cancel token to stop one stream.
  *
  * @param handle PocketTTS instance
  */
 POCKET_TTS_API void pocket_tts_cancel_streaming(PocketTTSHandle handle);
 
+/*
+ * Cancellation token for one request (StreamingConfig.cancel_token).
+ * Cancelling is thread-safe and sticky; the token may be destroyed once
+ * the generation using it has returned.
+ *
+ * @return Token handle, or NULL on error
+ */
+POCKET_TTS_API PocketTTSCancelToken pocket_tts_cancel_token_create(void);
+
+/* Request cancellation of every generation using the token */
+POCKET_TTS_API void pocket_tts_cancel_token_cancel(PocketTTSCancelToken token);
+
+/* 1 if the token was cancelled, 0 otherwise */
+POCKET_TTS_API int pocket_tts_cancel_token_is_cancelled(PocketTTSCancelToken token);
+
+/* Free a token */
+POCKET_TTS_API void pocket_tts_cancel_token_destroy(PocketTTSCancelToken token);
+
 /*
  * Get the last error message.
  * The returned string is valid until the next API call.
@@ -33,6 +33,18 @@ public:
      */
     std::vector<int64_t> encode(const std::string& text) const;
     
+    /**
+     * @brief The preprocessing step of encode(): trim, add final punctuation
+     *        and capitalize. Texts with equal results encode identically.
+     * @throws std::runtime_error if the text is empty or only whitespace
+     */
+    static std::string normalize(const std::string& text);
+    
+    /**
+     * @brief Encode text that already went through normalize()
+     */
+    std::vector<int64_t> encodeNormalized(const std::string& normalizedText) const;
+    
     /**
      * @brief Get vocabulary size
      */
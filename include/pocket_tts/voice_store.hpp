@@ -0,0 +1,84 @@
+#pragma once
+
+#include "pocket_tts/pocket_tts.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pocket_tts {
+
+/// Current version of the binary voice file format (.ptv)
+constexpr uint32_t VOICE_FILE_FORMAT_VERSION = 1;
+
+/// Extension used for voice files in a VoiceLibrary
+constexpr const char* VOICE_FILE_EXTENSION = ".ptv";
+
+/**
+ * @brief Content hash (64-bit FNV-1a) of 24 kHz mono reference audio
+ *
+ * Identifies the audio an embedding was encoded from, independent of the
+ * file name or container it came in.
+ */
+POCKET_TTS_API uint64_t hashAudio(const float* samples, size_t count);
+
+/**
+ * @brief Write voice embeddings to a binary voice file
+ *
+ * Layout (little-endian): a fixed 128-byte header with magic "PTTSVOIC",
+ * format version, shape, source hash and model version, followed by the
+ * float32 embeddings at a 64-byte aligned data offset.
+ *
+ * @throws std::runtime_error if the file cannot be written
+ */
+POCKET_TTS_API void saveVoice(const std::string& path, const VoiceEmbedding& voice);
+
+/**
+ * @brief Read a voice file written by saveVoice
+ *
+ * The file is mapped only while it is parsed; the embeddings are copied
+ * into the returned VoiceEmbedding.
+ *
+ * @throws std::runtime_error if the file is missing, truncated, corrupt or
+ *         of an unsupported format version
+ */
+POCKET_TTS_API VoiceEmbedding loadVoice(const std::string& path);
+
+/**
+ * @brief Directory of voice files keyed by source-audio content hash
+ *
+ * Files are named <hash>.ptv. Opening a library only lists the directory;
+ * each voice is read on first use and then kept in memory, so a process
+ * can start with thousands of voices without running mimi_encoder.
+ * Safe to use from multiple threads.
+ */
+class POCKET_TTS_API VoiceLibrary {
+public:
+    /// Open (and create if missing) a voice directory
+    explicit VoiceLibrary(const std::string& directory);
+    ~VoiceLibrary();
+
+    VoiceLibrary(const VoiceLibrary&) = delete;
+    VoiceLibrary& operator=(const VoiceLibrary&) = delete;
+
+    /// Store a voice under voice.sourceHash, replacing any existing entry
+    void put(const VoiceEmbedding& voice);
+
+    /// Voice for a content hash, or nullptr if the library has none
+    std::shared_ptr<const VoiceEmbedding> get(uint64_t sourceHash);
+
+    bool contains(uint64_t sourceHash) const;
+
+    /// Content hashes of all voices in the directory
+    std::vector<uint64_t> list() const;
+
+    /// File a voice with this hash is stored in
+    std::string pathFor(uint64_t sourceHash) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace pocket_tts
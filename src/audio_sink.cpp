@@ -0,0 +1,387 @@
+#include "pocket_tts/audio_sink.hpp"
+#include "pocket_tts/audio_utils.hpp"
+#include "wav_format.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define POCKET_TTS_PCM_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define POCKET_TTS_PCM_NEON 1
+#endif
+
+#ifdef POCKET_TTS_USE_OPUS
+#include <opus.h>
+#endif
+
+namespace pocket_tts {
+namespace {
+
+constexpr int SOURCE_SAMPLE_RATE = AudioUtils::TARGET_SAMPLE_RATE;
+
+// xorshift32; dither only needs to be cheap and uncorrelated with the signal
+struct DitherSource {
+    uint32_t state = 0x9E3779B9u;
+
+    float uniform() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return static_cast<float>(state >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // Triangular distribution on (-1, 1) LSB
+    void fill(float* out, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = uniform() - uniform();
+        }
+    }
+};
+
+// out[i] = saturate(round(in[i] * 32767 + dither[i])); dither may be null
+void floatToPcm16(const float* in, const float* dither, size_t count, int16_t* out) {
+    size_t i = 0;
+#if defined(POCKET_TTS_PCM_SSE2)
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(in + i), scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(in + i + 4), scale);
+        if (dither) {
+            a = _mm_add_ps(a, _mm_loadu_ps(dither + i));
+            b = _mm_add_ps(b, _mm_loadu_ps(dither + i + 4));
+        }
+        // Clamp before converting: out-of-range floats convert to INT_MIN
+        a = _mm_min_ps(_mm_max_ps(a, lo), hi);
+        b = _mm_min_ps(_mm_max_ps(b, lo), hi);
+        const __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+#elif defined(POCKET_TTS_PCM_NEON)
+    const float32x4_t scale = vdupq_n_f32(32767.0f);
+    const float32x4_t lo = vdupq_n_f32(-32768.0f);
+    const float32x4_t hi = vdupq_n_f32(32767.0f);
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t a = vmulq_f32(vld1q_f32(in + i), scale);
+        float32x4_t b = vmulq_f32(vld1q_f32(in + i + 4), scale);
+        if (dither) {
+            a = vaddq_f32(a, vld1q_f32(dither + i));
+            b = vaddq_f32(b, vld1q_f32(dither + i + 4));
+        }
+        a = vminq_f32(vmaxq_f32(a, lo), hi);
+        b = vminq_f32(vmaxq_f32(b, lo), hi);
+        const int16x8_t packed = vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)), vqmovn_s32(vcvtnq_s32_f32(b)));
+        vst1q_s16(out + i, packed);
+    }
+#endif
+    for (; i < count; ++i) {
+        float v = in[i] * 32767.0f + (dither ? dither[i] : 0.0f);
+        v = std::min(std::max(v, -32768.0f), 32767.0f);
+        out[i] = static_cast<int16_t>(std::lrint(v));
+    }
+}
+
+// Resamples from the model rate when needed; otherwise passes input through
+struct RateStage {
+    std::unique_ptr<StreamingResampler> resampler;
+    std::vector<float> buffer;
+
+    explicit RateStage(int sampleRate) {
+        if (sampleRate <= 0) {
+            throw std::invalid_argument("Sample rate must be positive");
+        }
+        if (sampleRate != SOURCE_SAMPLE_RATE) {
+            resampler = std::make_unique<StreamingResampler>(SOURCE_SAMPLE_RATE, sampleRate);
+        }
+    }
+
+    // Converted samples for this chunk, valid until the next call
+    const float* process(const float* samples, size_t& count) {
+        if (!resampler) return samples;
+        buffer.clear();
+        resampler->process(samples, count, buffer);
+        count = buffer.size();
+        return buffer.data();
+    }
+
+    const float* flush(size_t& count) {
+        count = 0;
+        if (!resampler) return nullptr;
+        buffer.clear();
+        resampler->flush(buffer);
+        count = buffer.size();
+        return buffer.data();
+    }
+};
+
+// Float to PCM16 with reused scratch buffers
+struct Pcm16Encoder {
+    bool dither;
+    DitherSource noise;
+    std::vector<float> ditherBuffer;
+    std::vector<int16_t> pcm;
+
+    explicit Pcm16Encoder(bool dither) : dither(dither) {}
+
+    const int16_t* encode(const float* samples, size_t count) {
+        pcm.resize(count);
+        const float* d = nullptr;
+        if (dither) {
+            ditherBuffer.resize(count);
+            noise.fill(ditherBuffer.data(), count);
+            d = ditherBuffer.data();
+        }
+        floatToPcm16(samples, d, count, pcm.data());
+        return pcm.data();
+    }
+};
+
+} // namespace
+
+// ── Pcm16Sink ──────────────────────────────────────────────────────────
+
+struct Pcm16Sink::Impl {
+    EncodedChunkCallback output;
+    RateStage rate;
+    Pcm16Encoder encoder;
+
+    Impl(EncodedChunkCallback out, int sampleRate, bool dither)
+        : output(std::move(out)), rate(sampleRate), encoder(dither) {}
+
+    void emit(const float* samples, size_t count) {
+        if (count == 0) return;
+        const int16_t* pcm = encoder.encode(samples, count);
+        output(reinterpret_cast<const uint8_t*>(pcm), count * sizeof(int16_t));
+    }
+};
+
+Pcm16Sink::Pcm16Sink(EncodedChunkCallback output, int sampleRate, bool dither) {
+    if (!output) {
+        throw std::invalid_argument("Pcm16Sink needs an output callback");
+    }
+    impl_ = std::make_unique<Impl>(std::move(output), sampleRate, dither);
+}
+
+Pcm16Sink::~Pcm16Sink() = default;
+
+void Pcm16Sink::write(const float* samples, size_t count) {
+    const float* converted = impl_->rate.process(samples, count);
+    impl_->emit(converted, count);
+}
+
+void Pcm16Sink::finish() {
+    size_t count = 0;
+    const float* tail = impl_->rate.flush(count);
+    impl_->emit(tail, count);
+}
+
+// ── WavFileSink ────────────────────────────────────────────────────────
+
+struct WavFileSink::Impl {
+    std::string path;
+    std::ofstream file;
+    RateStage rate;
+    WavSampleFormat format;
+    Pcm16Encoder encoder{true};
+    int sampleRate;
+    size_t samples = 0;
+    bool finished = false;
+
+    Impl(const std::string& filepath, int rateHz, WavSampleFormat fmt)
+        : path(filepath), file(filepath, std::ios::binary), rate(rateHz), format(fmt), sampleRate(rateHz) {
+        if (!file) {
+            throw std::runtime_error("Failed to create audio file: " + filepath);
+        }
+        writeHeader();
+    }
+
+    uint16_t bytesPerSample() const {
+        return format == WavSampleFormat::Pcm16 ? 2 : 4;
+    }
+
+    // Rewritten with the final size by finish()
+    void writeHeader() {
+        const uint64_t dataSize = static_cast<uint64_t>(samples) * bytesPerSample();
+        const WavFileHeader header = makeWavHeader(
+            format == WavSampleFormat::Pcm16 ? 1 : 3, static_cast<uint16_t>(bytesPerSample() * 8),
+            static_cast<uint32_t>(sampleRate), static_cast<uint32_t>(dataSize));
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    void append(const float* data, size_t count) {
+        if (count == 0) return;
+        // The RIFF size field counts the header after it plus the data
+        constexpr uint64_t MAX_DATA_BYTES = std::numeric_limits<uint32_t>::max() - (sizeof(WavFileHeader) - 8);
+        if ((static_cast<uint64_t>(samples) + count) * bytesPerSample() > MAX_DATA_BYTES) {
+            throw std::runtime_error("Audio exceeds the 4 GB WAV size limit: " + path);
+        }
+        if (format == WavSampleFormat::Pcm16) {
+            const int16_t* pcm = encoder.encode(data, count);
+            file.write(reinterpret_cast<const char*>(pcm), static_cast<std::streamsize>(count * sizeof(int16_t)));
+        } else {
+            file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(count * sizeof(float)));
+        }
+        if (!file) {
+            throw std::runtime_error("Failed to write audio file: " + path);
+        }
+        samples += count;
+    }
+};
+
+WavFileSink::WavFileSink(const std::string& filepath, int sampleRate, WavSampleFormat format)
+    : impl_(std::make_unique<Impl>(filepath, sampleRate, format)) {}
+
+WavFileSink::~WavFileSink() {
+    // Leave a valid file behind even if generation never finished
+    if (!impl_->finished) {
+        try {
+            finish();
+        } catch (...) {
+        }
+    }
+}
+
+void WavFileSink::write(const float* samples, size_t count) {
+    if (impl_->finished) {
+        throw std::runtime_error("WavFileSink is already finished: " + impl_->path);
+    }
+    const float* converted = impl_->rate.process(samples, count);
+    impl_->append(converted, count);
+}
+
+void WavFileSink::finish() {
+    if (impl_->finished) return;
+    size_t count = 0;
+    const float* tail = impl_->rate.flush(count);
+    impl_->append(tail, count);
+    impl_->writeHeader();
+    impl_->file.close();
+    impl_->finished = true;
+    if (!impl_->file) {
+        throw std::runtime_error("Failed to finalize audio file: " + impl_->path);
+    }
+}
+
+size_t WavFileSink::samplesWritten() const {
+    return impl_->samples;
+}
+
+// ── OpusSink ───────────────────────────────────────────────────────────
+
+#ifdef POCKET_TTS_USE_OPUS
+
+struct OpusSink::Impl {
+    EncodedChunkCallback output;
+    RateStage rate;
+    OpusEncoder* encoder = nullptr;
+    size_t frameSamples;
+    std::vector<float> pending;          // Less than one frame of input
+    std::vector<unsigned char> packet;
+
+    Impl(EncodedChunkCallback out, int sampleRate, int bitrate, int frameMs)
+        : output(std::move(out)), rate(sampleRate),
+          frameSamples(static_cast<size_t>(sampleRate) * static_cast<size_t>(frameMs) / 1000),
+          packet(4000) {  // Upper bound recommended by the libopus docs
+        if (frameMs != 10 && frameMs != 20 && frameMs != 40 && frameMs != 60) {
+            throw std::runtime_error("Unsupported Opus frame duration: " + std::to_string(frameMs) + " ms");
+        }
+        int error = OPUS_OK;
+        encoder = opus_encoder_create(sampleRate, 1, OPUS_APPLICATION_VOIP, &error);
+        if (error != OPUS_OK || !encoder) {
+            throw std::runtime_error(std::string("Failed to create Opus encoder: ") + opus_strerror(error));
+        }
+        if (bitrate > 0) {
+            opus_encoder_ctl(encoder, OPUS_SET_BITRATE(bitrate));
+        }
+        pending.reserve(frameSamples);
+    }
+
+    ~Impl() {
+        if (encoder) opus_encoder_destroy(encoder);
+    }
+
+    void encodeFrame(const float* frame) {
+        const opus_int32 bytes = opus_encode_float(encoder, frame, static_cast<int>(frameSamples),
+                                                   packet.data(), static_cast<opus_int32>(packet.size()));
+        if (bytes < 0) {
+            throw std::runtime_error(std::string("Opus encoding failed: ") + opus_strerror(bytes));
+        }
+        output(packet.data(), static_cast<size_t>(bytes));
+    }
+
+    void push(const float* samples, size_t count) {
+        // Top up a partial frame, then encode whole frames straight from the input
+        if (!pending.empty()) {
+            const size_t take = std::min(count, frameSamples - pending.size());
+            pending.insert(pending.end(), samples, samples + take);
+            samples += take;
+            count -= take;
+            if (pending.size() < frameSamples) return;
+            encodeFrame(pending.data());
+            pending.clear();
+        }
+        for (; count >= frameSamples; samples += frameSamples, count -= frameSamples) {
+            encodeFrame(samples);
+        }
+        pending.assign(samples, samples + count);
+    }
+};
+
+OpusSink::OpusSink(EncodedChunkCallback output, int sampleRate, int bitrate, int frameMs) {
+    if (!output) {
+        throw std::invalid_argument("OpusSink needs an output callback");
+    }
+    impl_ = std::make_unique<Impl>(std::move(output), sampleRate, bitrate, frameMs);
+}
+
+OpusSink::~OpusSink() = default;
+
+void OpusSink::write(const float* samples, size_t count) {
+    const float* converted = impl_->rate.process(samples, count);
+    impl_->push(converted, count);
+}
+
+void OpusSink::finish() {
+    size_t count = 0;
+    const float* tail = impl_->rate.flush(count);
+    impl_->push(tail, count);
+    if (!impl_->pending.empty()) {
+        impl_->pending.resize(impl_->frameSamples, 0.0f);
+        impl_->encodeFrame(impl_->pending.data());
+        impl_->pending.clear();
+    }
+}
+
+bool OpusSink::available() {
+    return true;
+}
+
+#else
+
+struct OpusSink::Impl {};
+
+OpusSink::OpusSink(EncodedChunkCallback, int, int, int) {
+    throw std::runtime_error("Opus support is not compiled in (build with -DPOCKET_TTS_USE_OPUS=ON)");
+}
+
+OpusSink::~OpusSink() = default;
+
+void OpusSink::write(const float*, size_t) {}
+
+void OpusSink::finish() {}
+
+bool OpusSink::available() {
+    return false;
+}
+
+#endif
+
+} // namespace pocket_tts
@@ -1,4 +1,6 @@
 #include "pocket_tts/audio_utils.hpp"
+#include "mapped_file.hpp"
+#include "wav_format.hpp"
 
 #include <stdexcept>
 #include <cstring>
@@ -6,156 +8,304 @@
 #include <cmath>
 #include <fstream>
 #include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define POCKET_TTS_X86_DISPATCH 1
+#endif
+
+#ifndef POCKET_TTS_X86_DISPATCH
+#define POCKET_TTS_X86_DISPATCH 0
+#endif
 
 namespace pocket_tts {
 namespace {
 constexpr double kPi = 3.14159265358979323846;
+constexpr int LANCZOS_A = 8;  // Lanczos kernel half-width (lobes) — maximum quality
 }
 
-// ── WAV format structures ──────────────────────────────────────────────
-
-#pragma pack(push, 1)
-struct WavHeader {
-    char     riffId[4];       // "RIFF"
-    uint32_t fileSize;        // file size - 8
-    char     waveId[4];       // "WAVE"
-};
+// ── loadWav ────────────────────────────────────────────────────────────
+//
+// The file is memory-mapped and only the frames that reach the requested
+// output window are touched: they are decoded and downmixed to mono in a
+// single pass, then resampled and peak-normalized in place.
 
-struct WavChunkHeader {
-    char     id[4];
-    uint32_t size;
-};
+namespace {
 
-struct WavFmtChunk {
-    uint16_t audioFormat;     // 1 = PCM, 3 = IEEE float
-    uint16_t numChannels;
-    uint32_t sampleRate;
-    uint32_t byteRate;
-    uint16_t blockAlign;
-    uint16_t bitsPerSample;
+constexpr uint16_t WAVE_FORMAT_PCM = 1;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+struct WavLayout {
+    uint16_t format = 0;        // PCM or IEEE float, after resolving EXTENSIBLE
+    uint16_t channels = 0;
+    uint32_t sampleRate = 0;
+    uint16_t bitsPerSample = 0;
+    size_t frameBytes = 0;      // Packed bytes of one frame (all channels)
+    const uint8_t* data = nullptr;
+    size_t frames = 0;
 };
-#pragma pack(pop)
 
-static bool chunkIdEquals(const char id[4], const char* tag) {
-    return id[0] == tag[0] && id[1] == tag[1] && id[2] == tag[2] && id[3] == tag[3];
+template <typename T>
+T readLE(const uint8_t* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
 }
 
-// ── loadWav ────────────────────────────────────────────────────────────
-
-std::vector<float> AudioUtils::loadWav(const std::string& filepath, int targetSampleRate) {
-    std::ifstream file(filepath, std::ios::binary);
-    if (!file) {
-        throw std::runtime_error("Failed to open audio file: " + filepath);
+WavLayout parseWav(const uint8_t* bytes, size_t size, const std::string& filepath) {
+    if (size < sizeof(WavHeader)) {
+        throw std::runtime_error("Not a valid WAV file: " + filepath);
     }
-
-    // Read RIFF header
     WavHeader header;
-    file.read(reinterpret_cast<char*>(&header), sizeof(header));
-    if (!file || !chunkIdEquals(header.riffId, "RIFF") || !chunkIdEquals(header.waveId, "WAVE")) {
+    std::memcpy(&header, bytes, sizeof(header));
+    if (!chunkIdEquals(header.riffId, "RIFF") || !chunkIdEquals(header.waveId, "WAVE")) {
         throw std::runtime_error("Not a valid WAV file: " + filepath);
     }
 
-    // Scan chunks for fmt and data
-    WavFmtChunk fmt{};
+    WavLayout layout;
     bool fmtFound = false;
-    std::vector<float> monoSamples;
+    size_t pos = sizeof(WavHeader);
 
-    while (file) {
+    while (pos + sizeof(WavChunkHeader) <= size) {
         WavChunkHeader chunk;
-        file.read(reinterpret_cast<char*>(&chunk), sizeof(chunk));
-        if (!file) break;
-
-        auto chunkStart = file.tellg();
+        std::memcpy(&chunk, bytes + pos, sizeof(chunk));
+        pos += sizeof(chunk);
+        const size_t available = size - pos;
 
         if (chunkIdEquals(chunk.id, "fmt ")) {
-            if (chunk.size < sizeof(WavFmtChunk)) {
+            if (chunk.size < sizeof(WavFmtChunk) || available < sizeof(WavFmtChunk)) {
                 throw std::runtime_error("Invalid fmt chunk in: " + filepath);
             }
-            file.read(reinterpret_cast<char*>(&fmt), sizeof(WavFmtChunk));
-            if (!file) throw std::runtime_error("Truncated fmt chunk in: " + filepath);
+            WavFmtChunk fmt;
+            std::memcpy(&fmt, bytes + pos, sizeof(fmt));
+            layout.format = fmt.audioFormat;
+            layout.channels = fmt.numChannels;
+            layout.sampleRate = fmt.sampleRate;
+            layout.bitsPerSample = fmt.bitsPerSample;
+
+            // Extensible: cbSize, validBits, channelMask, then the sub-format GUID
+            // whose first two bytes are the actual format tag
+            if (layout.format == WAVE_FORMAT_EXTENSIBLE) {
+                constexpr size_t EXTENSIBLE_SIZE = sizeof(WavFmtChunk) + 2 + 2 + 4 + 16;
+                if (chunk.size < EXTENSIBLE_SIZE || available < EXTENSIBLE_SIZE) {
+                    throw std::runtime_error("Invalid WAVE_FORMAT_EXTENSIBLE fmt chunk in: " + filepath);
+                }
+                layout.format = readLE<uint16_t>(bytes + pos + sizeof(WavFmtChunk) + 8);
+            }
 
-            if (fmt.audioFormat != 1 && fmt.audioFormat != 3) {
+            if (layout.format != WAVE_FORMAT_PCM && layout.format != WAVE_FORMAT_IEEE_FLOAT) {
                 throw std::runtime_error("Unsupported WAV format (only PCM/float supported): " + filepath);
             }
-            if (fmt.numChannels < 1 || fmt.numChannels > 2) {
-                throw std::runtime_error("Unsupported channel count (only mono/stereo): " + filepath);
+            if (layout.channels < 1) {
+                throw std::runtime_error("Invalid channel count in: " + filepath);
+            }
+            if (layout.sampleRate == 0) {
+                throw std::runtime_error("Invalid sample rate in: " + filepath);
+            }
+            const bool supported = layout.format == WAVE_FORMAT_PCM
+                ? (layout.bitsPerSample == 8 || layout.bitsPerSample == 16 ||
+                   layout.bitsPerSample == 24 || layout.bitsPerSample == 32)
+                : (layout.bitsPerSample == 32 || layout.bitsPerSample == 64);
+            if (!supported) {
+                throw std::runtime_error(
+                    "Unsupported bit depth " + std::to_string(layout.bitsPerSample) +
+                    " for format " + std::to_string(layout.format) + " in: " + filepath);
             }
+            // Some writers leave blockAlign at zero; the packed frame size is what
+            // the data uses. size_t: 65535 channels of 64-bit samples overflow uint16_t
+            layout.frameBytes = static_cast<size_t>(layout.channels) * (layout.bitsPerSample / 8);
             fmtFound = true;
 
         } else if (chunkIdEquals(chunk.id, "data")) {
             if (!fmtFound) {
                 throw std::runtime_error("data chunk before fmt chunk in: " + filepath);
             }
+            // Truncated files (or a 0xFFFFFFFF streaming size) keep what is present
+            const size_t dataSize = std::min<size_t>(chunk.size, available);
+            layout.data = bytes + pos;
+            layout.frames = dataSize / layout.frameBytes;
+            if (layout.frames == 0) break;
+            return layout;
+        }
 
-            const size_t bytesPerSample = fmt.bitsPerSample / 8;
-            const size_t totalSamples = chunk.size / bytesPerSample;
-
-            if (fmt.audioFormat == 3 && fmt.bitsPerSample == 32) {
-                // IEEE float32
-                std::vector<float> raw(totalSamples);
-                file.read(reinterpret_cast<char*>(raw.data()), chunk.size);
-                if (fmt.numChannels == 1) {
-                    monoSamples = std::move(raw);
-                } else {
-                    monoSamples = stereoToMono(raw);
-                }
-            } else if (fmt.audioFormat == 1 && fmt.bitsPerSample == 16) {
-                // PCM int16
-                std::vector<int16_t> raw(totalSamples);
-                file.read(reinterpret_cast<char*>(raw.data()), chunk.size);
-                std::vector<float> floatSamples(totalSamples);
-                constexpr float scale = 1.0f / 32768.0f;
-                for (size_t i = 0; i < totalSamples; ++i) {
-                    floatSamples[i] = static_cast<float>(raw[i]) * scale;
-                }
-                if (fmt.numChannels == 1) {
-                    monoSamples = std::move(floatSamples);
-                } else {
-                    monoSamples = stereoToMono(floatSamples);
-                }
-            } else if (fmt.audioFormat == 1 && fmt.bitsPerSample == 24) {
-                // PCM int24 (packed 3 bytes)
-                std::vector<uint8_t> raw(chunk.size);
-                file.read(reinterpret_cast<char*>(raw.data()), chunk.size);
-                std::vector<float> floatSamples(totalSamples);
-                constexpr float scale = 1.0f / 8388608.0f; // 2^23
-                for (size_t i = 0; i < totalSamples; ++i) {
-                    size_t offset = i * 3;
-                    int32_t val = raw[offset] | (raw[offset + 1] << 8) | (raw[offset + 2] << 16);
-                    if (val & 0x800000) val |= 0xFF000000; // sign extend
-                    floatSamples[i] = static_cast<float>(val) * scale;
-                }
-                if (fmt.numChannels == 1) {
-                    monoSamples = std::move(floatSamples);
-                } else {
-                    monoSamples = stereoToMono(floatSamples);
-                }
-            } else {
-                throw std::runtime_error(
-                    "Unsupported bit depth " + std::to_string(fmt.bitsPerSample) +
-                    " for format " + std::to_string(fmt.audioFormat) + " in: " + filepath);
+        // Skip to next chunk (chunks are word-aligned)
+        const size_t skip = static_cast<size_t>(chunk.size) + (chunk.size & 1);
+        if (skip > available) break;
+        pos += skip;
+    }
+
+    throw std::runtime_error("No audio data found in: " + filepath);
+}
+
+// Decode frames [0, frames) of interleaved samples into mono floats
+template <typename Sample>
+void decodeMono(const uint8_t* data, size_t frames, int channels, float* out) {
+    const size_t stride = static_cast<size_t>(channels) * Sample::BYTES;
+    if (channels == 1) {
+        for (size_t i = 0; i < frames; ++i) {
+            out[i] = Sample::read(data + i * Sample::BYTES);
+        }
+    } else if (channels == 2) {
+        for (size_t i = 0; i < frames; ++i) {
+            const uint8_t* frame = data + i * stride;
+            out[i] = (Sample::read(frame) + Sample::read(frame + Sample::BYTES)) * 0.5f;
+        }
+    } else {
+        const float scale = 1.0f / static_cast<float>(channels);
+        for (size_t i = 0; i < frames; ++i) {
+            const uint8_t* frame = data + i * stride;
+            float sum = 0.0f;
+            for (int c = 0; c < channels; ++c) {
+                sum += Sample::read(frame + static_cast<size_t>(c) * Sample::BYTES);
             }
-            break; // done, we have the data
+            out[i] = sum * scale;
         }
+    }
+}
 
-        // Skip to next chunk (chunks are word-aligned)
-        uint32_t skipSize = chunk.size + (chunk.size & 1);
-        file.seekg(static_cast<std::streamoff>(chunkStart) + skipSize);
+struct PcmU8 {
+    static constexpr size_t BYTES = 1;
+    static float read(const uint8_t* p) { return (static_cast<float>(*p) - 128.0f) * (1.0f / 128.0f); }
+};
+struct PcmS16 {
+    static constexpr size_t BYTES = 2;
+    static float read(const uint8_t* p) { return static_cast<float>(readLE<int16_t>(p)) * (1.0f / 32768.0f); }
+};
+struct PcmS24 {
+    static constexpr size_t BYTES = 3;
+    static float read(const uint8_t* p) {
+        // Shift into the top of an int32 so the sign extends
+        const int32_t val = static_cast<int32_t>((static_cast<uint32_t>(p[0]) << 8) |
+                                                 (static_cast<uint32_t>(p[1]) << 16) |
+                                                 (static_cast<uint32_t>(p[2]) << 24)) >> 8;
+        return static_cast<float>(val) * (1.0f / 8388608.0f); // 2^23
+    }
+};
+struct PcmS32 {
+    static constexpr size_t BYTES = 4;
+    static float read(const uint8_t* p) {
+        return static_cast<float>(static_cast<double>(readLE<int32_t>(p)) * (1.0 / 2147483648.0));
+    }
+};
+struct Float32 {
+    static constexpr size_t BYTES = 4;
+    static float read(const uint8_t* p) { return readLE<float>(p); }
+};
+struct Float64 {
+    static constexpr size_t BYTES = 8;
+    static float read(const uint8_t* p) { return static_cast<float>(readLE<double>(p)); }
+};
+
+void decodeMono(const WavLayout& layout, size_t frames, float* out) {
+    const int channels = layout.channels;
+    if (layout.format == WAVE_FORMAT_IEEE_FLOAT) {
+        if (layout.bitsPerSample == 32) decodeMono<Float32>(layout.data, frames, channels, out);
+        else decodeMono<Float64>(layout.data, frames, channels, out);
+        return;
+    }
+    switch (layout.bitsPerSample) {
+        case 8:  decodeMono<PcmU8>(layout.data, frames, channels, out); break;
+        case 16: decodeMono<PcmS16>(layout.data, frames, channels, out); break;
+        case 24: decodeMono<PcmS24>(layout.data, frames, channels, out); break;
+        default: decodeMono<PcmS32>(layout.data, frames, channels, out); break;
+    }
+}
+
+// Input frames needed for the first `outputs` samples at the target rate to
+// be the same as when the whole file is resampled: the last output's
+// position plus the filter half-width (widened when downsampling)
+size_t inputFramesFor(size_t outputs, int inputRate, int outputRate) {
+    if (inputRate == outputRate) {
+        return outputs;
     }
+    const double step = static_cast<double>(inputRate) / outputRate;
+    const double radius = LANCZOS_A * std::max(1.0, step);
+    const double last = static_cast<double>(outputs > 0 ? outputs - 1 : 0) * step;
+    return static_cast<size_t>(std::ceil(last + radius)) + 2;
+}
 
-    if (monoSamples.empty()) {
-        throw std::runtime_error("No audio data found in: " + filepath);
+// Same as AudioUtils::normalize without the copy
+void normalizeInPlace(float* audio, size_t count) {
+    constexpr float TARGET_PEAK = 0.85f;
+    float maxVal = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        maxVal = std::max(maxVal, std::abs(audio[i]));
     }
+    if (maxVal <= TARGET_PEAK) {
+        return;
+    }
+    const float gain = TARGET_PEAK / maxVal;
+    for (size_t i = 0; i < count; ++i) {
+        audio[i] *= gain;
+    }
+}
 
-    // Resample if needed
-    if (fmtFound && static_cast<int>(fmt.sampleRate) != targetSampleRate) {
-        monoSamples = resample(monoSamples, static_cast<int>(fmt.sampleRate), targetSampleRate);
+// Decode, resample and normalize the first `capacity` target-rate samples
+size_t loadWindow(const WavLayout& layout, float* output, size_t capacity, int targetSampleRate) {
+    const int inputRate = static_cast<int>(layout.sampleRate);
+
+    size_t count = 0;
+    if (inputRate == targetSampleRate) {
+        count = std::min(layout.frames, capacity);
+        decodeMono(layout, count, output);
+    } else {
+        const size_t frames = std::min(layout.frames, inputFramesFor(capacity, inputRate, targetSampleRate));
+        std::vector<float> mono(frames);
+        decodeMono(layout, frames, mono.data());
+
+        // The window is sized so the kept outputs never reach its artificial end
+        std::vector<float> resampled = AudioUtils::resample(mono, inputRate, targetSampleRate);
+        count = std::min(resampled.size(), capacity);
+        std::memcpy(output, resampled.data(), count * sizeof(float));
     }
 
-    // Normalize
-    monoSamples = normalize(monoSamples);
+    normalizeInPlace(output, count);
+    return count;
+}
+
+} // namespace
+
+size_t AudioUtils::loadWavInto(const std::string& filepath, float* output, size_t capacity,
+                               int targetSampleRate) {
+    if (!output || capacity == 0) {
+        throw std::invalid_argument("loadWavInto needs a non-empty output buffer");
+    }
+    if (targetSampleRate <= 0) {
+        throw std::invalid_argument("Sample rates must be positive");
+    }
 
-    return monoSamples;
+    MappedFile file(filepath);
+    const WavLayout layout = parseWav(file.data(), file.size(), filepath);
+    return loadWindow(layout, output, capacity, targetSampleRate);
+}
+
+std::vector<float> AudioUtils::loadWav(const std::string& filepath, int targetSampleRate, size_t maxSamples) {
+    if (targetSampleRate <= 0) {
+        throw std::invalid_argument("Sample rates must be positive");
+    }
+
+    MappedFile file(filepath);
+    const WavLayout layout = parseWav(file.data(), file.size(), filepath);
+
+    // Size from the header so a short file doesn't allocate maxSamples
+    size_t capacity = static_cast<size_t>(std::ceil(static_cast<double>(layout.frames) * targetSampleRate /
+                                                    layout.sampleRate)) + 1;
+    if (maxSamples > 0) {
+        capacity = std::min(capacity, maxSamples);
+    }
+
+    std::vector<float> samples(capacity);
+    samples.resize(loadWindow(layout, samples.data(), samples.size(), targetSampleRate));
+    return samples;
 }
 
 // ── saveWav ────────────────────────────────────────────────────────────
@@ -168,67 +318,188 @@ void AudioUtils::saveWav(const std::string& filepath, const std::vector<float>&
 
     const uint32_t numSamples = static_cast<uint32_t>(audioData.size());
     const uint32_t dataSize = numSamples * sizeof(float);
-    const uint32_t fmtChunkSize = 16;
 
-    // RIFF header
-    WavHeader header;
-    std::memcpy(header.riffId, "RIFF", 4);
-    header.fileSize = 4 + (8 + fmtChunkSize) + (8 + dataSize);
-    std::memcpy(header.waveId, "WAVE", 4);
+    const WavFileHeader header = makeWavHeader(3, 32, static_cast<uint32_t>(sampleRate), dataSize); // IEEE float
     file.write(reinterpret_cast<const char*>(&header), sizeof(header));
-
-    // fmt chunk
-    WavChunkHeader fmtHeader;
-    std::memcpy(fmtHeader.id, "fmt ", 4);
-    fmtHeader.size = fmtChunkSize;
-    file.write(reinterpret_cast<const char*>(&fmtHeader), sizeof(fmtHeader));
-
-    WavFmtChunk fmt{};
-    fmt.audioFormat = 3; // IEEE float
-    fmt.numChannels = 1;
-    fmt.sampleRate = static_cast<uint32_t>(sampleRate);
-    fmt.bitsPerSample = 32;
-    fmt.blockAlign = fmt.numChannels * (fmt.bitsPerSample / 8);
-    fmt.byteRate = fmt.sampleRate * fmt.blockAlign;
-    file.write(reinterpret_cast<const char*>(&fmt), sizeof(fmt));
-
-    // data chunk
-    WavChunkHeader dataHeader;
-    std::memcpy(dataHeader.id, "data", 4);
-    dataHeader.size = dataSize;
-    file.write(reinterpret_cast<const char*>(&dataHeader), sizeof(dataHeader));
     file.write(reinterpret_cast<const char*>(audioData.data()), dataSize);
 }
 
-// ── resample (windowed sinc / Lanczos-8) ───────────────────────────────
+// ── resample (polyphase windowed sinc / Lanczos-8) ─────────────────────
+//
+// out/in is reduced to L/M. Output i sits at input position i*M/L, so its
+// filter depends only on the phase (i*M) mod L: the L tap sets are built
+// once per rate pair and cached, and each output sample is one dot product.
+// Taps match the original per-sample Lanczos-8 kernel, normalized to unit
+// gain; near the signal edges the taps that exist are renormalized.
 
-std::vector<float> AudioUtils::resample(const std::vector<float>& input,
-                                        int inputSampleRate,
-                                        int outputSampleRate) {
-    if (inputSampleRate == outputSampleRate || input.empty()) {
-        return input;
+namespace {
+
+constexpr int64_t MAX_PHASES = 4096;  // Larger L (odd rate pairs) uses the direct kernel
+constexpr size_t TAP_ALIGN = 8;       // Tap count padded for 8-wide SIMD
+
+struct PolyphaseFilter {
+    int64_t L = 1;                 // Output step of the rational ratio
+    int64_t M = 1;                 // Input step
+    size_t taps = 0;               // Per phase, zero padded to TAP_ALIGN
+    std::vector<int64_t> offset;   // First tap relative to the center sample, per phase
+    std::vector<float> weights;    // L * taps
+};
+
+double lanczosKernel(double x, int a) {
+    if (x == 0.0) return 1.0;
+    if (x < -a || x > a) return 0.0;
+    const double pi_x = kPi * x;
+    const double pi_x_over_a = kPi * x / a;
+    return (std::sin(pi_x) / pi_x) * (std::sin(pi_x_over_a) / pi_x_over_a);
+}
+
+std::shared_ptr<const PolyphaseFilter> buildFilter(int64_t L, int64_t M) {
+    auto filter = std::make_shared<PolyphaseFilter>();
+    filter->L = L;
+    filter->M = M;
+
+    // When downsampling, widen the sinc kernel to act as a low-pass filter
+    const double ratio = static_cast<double>(L) / static_cast<double>(M);
+    const double filterScale = (ratio < 1.0) ? ratio : 1.0;
+    const double windowRadius = LANCZOS_A / filterScale;
+
+    std::vector<int64_t> jMin(static_cast<size_t>(L)), jMax(static_cast<size_t>(L));
+    size_t maxTaps = 0;
+    for (int64_t p = 0; p < L; ++p) {
+        const double frac = static_cast<double>(p) / static_cast<double>(L);
+        jMin[p] = static_cast<int64_t>(std::ceil(-windowRadius + frac));
+        jMax[p] = static_cast<int64_t>(std::floor(windowRadius + frac));
+        maxTaps = std::max(maxTaps, static_cast<size_t>(jMax[p] - jMin[p] + 1));
+    }
+    filter->taps = (maxTaps + TAP_ALIGN - 1) / TAP_ALIGN * TAP_ALIGN;
+    filter->offset = jMin;
+    filter->weights.assign(static_cast<size_t>(L) * filter->taps, 0.0f);
+
+    for (int64_t p = 0; p < L; ++p) {
+        const double frac = static_cast<double>(p) / static_cast<double>(L);
+        std::vector<double> w;
+        double sum = 0.0;
+        for (int64_t j = jMin[p]; j <= jMax[p]; ++j) {
+            w.push_back(lanczosKernel((static_cast<double>(j) - frac) * filterScale, LANCZOS_A));
+            sum += w.back();
+        }
+        float* dst = &filter->weights[static_cast<size_t>(p) * filter->taps];
+        for (size_t k = 0; k < w.size(); ++k) {
+            dst[k] = static_cast<float>(sum != 0.0 ? w[k] / sum : 0.0);
+        }
+    }
+    return filter;
+}
+
+// Filter bank for a rate pair, or null when the reduced ratio has too many
+// phases to be worth tabulating
+std::shared_ptr<const PolyphaseFilter> polyphaseFilter(int inputRate, int outputRate) {
+    const int64_t g = std::gcd(static_cast<int64_t>(inputRate), static_cast<int64_t>(outputRate));
+    const int64_t L = outputRate / g;
+    const int64_t M = inputRate / g;
+    if (L > MAX_PHASES) {
+        return nullptr;
     }
 
-    constexpr int LANCZOS_A = 8;  // Lanczos kernel half-width (lobes) — maximum quality
+    static std::mutex mutex;
+    static std::map<std::pair<int64_t, int64_t>, std::shared_ptr<const PolyphaseFilter>> cache;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& entry = cache[{L, M}];
+    if (!entry) {
+        entry = buildFilter(L, M);
+    }
+    return entry;
+}
+
+float dotScalar(const float* a, const float* b, size_t n) {
+    float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (size_t k = 0; k < n; k += 4) {
+        acc[0] += a[k] * b[k];
+        acc[1] += a[k + 1] * b[k + 1];
+        acc[2] += a[k + 2] * b[k + 2];
+        acc[3] += a[k + 3] * b[k + 3];
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
 
+#if defined(__ARM_NEON)
+float dotNeon(const float* a, const float* b, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    for (size_t k = 0; k < n; k += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + k), vld1q_f32(b + k));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + k + 4), vld1q_f32(b + k + 4));
+    }
+    float32x4_t acc = vaddq_f32(acc0, acc1);
+    float32x2_t half = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    return vget_lane_f32(vpadd_f32(half, half), 0);
+}
+#endif
+
+#if POCKET_TTS_X86_DISPATCH
+__attribute__((target("avx2,fma")))
+float dotAvx2(const float* a, const float* b, size_t n) {
+    __m256 acc = _mm256_setzero_ps();
+    for (size_t k = 0; k < n; k += 8) {
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(a + k), _mm256_loadu_ps(b + k), acc);
+    }
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+}
+#endif
+
+// Dot product of n taps; n is a multiple of TAP_ALIGN
+using DotFn = float (*)(const float*, const float*, size_t);
+
+DotFn selectDot() {
+#if defined(__ARM_NEON)
+    return dotNeon;
+#elif POCKET_TTS_X86_DISPATCH
+    static const DotFn fn = (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        ? dotAvx2 : dotScalar;
+    return fn;
+#else
+    return dotScalar;
+#endif
+}
+
+// Output sample i. x holds input samples [begin, end) of a signal whose
+// valid range is [0, length); taps outside it are dropped and the rest
+// renormalized.
+float polyphaseSample(const PolyphaseFilter& f, DotFn dot,
+                      const float* x, int64_t begin, int64_t end, int64_t length, int64_t i) {
+    const int64_t pos = i * f.M;
+    const int64_t phase = pos % f.L;
+    const int64_t first = pos / f.L + f.offset[static_cast<size_t>(phase)];
+    const float* w = &f.weights[static_cast<size_t>(phase) * f.taps];
+    const int64_t taps = static_cast<int64_t>(f.taps);
+
+    if (first >= 0 && first + taps <= std::min(end, length)) {
+        return dot(w, x + (first - begin), f.taps);
+    }
+
+    float sample = 0.0f;
+    float weightSum = 0.0f;
+    const int64_t lo = std::max<int64_t>(first, 0);
+    const int64_t hi = std::min(first + taps, length);
+    for (int64_t idx = lo; idx < hi; ++idx) {
+        sample += w[idx - first] * x[idx - begin];
+        weightSum += w[idx - first];
+    }
+    return weightSum > 0.0f ? sample / weightSum : 0.0f;
+}
+
+// Per-sample Lanczos-8 for ratios with too many phases to tabulate
+std::vector<float> resampleDirect(const std::vector<float>& input, int inputSampleRate, int outputSampleRate) {
     const double ratio = static_cast<double>(outputSampleRate) / inputSampleRate;
     const size_t outputSize = static_cast<size_t>(std::ceil(input.size() * ratio));
     std::vector<float> output(outputSize);
 
     const double step = static_cast<double>(inputSampleRate) / outputSampleRate;
-
-    // When downsampling, widen the sinc kernel to act as a low-pass filter
     const double filterScale = (ratio < 1.0) ? ratio : 1.0;
     const double windowRadius = LANCZOS_A / filterScale;
-
-    const auto lanczosKernel = [](double x, int a) -> double {
-        if (x == 0.0) return 1.0;
-        if (x < -a || x > a) return 0.0;
-        const double pi_x = kPi * x;
-        const double pi_x_over_a = kPi * x / a;
-        return (std::sin(pi_x) / pi_x) * (std::sin(pi_x_over_a) / pi_x_over_a);
-    };
-
     const int inputLen = static_cast<int>(input.size());
 
     for (size_t i = 0; i < outputSize; ++i) {
@@ -258,6 +529,140 @@ std::vector<float> AudioUtils::resample(const std::vector<float>& input,
     return output;
 }
 
+// Output samples handled per thread before resample() splits the work
+constexpr size_t PARALLEL_MIN_OUTPUTS = 1 << 17;
+
+} // namespace
+
+std::vector<float> AudioUtils::resample(const std::vector<float>& input,
+                                        int inputSampleRate,
+                                        int outputSampleRate,
+                                        int numThreads) {
+    if (inputSampleRate == outputSampleRate || input.empty()) {
+        return input;
+    }
+    if (inputSampleRate <= 0 || outputSampleRate <= 0) {
+        throw std::invalid_argument("Sample rates must be positive");
+    }
+
+    auto filter = polyphaseFilter(inputSampleRate, outputSampleRate);
+    if (!filter) {
+        return resampleDirect(input, inputSampleRate, outputSampleRate);
+    }
+
+    const int64_t length = static_cast<int64_t>(input.size());
+    const int64_t outputSize = (length * filter->L + filter->M - 1) / filter->M;
+    std::vector<float> output(static_cast<size_t>(outputSize));
+    const DotFn dot = selectDot();
+
+    auto run = [&](int64_t from, int64_t to) {
+        for (int64_t i = from; i < to; ++i) {
+            output[static_cast<size_t>(i)] = polyphaseSample(*filter, dot, input.data(), 0, length, length, i);
+        }
+    };
+
+    // Outputs are independent, so long inputs split into contiguous ranges
+    int threads = numThreads > 0 ? numThreads : static_cast<int>(std::thread::hardware_concurrency());
+    threads = static_cast<int>(std::min<int64_t>(std::max(1, threads),
+                                                 std::max<int64_t>(1, outputSize / PARALLEL_MIN_OUTPUTS)));
+    if (threads <= 1) {
+        run(0, outputSize);
+        return output;
+    }
+
+    std::vector<std::thread> workers;
+    const int64_t per = (outputSize + threads - 1) / threads;
+    for (int t = 1; t < threads; ++t) {
+        const int64_t from = std::min(outputSize, t * per);
+        const int64_t to = std::min(outputSize, from + per);
+        workers.emplace_back(run, from, to);
+    }
+    run(0, std::min(outputSize, per));
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return output;
+}
+
+// ── StreamingResampler ─────────────────────────────────────────────────
+
+struct StreamingResampler::Impl {
+    std::shared_ptr<const PolyphaseFilter> filter;
+    DotFn dot = selectDot();
+    std::vector<float> buffer;   // Input samples [bufferStart, received)
+    int64_t bufferStart = 0;
+    int64_t received = 0;
+    int64_t nextOutput = 0;
+
+    // First input index output i reads (may be negative at the start)
+    int64_t firstTap(int64_t i) const {
+        const int64_t pos = i * filter->M;
+        return pos / filter->L + filter->offset[static_cast<size_t>(pos % filter->L)];
+    }
+
+    // Emit every output whose taps are available; with `final` the input
+    // ends at `received` and the remaining outputs are renormalized
+    void drain(std::vector<float>& out, bool final) {
+        const int64_t taps = static_cast<int64_t>(filter->taps);
+        const int64_t length = final ? received : std::numeric_limits<int64_t>::max();
+        const int64_t lastOutput = final ? (received * filter->L + filter->M - 1) / filter->M
+                                         : std::numeric_limits<int64_t>::max();
+        while (nextOutput < lastOutput && (final || firstTap(nextOutput) + taps <= received)) {
+            out.push_back(polyphaseSample(*filter, dot, buffer.data(), bufferStart, received, length, nextOutput));
+            ++nextOutput;
+        }
+
+        // Drop input no later output can reach, once enough has built up
+        const int64_t keepFrom = std::max<int64_t>(bufferStart, firstTap(nextOutput));
+        const int64_t drop = keepFrom - bufferStart;
+        if (drop > 0 && static_cast<size_t>(drop) >= buffer.size() / 2) {
+            buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(drop));
+            bufferStart = keepFrom;
+        }
+    }
+};
+
+StreamingResampler::StreamingResampler(int inputSampleRate, int outputSampleRate)
+    : impl_(std::make_unique<Impl>()), inputRate_(inputSampleRate), outputRate_(outputSampleRate) {
+    if (inputSampleRate <= 0 || outputSampleRate <= 0) {
+        throw std::invalid_argument("Sample rates must be positive");
+    }
+    impl_->filter = polyphaseFilter(inputSampleRate, outputSampleRate);
+    if (!impl_->filter) {
+        throw std::invalid_argument("Unsupported rate pair for streaming resampling: " +
+                                    std::to_string(inputSampleRate) + " -> " +
+                                    std::to_string(outputSampleRate));
+    }
+}
+
+StreamingResampler::~StreamingResampler() = default;
+StreamingResampler::StreamingResampler(StreamingResampler&&) noexcept = default;
+StreamingResampler& StreamingResampler::operator=(StreamingResampler&&) noexcept = default;
+
+void StreamingResampler::process(const float* input, size_t count, std::vector<float>& output) {
+    if (inputRate_ == outputRate_) {
+        output.insert(output.end(), input, input + count);
+        return;
+    }
+    impl_->buffer.insert(impl_->buffer.end(), input, input + count);
+    impl_->received += static_cast<int64_t>(count);
+    impl_->drain(output, false);
+}
+
+void StreamingResampler::flush(std::vector<float>& output) {
+    if (inputRate_ != outputRate_) {
+        impl_->drain(output, true);
+    }
+    reset();
+}
+
+void StreamingResampler::reset() {
+    impl_->buffer.clear();
+    impl_->bufferStart = 0;
+    impl_->received = 0;
+    impl_->nextOutput = 0;
+}
+
 // ── stereoToMono ───────────────────────────────────────────────────────
 
 std::vector<float> AudioUtils::stereoToMono(const std::vector<float>& stereoData) {
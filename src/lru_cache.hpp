@@ -0,0 +1,102 @@
+#pragma once
+
+#include "pocket_tts/pocket_tts.hpp"
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace pocket_tts {
+
+/**
+ * @brief Thread-safe LRU map from strings to shared immutable values
+ *
+ * Entries are charged their reported size plus the key length against a
+ * byte budget; the least recently used ones are evicted past it. Values
+ * are handed out as shared_ptr, so an entry evicted while in use stays
+ * alive until its last reader is done. A budget of 0 disables the cache.
+ */
+template<typename Value>
+class LruCache {
+public:
+    explicit LruCache(size_t budgetBytes) : budget_(budgetBytes) {}
+
+    LruCache(const LruCache&) = delete;
+    LruCache& operator=(const LruCache&) = delete;
+
+    bool enabled() const { return budget_ > 0; }
+
+    /// The value for key, or null; counts a hit or a miss
+    std::shared_ptr<const Value> find(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            ++counters_.misses;
+            return nullptr;
+        }
+        ++counters_.hits;
+        order_.splice(order_.begin(), order_, it->second.lru);
+        return it->second.value;
+    }
+
+    /// Insert or replace key; values larger than the whole budget are dropped
+    void insert(const std::string& key, std::shared_ptr<const Value> value, size_t valueBytes) {
+        const size_t bytes = valueBytes + key.size();
+        if (bytes > budget_) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            used_ -= it->second.bytes;
+            order_.erase(it->second.lru);
+            entries_.erase(it);
+        }
+        order_.push_front(key);
+        entries_.emplace(key, Entry{std::move(value), bytes, order_.begin()});
+        used_ += bytes;
+
+        while (used_ > budget_) {
+            auto victim = entries_.find(order_.back());
+            used_ -= victim->second.bytes;
+            entries_.erase(victim);
+            order_.pop_back();
+        }
+    }
+
+    CacheCounters counters() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        CacheCounters counters = counters_;
+        counters.entries = entries_.size();
+        counters.bytes = used_;
+        return counters;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        order_.clear();
+        used_ = 0;
+    }
+
+private:
+    struct Entry {
+        std::shared_ptr<const Value> value;
+        size_t bytes;
+        std::list<std::string>::iterator lru;
+    };
+
+    const size_t budget_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> order_;  // Most recently used first
+    size_t used_ = 0;
+    CacheCounters counters_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace pocket_tts
@@ -1,5 +1,6 @@
 #include "pocket_tts/pocket_tts.hpp"
 #include "pocket_tts/audio_utils.hpp"
+#include "pocket_tts/voice_store.hpp"
 
 #include <iostream>
 #include <string>
@@ -11,15 +12,33 @@ void printUsage(const char* progName) {
     std::cout << "Usage: " << progName << " [options] <text> <voice_file> <output_file>\n\n";
     std::cout << "Arguments:\n";
     std::cout << "  text         Text to synthesize\n";
-    std::cout << "  voice_file   Reference voice audio file (WAV)\n";
+    std::cout << "  voice_file   Reference voice audio file (WAV) or saved voice (.ptv)\n";
     std::cout << "  output_file  Output audio file (WAV)\n\n";
     std::cout << "Options:\n";
     std::cout << "  --models-dir <path>   Path to models directory (default: models/onnx)\n";
     std::cout << "  --tokenizer <path>    Path to tokenizer.model (default: models/tokenizer.model)\n";
-    std::cout << "  --precision <p>       Model precision: int8 or fp32 (default: int8)\n";
+    std::cout << "  --precision <p>       Model precision: int8, fp16 or fp32 (default: int8)\n";
     std::cout << "  --temperature <t>     Sampling temperature (default: 0.7)\n";
+    std::cout << "  --seed <n>            Fixed noise seed for reproducible output (default: random)\n";
     std::cout << "  --lsd-steps <n>       Flow matching steps (default: 10)\n";
     std::cout << "  --max-frames <n>      Maximum frames to generate (default: 500)\n";
+    std::cout << "  --context-window <n>  Re-prime the LM context every n frames (default: 0 = unbounded)\n";
+    std::cout << "  --fused-flow          Use the unrolled flow graph (flow_lm_flow_fused.onnx)\n";
+    std::cout << "  --solver <s>          Flow solver: euler or heun (default: euler)\n";
+    std::cout << "  --schedule <s>        Flow time grid: uniform, cosine, quadratic (default: uniform)\n";
+    std::cout << "  --post-eos-steps <n>  Flow steps for frames after EOS (default: --lsd-steps)\n";
+    std::cout << "  --threads <n>         Intra-op threads per model (default: 3, 0 = auto)\n";
+    std::cout << "  --inter-op-threads <n> Inter-op threads; > 1 enables parallel execution (default: 1)\n";
+    std::cout << "  --model-threads <m>=<n> Thread override for one model: text, main, flow, decoder, encoder\n";
+    std::cout << "  --no-spin             Don't busy-wait between ops (saves CPU, adds latency)\n";
+    std::cout << "  --affinity <spec>     Intra-op thread affinity, e.g. \"1;2\" or \"1-2;3-4\"\n";
+    std::cout << "  --ep <provider>       Execution provider: cpu, cuda, coreml, dml, xnnpack (default: cpu)\n";
+    std::cout << "  --device-id <n>       GPU index for cuda / dml (default: 0)\n";
+    std::cout << "  --model-cache <dir>   Cache optimized graphs in dir for faster later starts\n";
+    std::cout << "  --lazy-load           Create the encoder and text conditioner on first use\n";
+    std::cout << "  --save-voice <path>   Also save the encoded voice to a .ptv file\n";
+    std::cout << "  --long-form           Split text into sentences and synthesize them in parallel\n";
+    std::cout << "  --segment-threads <n> Parallel segments for --long-form (default: auto)\n";
     std::cout << "  -h, --help            Show this help message\n\n";
     std::cout << "Example:\n";
     std::cout << "  " << progName << " \"Hello, world!\" models/reference_sample.wav output.wav\n";
@@ -31,6 +50,9 @@ int main(int argc, char* argv[]) {
     std::string text;
     std::string voiceFile;
     std::string outputFile;
+    std::string saveVoicePath;
+    bool longForm = false;
+    pocket_tts::LongFormConfig longFormConfig;
     
     // Parse arguments
     int positionalCount = 0;
@@ -48,10 +70,62 @@ int main(int argc, char* argv[]) {
             config.precision = argv[++i];
         } else if (arg == "--temperature" && i + 1 < argc) {
             config.temperature = std::stof(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            config.seed = std::stoll(argv[++i]);
         } else if (arg == "--lsd-steps" && i + 1 < argc) {
             config.lsdSteps = std::stoi(argv[++i]);
         } else if (arg == "--max-frames" && i + 1 < argc) {
             config.maxFrames = std::stoi(argv[++i]);
+        } else if (arg == "--context-window" && i + 1 < argc) {
+            config.contextWindowFrames = std::stoi(argv[++i]);
+        } else if (arg == "--fused-flow") {
+            config.fusedFlow = true;
+        } else if (arg == "--solver" && i + 1 < argc) {
+            config.flow.solver = pocket_tts::parseFlowSolver(argv[++i]);
+        } else if (arg == "--schedule" && i + 1 < argc) {
+            config.flow.schedule = pocket_tts::parseFlowSchedule(argv[++i]);
+        } else if (arg == "--post-eos-steps" && i + 1 < argc) {
+            config.flow.postEosSteps = std::stoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            config.intraOpThreads = std::stoi(argv[++i]);
+        } else if (arg == "--inter-op-threads" && i + 1 < argc) {
+            config.interOpThreads = std::stoi(argv[++i]);
+        } else if (arg == "--model-threads" && i + 1 < argc) {
+            std::string spec = argv[++i];
+            size_t eq = spec.find('=');
+            if (eq == std::string::npos) {
+                std::cerr << "Invalid --model-threads value: " << spec << std::endl;
+                return 1;
+            }
+            std::string model = spec.substr(0, eq);
+            int threads = std::stoi(spec.substr(eq + 1));
+            if (model == "text") config.textConditionerThreads = threads;
+            else if (model == "main") config.flowLmMainThreads = threads;
+            else if (model == "flow") config.flowLmFlowThreads = threads;
+            else if (model == "decoder") config.mimiDecoderThreads = threads;
+            else if (model == "encoder") config.mimiEncoderThreads = threads;
+            else {
+                std::cerr << "Unknown model in --model-threads: " << model << std::endl;
+                return 1;
+            }
+        } else if (arg == "--no-spin") {
+            config.allowSpinning = false;
+        } else if (arg == "--affinity" && i + 1 < argc) {
+            config.threadAffinity = argv[++i];
+        } else if (arg == "--ep" && i + 1 < argc) {
+            config.executionProvider = argv[++i];
+        } else if (arg == "--device-id" && i + 1 < argc) {
+            config.deviceId = std::stoi(argv[++i]);
+        } else if (arg == "--model-cache" && i + 1 < argc) {
+            config.optimizedModelCacheDir = argv[++i];
+        } else if (arg == "--lazy-load") {
+            config.lazyLoad = true;
+        } else if (arg == "--save-voice" && i + 1 < argc) {
+            saveVoicePath = argv[++i];
+        } else if (arg == "--long-form") {
+            longForm = true;
+        } else if (arg == "--segment-threads" && i + 1 < argc) {
+            longFormConfig.numThreads = std::stoi(argv[++i]);
         } else if (arg[0] != '-') {
             // Positional argument
             switch (positionalCount) {
@@ -79,6 +153,14 @@ int main(int argc, char* argv[]) {
     std::cout << "Output: " << outputFile << std::endl;
     std::cout << std::endl;
     
+    // Saved voices need no encoder
+    const std::string voiceExt = pocket_tts::VOICE_FILE_EXTENSION;
+    bool savedVoice = voiceFile.size() > voiceExt.size() &&
+                      voiceFile.compare(voiceFile.size() - voiceExt.size(), voiceExt.size(), voiceExt) == 0;
+    if (savedVoice) {
+        config.loadVoiceEncoder = false;
+    }
+    
     try {
         // Initialize TTS engine
         std::cout << "Initializing..." << std::endl;
@@ -89,8 +171,23 @@ int main(int argc, char* argv[]) {
         std::cout << "Loaded in " << (loadTime / 1000.0f) << "s" << std::endl;
         std::cout << std::endl;
         
+        // Encode or load the voice
+        auto voice = savedVoice ? pocket_tts::loadVoice(voiceFile) : tts.encodeVoiceEmbedding(voiceFile);
+        if (!saveVoicePath.empty()) {
+            pocket_tts::saveVoice(saveVoicePath, voice);
+            std::cout << "Saved voice to: " << saveVoicePath << std::endl;
+        }
+        
         // Generate audio
-        auto audio = tts.generate(text, voiceFile);
+        std::vector<float> audio;
+        if (longForm) {
+            tts.generateLongForm(text, voice.embeddings, voice.shape,
+                [&audio](const float* samples, int count, bool) {
+                    audio.insert(audio.end(), samples, samples + count);
+                }, longFormConfig);
+        } else {
+            audio = tts.generateWithEmbeddings(text, voice.embeddings, voice.shape);
+        }
         
         // Save output
         pocket_tts::AudioUtils::saveWav(outputFile, audio);
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace pocket_tts {
+
+/**
+ * @brief Counter-based Gaussian noise (Philox4x32-10 + Box-Muller)
+ *
+ * Every value is a pure function of (seed, frame, index): there is no
+ * generator state to share, lock or advance, so any thread can produce
+ * any frame's noise and get the same result. Philox follows Salmon et
+ * al., "Parallel Random Numbers: As Easy as 1, 2, 3" (SC'11).
+ */
+class FrameNoise {
+public:
+    /// Four 32-bit words of block `block` in frame `frame`
+    static void philoxBlock(uint64_t seed, uint64_t frame, uint32_t block, uint32_t out[4]) {
+        uint32_t c0 = block, c1 = 0;
+        uint32_t c2 = static_cast<uint32_t>(frame), c3 = static_cast<uint32_t>(frame >> 32);
+        uint32_t k0 = static_cast<uint32_t>(seed), k1 = static_cast<uint32_t>(seed >> 32);
+        for (int round = 0; round < 10; ++round) {
+            const uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c0;
+            const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c2;
+            const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+            const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+            c1 = static_cast<uint32_t>(p1);
+            c3 = static_cast<uint32_t>(p0);
+            c0 = n0;
+            c2 = n2;
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+    }
+
+    /**
+     * @brief Fill out[0, count) with N(0, stddev^2) samples of one frame
+     *
+     * Uniforms are drawn first and transformed in a second, branch-free
+     * loop so the compiler can vectorize the log / sqrt / sin / cos.
+     */
+    static void fill(uint64_t seed, uint64_t frame, float stddev, float* out, size_t count) {
+        constexpr size_t MAX_CHUNK = 64;  // Values per pass (a frame is 32)
+        constexpr float TWO_PI = 6.28318530717958647692f;
+        constexpr float INV_2_32 = 1.0f / 4294967296.0f;
+
+        uint32_t block = 0;
+        while (count > 0) {
+            const size_t n = count < MAX_CHUNK ? count : MAX_CHUNK;
+            const size_t pairs = (n + 1) / 2;
+
+            float u1[MAX_CHUNK / 2];
+            float u2[MAX_CHUNK / 2];
+            for (size_t p = 0; p < pairs; p += 2, ++block) {
+                uint32_t words[4];
+                philoxBlock(seed, frame, block, words);
+                // u1 in (0, 1] so the log stays finite
+                u1[p] = (static_cast<float>(words[0] >> 8) + 1.0f) * (INV_2_32 * 256.0f);
+                u2[p] = static_cast<float>(words[1]) * INV_2_32;
+                if (p + 1 < pairs) {
+                    u1[p + 1] = (static_cast<float>(words[2] >> 8) + 1.0f) * (INV_2_32 * 256.0f);
+                    u2[p + 1] = static_cast<float>(words[3]) * INV_2_32;
+                }
+            }
+
+            float z0[MAX_CHUNK / 2];
+            float z1[MAX_CHUNK / 2];
+            for (size_t p = 0; p < pairs; ++p) {
+                const float r = stddev * std::sqrt(-2.0f * std::log(u1[p]));
+                const float theta = TWO_PI * u2[p];
+                z0[p] = r * std::cos(theta);
+                z1[p] = r * std::sin(theta);
+            }
+            for (size_t i = 0; i < n; ++i) {
+                out[i] = (i & 1) ? z1[i / 2] : z0[i / 2];
+            }
+
+            out += n;
+            count -= n;
+        }
+    }
+
+    /// Seed of sub-stream `index` (e.g. a long-form segment) of `seed` (SplitMix64)
+    static uint64_t deriveSeed(uint64_t seed, uint64_t index) {
+        uint64_t z = seed + 0x9E3779B97F4A7C15ull * (index + 1);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
+
+} // namespace pocket_tts
@@ -1,28 +1,314 @@
 #include "pocket_tts/pocket_tts.hpp"
 #include "pocket_tts/audio_utils.hpp"
+#include "pocket_tts/audio_sink.hpp"
 #include "pocket_tts/tokenizer.hpp"
+#include "pocket_tts/voice_store.hpp"
+#include "worker_pool.hpp"
+#include "spsc_queue.hpp"
+#include "mapped_file.hpp"
+#include "lru_cache.hpp"
+#include "request_queue.hpp"
+#include "noise.hpp"
+#include "process_memory.hpp"
 
 #include <onnxruntime_cxx_api.h>
+#ifdef POCKET_TTS_USE_DML
+#include <dml_provider_factory.h>
+#endif
 #include <stdexcept>
+#include <algorithm>
 #include <iostream>
 #include <cmath>
 #include <random>
 #include <chrono>
 #include <numeric>
 #include <atomic>
+#include <cstring>
+#include <cstdio>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include <future>
+#include <cctype>
+#include <filesystem>
+#include <limits>
+#include <tuple>
 
 namespace pocket_tts {
 namespace {
 #ifdef _WIN32
-std::unique_ptr<Ort::Session> createSession(Ort::Env& env, const std::string& modelPath, Ort::SessionOptions& options) {
-    std::wstring widePath(modelPath.begin(), modelPath.end());
-    return std::make_unique<Ort::Session>(env, widePath.c_str(), options);
+using OrtPath = std::wstring;
+OrtPath toOrtPath(const std::string& path) {
+    return std::wstring(path.begin(), path.end());
 }
 #else
-std::unique_ptr<Ort::Session> createSession(Ort::Env& env, const std::string& modelPath, Ort::SessionOptions& options) {
-    return std::make_unique<Ort::Session>(env, modelPath.c_str(), options);
+using OrtPath = std::string;
+OrtPath toOrtPath(const std::string& path) {
+    return path;
 }
 #endif
+
+// Create a session from a file path, or from its memory-mapped bytes. The
+// mapping only lives for the constructor: ORT builds its own graph from it.
+std::unique_ptr<Ort::Session> createSession(Ort::Env& env, const std::string& modelPath,
+                                            const Ort::SessionOptions& options,
+                                            OrtPrepackedWeightsContainer* prepacked,
+                                            bool mapFile) {
+    if (mapFile) {
+        MappedFile file(modelPath);
+        return std::make_unique<Ort::Session>(env, file.data(), file.size(), options, prepacked);
+    }
+    return std::make_unique<Ort::Session>(env, toOrtPath(modelPath).c_str(), options, prepacked);
+}
+
+// One container per process, so every model loaded with the same weights
+// prepacks them once; each model keeps a reference for its sessions' lifetime
+std::shared_ptr<Ort::PrepackedWeightsContainer> sharedPrepackedWeights() {
+    static std::mutex mutex;
+    static std::weak_ptr<Ort::PrepackedWeightsContainer> shared;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto container = shared.lock();
+    if (!container) {
+        container = std::make_shared<Ort::PrepackedWeightsContainer>();
+        shared = container;
+    }
+    return container;
+}
+
+// One Ort::Env per process. ORT keeps a single environment internally
+// anyway; sharing the wrapper lets models agree on what belongs to that
+// environment (global thread pools, the shared CPU arena). The first model
+// decides them while it is alive.
+std::shared_ptr<Ort::Env> sharedEnv(const PocketTTSConfig& config) {
+    static std::mutex mutex;
+    static std::weak_ptr<Ort::Env> shared;
+    static bool globalThreadPools = false;
+    static bool arenaRegistered = false;
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    auto env = shared.lock();
+    if (!env) {
+        if (config.globalThreadPools) {
+            Ort::ThreadingOptions threading;
+            threading.SetGlobalIntraOpNumThreads(std::max(0, config.intraOpThreads));
+            threading.SetGlobalInterOpNumThreads(std::max(1, config.interOpThreads));
+            threading.SetGlobalSpinControl(config.allowSpinning ? 1 : 0);
+            env = std::make_shared<Ort::Env>(threading, ORT_LOGGING_LEVEL_WARNING, "PocketTTS");
+        } else {
+            env = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "PocketTTS");
+        }
+        shared = env;
+        globalThreadPools = config.globalThreadPools;
+        arenaRegistered = false;
+    } else if (globalThreadPools != config.globalThreadPools) {
+        throw std::runtime_error("globalThreadPools must match the models already loaded in this process");
+    }
+    
+    if (config.sharedArena && config.cpuArena && !arenaRegistered) {
+        int strategy = 0;  // kNextPowerOfTwo
+        if (config.arenaExtendStrategy == "same_as_requested") {
+            strategy = 1;
+        } else if (config.arenaExtendStrategy != "next_power_of_two") {
+            throw std::invalid_argument("Unknown arena extend strategy: " + config.arenaExtendStrategy);
+        }
+        Ort::MemoryInfo cpu = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+        Ort::ArenaCfg arena(config.arenaMaxBytes, strategy, -1, -1);
+        env->CreateAndRegisterAllocator(cpu, arena);
+        arenaRegistered = true;
+    }
+    return env;
+}
+
+// Split text at `breaks` characters followed by whitespace; separators stay
+// with the piece they end
+std::vector<std::string> splitAfter(const std::string& text, const char* breaks) {
+    std::vector<std::string> pieces;
+    size_t begin = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        bool atBreak = std::strchr(breaks, text[i]) != nullptr &&
+                       (i + 1 == text.size() || std::isspace(static_cast<unsigned char>(text[i + 1])));
+        if (atBreak || text[i] == '\n') {
+            pieces.push_back(text.substr(begin, i + 1 - begin));
+            begin = i + 1;
+        }
+    }
+    if (begin < text.size()) {
+        pieces.push_back(text.substr(begin));
+    }
+    
+    // Trim and drop empty pieces
+    std::vector<std::string> trimmed;
+    for (auto& piece : pieces) {
+        size_t first = piece.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos) continue;
+        size_t last = piece.find_last_not_of(" \t\r\n");
+        trimmed.push_back(piece.substr(first, last - first + 1));
+    }
+    return trimmed;
+}
+
+// Split long-form text into segments of at most maxTokens tokens, preferring
+// sentence, then clause, then word boundaries. Short neighbours are merged.
+std::vector<std::string> splitText(
+    const std::string& text,
+    size_t maxTokens,
+    const std::function<size_t(const std::string&)>& countTokens
+) {
+    std::vector<std::string> pieces;
+    for (auto& sentence : splitAfter(text, ".!?")) {
+        if (countTokens(sentence) <= maxTokens) {
+            pieces.push_back(std::move(sentence));
+            continue;
+        }
+        for (auto& clause : splitAfter(sentence, ",;:")) {
+            if (countTokens(clause) <= maxTokens) {
+                pieces.push_back(std::move(clause));
+                continue;
+            }
+            // No usable punctuation: fall back to word boundaries
+            std::string current;
+            size_t pos = 0;
+            while (pos < clause.size()) {
+                size_t next = clause.find(' ', pos);
+                std::string word = clause.substr(pos, next == std::string::npos ? std::string::npos : next - pos);
+                pos = next == std::string::npos ? clause.size() : next + 1;
+                if (word.empty()) continue;
+                std::string candidate = current.empty() ? word : current + " " + word;
+                if (!current.empty() && countTokens(candidate) > maxTokens) {
+                    pieces.push_back(std::move(current));
+                    current = word;
+                } else {
+                    current = std::move(candidate);
+                }
+            }
+            if (!current.empty()) pieces.push_back(std::move(current));
+        }
+    }
+    
+    std::vector<std::string> segments;
+    for (auto& piece : pieces) {
+        if (!segments.empty() && countTokens(segments.back() + " " + piece) <= maxTokens) {
+            segments.back() += " " + piece;
+        } else {
+            segments.push_back(std::move(piece));
+        }
+    }
+    return segments;
+}
+}
+
+// Reports the lifetime of a scope to PocketTTSConfig::onStageTiming
+class StageTimer {
+public:
+    StageTimer(const StageTimingCallback& callback, Stage stage)
+        : callback_(callback), stage_(stage) {
+        if (callback_) start_ = std::chrono::steady_clock::now();
+    }
+    
+    ~StageTimer() {
+        if (callback_) {
+            callback_(stage_, std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start_).count());
+        }
+    }
+    
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    const StageTimingCallback& callback_;
+    Stage stage_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Counts one session run and its wall time into SessionStats (no-op when null)
+class RunTimer {
+public:
+    explicit RunTimer(SessionStats* stats) : stats_(stats) {
+        if (stats_) start_ = std::chrono::steady_clock::now();
+    }
+    
+    ~RunTimer() {
+        if (stats_) {
+            ++stats_->runs;
+            stats_->totalMs += std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start_).count();
+        }
+    }
+    
+    RunTimer(const RunTimer&) = delete;
+    RunTimer& operator=(const RunTimer&) = delete;
+
+private:
+    SessionStats* stats_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Sum the counters of one request into another (long-form segments)
+void accumulateStats(GenerationStats& total, const GenerationStats& part) {
+    auto add = [](SessionStats& a, const SessionStats& b) {
+        a.runs += b.runs;
+        a.totalMs += b.totalMs;
+    };
+    total.textTokens += part.textTokens;
+    total.framesGenerated += part.framesGenerated;
+    total.eosStep = part.eosStep;
+    total.audioSamples += part.audioSamples;
+    total.voicePrefixCached = total.voicePrefixCached || part.voicePrefixCached;
+    total.textCached = total.textCached || part.textCached;
+    add(total.textConditioner, part.textConditioner);
+    add(total.flowLmMain, part.flowLmMain);
+    add(total.flowLmFlow, part.flowLmFlow);
+    add(total.mimiDecoder, part.mimiDecoder);
+    total.stateBytesCopied += part.stateBytesCopied;
+    total.stateBytesAllocated += part.stateBytesAllocated;
+    total.lmStateBytes = std::max(total.lmStateBytes, part.lmStateBytes);
+    total.contextReprimes += part.contextReprimes;
+}
+
+const char* stageName(Stage stage) {
+    switch (stage) {
+        case Stage::Tokenize: return "tokenize";
+        case Stage::TextConditioner: return "text_conditioner";
+        case Stage::VoicePrefill: return "voice_prefill";
+        case Stage::TextPrefill: return "text_prefill";
+        case Stage::MainStep: return "main_step";
+        case Stage::Flow: return "flow";
+        case Stage::Decode: return "decode";
+    }
+    return "unknown";
+}
+
+const char* flowSolverName(FlowSolver solver) {
+    return solver == FlowSolver::Heun ? "heun" : "euler";
+}
+
+const char* flowScheduleName(FlowSchedule schedule) {
+    switch (schedule) {
+        case FlowSchedule::Uniform: return "uniform";
+        case FlowSchedule::Cosine: return "cosine";
+        case FlowSchedule::Quadratic: return "quadratic";
+    }
+    return "unknown";
+}
+
+FlowSolver parseFlowSolver(const std::string& name) {
+    for (FlowSolver solver : {FlowSolver::Euler, FlowSolver::Heun}) {
+        if (name == flowSolverName(solver)) return solver;
+    }
+    throw std::invalid_argument("Unknown flow solver: " + name);
+}
+
+FlowSchedule parseFlowSchedule(const std::string& name) {
+    for (FlowSchedule schedule : {FlowSchedule::Uniform, FlowSchedule::Cosine, FlowSchedule::Quadratic}) {
+        if (name == flowScheduleName(schedule)) return schedule;
+    }
+    throw std::invalid_argument("Unknown flow schedule: " + name);
 }
 
 // Helper to create tensor from vector
@@ -36,82 +322,559 @@ Ort::Value createTensor(Ort::MemoryInfo& memInfo,
     );
 }
 
-// State entry that can hold different types
+// Input-only tensor over caller data. ORT never writes to input buffers,
+// so this wraps the vector in place rather than copying it.
+template<typename T>
+Ort::Value createInputTensor(Ort::MemoryInfo& memInfo,
+                             const std::vector<T>& data,
+                             const std::vector<int64_t>& shape) {
+    return Ort::Value::CreateTensor<T>(
+        memInfo, const_cast<T*>(data.data()), data.size(),
+        shape.data(), shape.size()
+    );
+}
+
+// Receives decoded audio as it comes out of the decoder
+using SampleSink = std::function<void(const float*, size_t)>;
+
+// Token ids of one normalized text and its text_conditioner output
+struct TextConditioning {
+    std::vector<int64_t> tokenIds;
+    std::vector<float> embeddings;  // [1, tokens, 1024]
+};
+
+// (s, t) time pairs of one frame's flow integration, from noise at 0 to 1
+using FlowSteps = std::vector<std::pair<float, float>>;
+
+FlowSteps makeFlowSteps(FlowSchedule schedule, int steps) {
+    auto time = [&](int j) {
+        const float u = static_cast<float>(j) / static_cast<float>(steps);
+        switch (schedule) {
+            case FlowSchedule::Cosine: return 0.5f - 0.5f * std::cos(u * 3.14159265f);
+            case FlowSchedule::Quadratic: return u * u;
+            case FlowSchedule::Uniform: break;
+        }
+        return u;
+    };
+    FlowSteps grid;
+    grid.reserve(static_cast<size_t>(steps));
+    for (int j = 0; j < steps; ++j) {
+        grid.emplace_back(time(j), j + 1 == steps ? 1.0f : time(j + 1));
+    }
+    return grid;
+}
+
+// Size in bytes of one element of a state tensor
+size_t elementSize(ONNXTensorElementDataType dtype) {
+    switch (dtype) {
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64: return sizeof(int64_t);
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_BOOL: return sizeof(bool);
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16: return 2;
+        default: return sizeof(float);
+    }
+}
+
+// State tensor fed straight back into the next run. Fixed-shape states
+// ping-pong between two preallocated buffers bound as input and output;
+// growing states (KV caches) adopt the ORT-allocated output without a copy.
 struct StateEntry {
-    std::vector<float> floatData;
-    std::vector<int64_t> int64Data;
-    std::vector<uint8_t> boolData;  // Using uint8_t because vector<bool> has no .data()
-    std::vector<int64_t> shape;
-    ONNXTensorElementDataType dtype;
+    Ort::Value value{nullptr};
+    Ort::Value spare{nullptr};  // Output buffer for the next run (fixed shape only)
+    // Immutable snapshot tensor read in place of `value` until the first run
+    // writes a private copy (copy-on-write clone of a StateSnapshot)
+    std::shared_ptr<const Ort::Value> shared;
     
-    StateEntry() : dtype(ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {}
+    const Ort::Value& input() const { return shared ? *shared : value; }
 };
 
-struct PocketTTS::Impl {
+// Frozen session state shared by many requests, indexed like SessionState
+using StateSnapshot = std::vector<std::shared_ptr<const Ort::Value>>;
+
+// One state_N/out_state_N pair of a stateful session
+struct StateSlot {
+    std::string inputName;          // "state_N"
+    std::vector<int64_t> initShape; // Declared shape, dynamic dims set to 0
+    ONNXTensorElementDataType dtype = ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+    bool fixedShape = false;
+};
+
+// Bytes of one buffer at the slot's declared shape
+size_t stateBytes(const StateSlot& slot) {
+    size_t count = 1;
+    for (int64_t dim : slot.initShape) count *= static_cast<size_t>(dim);
+    return count * elementSize(slot.dtype);
+}
+
+// Output name table and state layout of a session, resolved once at load
+// time so the per-step path does no string parsing or name lookups.
+struct SessionSignature {
+    std::vector<std::string> outputNameStrs;
+    std::vector<const char*> outputNames;  // Session order
+    std::vector<int> outputSlots;          // State slot fed by each output, -1 for data outputs
+    std::vector<StateSlot> states;         // Ordered by state index N
+};
+
+// Per-request state of a session, indexed by SessionSignature slot
+using SessionState = std::vector<StateEntry>;
+
+// Bytes held by a state right now (growing slots at their current length)
+size_t stateBytes(const SessionState& state) {
+    size_t total = 0;
+    for (const auto& entry : state) {
+        const Ort::Value& value = entry.input();
+        if (!value) continue;
+        auto info = value.GetTensorTypeAndShapeInfo();
+        total += info.GetElementCount() * elementSize(info.GetElementType());
+    }
+    return total;
+}
+
+constexpr size_t LATENT_DIM = 32;
+constexpr size_t DECODE_GROUP_FRAMES = 15;  // Latent frames per mimi_decoder run
+
+// Long reference clips explode KV-cache memory in the autoregressive pass.
+// A short reference (few seconds) is enough for stable voice conditioning.
+constexpr size_t MAX_REFERENCE_SAMPLES = static_cast<size_t>(AudioUtils::TARGET_SAMPLE_RATE) * 5;
+
+// Latent frames stored back to back (frames * LATENT_DIM floats), so an
+// utterance or chunk is a single allocation the decoder reads in place
+struct LatentFrames {
+    std::vector<float> data;
+    
+    size_t size() const { return data.size() / LATENT_DIM; }
+    bool empty() const { return data.empty(); }
+    void reserve(size_t frames) { data.reserve(frames * LATENT_DIM); }
+    void push(const std::vector<float>& latent) { data.insert(data.end(), latent.begin(), latent.end()); }
+    void clear() { data.clear(); }
+    void dropFront(size_t frames) {
+        data.erase(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(frames * LATENT_DIM));
+    }
+    const float* frame(size_t i) const { return data.data() + i * LATENT_DIM; }
+};
+
+// Autoregressive position of one utterance in flow_lm_main. The vectors
+// are sized once and rewritten in place every frame.
+struct Utterance {
+    SessionState lmState;
+    std::vector<float> current = std::vector<float>(LATENT_DIM, std::nanf(""));
+    std::vector<float> conditioning;  // Output of the latest main step
+    std::vector<float> latent = std::vector<float>(LATENT_DIM, 0.0f);  // Frame being integrated
+    int step = 0;
+    int eosStep = -1;
+    bool finished = false;
+    uint64_t noiseSeed = 0;  // Frame f starts from FrameNoise(noiseSeed, f)
+    // Bounded context only: state after the voice and text passes, and the
+    // inputs fed since the last (re)prime
+    std::shared_ptr<const StateSnapshot> primed;
+    LatentFrames history;
+    GenerationStats stats;
+};
+
+// Chooses the size of each streamed chunk from StreamingConfig
+class ChunkPlanner {
+public:
+    explicit ChunkPlanner(const StreamingConfig& cfg)
+        : cfg_(cfg), maxFrames_(std::max(1, cfg.chunkSizeFrames)) {
+        if (cfg_.chunkSchedule.empty() && cfg_.targetLatencyMs <= 0.0f && cfg_.firstChunkFrames > 0) {
+            ramp_ = static_cast<float>(cfg_.firstChunkFrames);
+        }
+    }
+    
+    /// Frames to accumulate before flushing the current chunk
+    int target() const {
+        if (!cfg_.chunkSchedule.empty()) {
+            size_t i = std::min(chunkIndex_, cfg_.chunkSchedule.size() - 1);
+            return std::max(1, cfg_.chunkSchedule[i]);
+        }
+        if (cfg_.targetLatencyMs > 0.0f) {
+            float lm = lmFrameMs_;
+            float dec = decoderFrameMs_.load(std::memory_order_relaxed);
+            if (chunkIndex_ == 0 || lm <= 0.0f) return 1;
+            // Pipelined decoding overlaps the LM, so the slower stage dominates
+            float perFrame = cfg_.pipelined ? std::max(lm, dec) : lm + dec;
+            int frames = static_cast<int>(cfg_.targetLatencyMs / std::max(perFrame, 1e-3f));
+            return std::clamp(frames, 1, maxFrames_);
+        }
+        if (ramp_ > 0.0f) {
+            return std::clamp(static_cast<int>(ramp_), 1, maxFrames_);
+        }
+        return maxFrames_;
+    }
+    
+    void chunkEmitted() {
+        ++chunkIndex_;
+        if (ramp_ > 0.0f) {
+            ramp_ = std::min(ramp_ * std::max(1.0f, cfg_.chunkGrowth), static_cast<float>(maxFrames_));
+        }
+    }
+    
+    /// Time of one LM step plus flow integration (generation thread)
+    void recordFrame(float ms) {
+        lmFrameMs_ = smooth(lmFrameMs_, ms);
+    }
+    
+    /// Decode time of a chunk; may be called from the decoder thread
+    void recordDecode(float ms, size_t frames) {
+        if (frames == 0) return;
+        float perFrame = ms / static_cast<float>(frames);
+        decoderFrameMs_.store(smooth(decoderFrameMs_.load(std::memory_order_relaxed), perFrame),
+                              std::memory_order_relaxed);
+    }
+
+private:
+    static float smooth(float avg, float sample) {
+        return avg <= 0.0f ? sample : 0.8f * avg + 0.2f * sample;
+    }
+    
+    const StreamingConfig& cfg_;
+    int maxFrames_;
+    size_t chunkIndex_ = 0;
+    float ramp_ = 0.0f;
+    float lmFrameMs_ = 0.0f;
+    std::atomic<float> decoderFrameMs_{0.0f};
+};
+
+// Latent frames handed to the decoder in one go
+struct DecodeJob {
+    LatentFrames latents;
+    bool isFinal = false;
+    bool stop = false;  // Tells the decoder thread to exit
+};
+
+// Dedicated decoder thread fed through a bounded SPSC queue. The producer
+// only waits when the queue is full, which gives backpressure against a
+// slow consumer callback without stalling on every chunk decode.
+class DecodeWorker {
+public:
+    DecodeWorker(size_t queueDepth, std::function<void(DecodeJob&)> fn)
+        : queue_(queueDepth), fn_(std::move(fn)), thread_([this] { run(); }) {}
+    
+    ~DecodeWorker() {
+        try {
+            finish();
+        } catch (...) {
+            // Already unwinding from the generation loop; drop decoder errors
+        }
+    }
+    
+    DecodeWorker(const DecodeWorker&) = delete;
+    DecodeWorker& operator=(const DecodeWorker&) = delete;
+    
+    /// Queue a job; returns false once the decoder thread has failed
+    bool submit(DecodeJob&& job) {
+        Backoff backoff;
+        while (!queue_.tryPush(std::move(job))) {
+            if (failed_.load(std::memory_order_acquire)) return false;
+            backoff.pause();
+        }
+        return !failed_.load(std::memory_order_acquire);
+    }
+    
+    /// Drain the queue, join the thread and rethrow its first error
+    void finish() {
+        if (!thread_.joinable()) return;
+        DecodeJob stopJob;
+        stopJob.stop = true;
+        Backoff backoff;
+        while (!queue_.tryPush(std::move(stopJob))) backoff.pause();
+        thread_.join();
+        if (error_) std::rethrow_exception(error_);
+    }
+
+private:
+    void run() {
+        DecodeJob job;
+        Backoff backoff;
+        for (;;) {
+            if (!queue_.tryPop(job)) {
+                backoff.pause();
+                continue;
+            }
+            backoff.reset();
+            if (job.stop) return;
+            if (failed_.load(std::memory_order_relaxed)) continue;  // Keep draining
+            try {
+                fn_(job);
+            } catch (...) {
+                error_ = std::current_exception();
+                failed_.store(true, std::memory_order_release);
+            }
+        }
+    }
+    
+    SpscQueue<DecodeJob> queue_;
+    std::function<void(DecodeJob&)> fn_;
+    std::atomic<bool> failed_{false};
+    std::exception_ptr error_;
+    std::thread thread_;
+};
+
+struct PocketTTSModel::Impl {
     PocketTTSConfig config;
     
     // ONNX Runtime
-    Ort::Env env{ORT_LOGGING_LEVEL_WARNING, "PocketTTS"};
-    Ort::SessionOptions sessionOptions;
+    std::shared_ptr<Ort::Env> env;  // Process-wide, see sharedEnv()
     Ort::MemoryInfo memoryInfo{Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)};
+    Ort::RunOptions runOptions;     // Shared by every run; carries arena shrinkage
+    std::shared_ptr<Ort::PrepackedWeightsContainer> prepackedWeights;  // Outlives the sessions
+    std::atomic<size_t> modelFileBytes{0};
     
-    // Models
+    // Models; with lazyLoad the encoder and text conditioner are created by
+    // voiceEncoder() / conditioner() on first use
     std::unique_ptr<Ort::Session> mimiEncoder;
     std::unique_ptr<Ort::Session> textConditioner;
+    std::once_flag mimiEncoderOnce;
+    std::once_flag textConditionerOnce;
     std::unique_ptr<Ort::Session> flowLmMain;
     std::unique_ptr<Ort::Session> flowLmFlow;
     std::unique_ptr<Ort::Session> mimiDecoder;
+    std::unique_ptr<Ort::Session> flowLmFlowFused;  // Optional unrolled Euler loop
+    
+    // State layout of the stateful models
+    SessionSignature flowLmMainSig;
+    SessionSignature mimiDecoderSig;
     
     // Tokenizer
     std::unique_ptr<Tokenizer> tokenizer;
     
-    // Pre-computed flow buffers
-    std::vector<std::pair<float, float>> stBuffers;
+    // flow_lm_flow accepts a dynamic batch dimension (batched flow across requests)
+    bool flowBatchable = false;
     
-    // RNG for temperature
-    std::mt19937 rng{std::random_device{}()};
+    // Voice cache keyed by source audio content hash, LRU within voiceCacheBytes;
+    // shared by every context on this model
+    struct VoiceCacheEntry {
+        VoiceEmbedding voice;
+        std::list<uint64_t>::iterator lru;
+    };
+    std::unordered_map<uint64_t, VoiceCacheEntry> voiceCache;
+    std::list<uint64_t> voiceCacheOrder;  // Most recently used first
+    size_t voiceCacheUsed = 0;
+    std::mutex voiceCacheMutex;
     
-    // Voice cache
-    std::map<std::string, std::pair<std::vector<float>, std::vector<int64_t>>> voiceCache;
+    // Voice prefix cache: LM state after the voice pass, LRU by embeddings hash
+    std::map<uint64_t, std::pair<std::shared_ptr<const StateSnapshot>, std::list<uint64_t>::iterator>> voicePrefixCache;
+    std::list<uint64_t> voicePrefixOrder;  // Most recently used first
+    std::mutex voicePrefixMutex;
     
-    // Cancellation flag for streaming
-    std::atomic<bool> cancelRequested{false};
+    // Text conditioning per normalized text, and memoized audio of
+    // deterministic (temperature 0 or fixed-seed) requests
+    LruCache<TextConditioning> textCache;
+    LruCache<std::vector<float>> audioCache;
     
-    Impl(const PocketTTSConfig& cfg) : config(cfg) {
-        sessionOptions.SetIntraOpNumThreads(3);
-        sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
-        
+    Impl(const PocketTTSConfig& cfg)
+        : config(cfg), env(sharedEnv(cfg)), textCache(cfg.textCacheBytes), audioCache(cfg.audioCacheBytes) {
+        if (config.precision != "int8" && config.precision != "fp16" && config.precision != "fp32") {
+            throw std::invalid_argument("Unknown precision: " + config.precision);
+        }
+        if (config.arenaShrinkage) {
+            runOptions.AddConfigEntry("memory.enable_memory_arena_shrinkage", "cpu:0");
+        }
         loadModels();
         loadTokenizer();
-        precomputeFlowBuffers();
     }
     
-    void loadModels() {
-        std::string suffix = (config.precision == "int8") ? "_int8" : "";
+    // Session options for one model; threads > 0 overrides config.intraOpThreads
+    Ort::SessionOptions makeSessionOptions(int threads) const {
+        Ort::SessionOptions options;
+        options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+        
+        int intraThreads = threads > 0 ? threads : config.intraOpThreads;
+        if (config.interOpThreads > 1) {
+            options.SetExecutionMode(ExecutionMode::ORT_PARALLEL);
+        }
+        if (config.globalThreadPools) {
+            // Pools (and spinning) were configured on the shared Env
+            options.DisablePerSessionThreads();
+            intraThreads = config.intraOpThreads;
+        } else {
+            options.SetIntraOpNumThreads(std::max(0, intraThreads));
+            if (config.interOpThreads > 1) {
+                options.SetInterOpNumThreads(config.interOpThreads);
+            }
+            
+            const char* spin = config.allowSpinning ? "1" : "0";
+            options.AddConfigEntry("session.intra_op.allow_spinning", spin);
+            options.AddConfigEntry("session.inter_op.allow_spinning", spin);
+            if (!config.threadAffinity.empty()) {
+                options.AddConfigEntry("session.intra_op_thread_affinities", config.threadAffinity.c_str());
+            }
+        }
+        
+        if (!config.cpuArena) {
+            options.DisableCpuMemArena();
+        } else if (config.sharedArena) {
+            options.AddConfigEntry("session.use_env_allocators", "1");
+        }
+        
+        appendExecutionProvider(options, intraThreads);
+        return options;
+    }
+    
+    void appendExecutionProvider(Ort::SessionOptions& options, int intraThreads) const {
+        const std::string& ep = config.executionProvider;
+        if (ep.empty() || ep == "cpu") {
+            return;
+        }
+        if (ep == "cuda") {
+            OrtCUDAProviderOptions cudaOptions{};
+            cudaOptions.device_id = config.deviceId;
+            options.AppendExecutionProvider_CUDA(cudaOptions);
+        } else if (ep == "coreml") {
+            options.AppendExecutionProvider("CoreML", {});
+        } else if (ep == "xnnpack") {
+            options.AppendExecutionProvider("XNNPACK", {
+                {"intra_op_num_threads", std::to_string(std::max(1, intraThreads))}
+            });
+        } else if (ep == "dml") {
+#ifdef POCKET_TTS_USE_DML
+            options.DisableMemPattern();
+            options.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+            Ort::ThrowOnError(OrtSessionOptionsAppendExecutionProvider_DML(options, config.deviceId));
+#else
+            throw std::runtime_error("DirectML support not built (configure with -DPOCKET_TTS_USE_DML=ON)");
+#endif
+        } else {
+            throw std::invalid_argument("Unknown execution provider: " + ep);
+        }
+    }
+    
+    OrtPrepackedWeightsContainer* prepacked() {
+        return prepackedWeights ? static_cast<OrtPrepackedWeightsContainer*>(*prepackedWeights) : nullptr;
+    }
+    
+    // Create one session, going through the optimized-model cache when enabled
+    std::unique_ptr<Ort::Session> openSession(const std::string& modelPath, int threads) {
+        Ort::SessionOptions options = makeSessionOptions(threads);
+        std::error_code sizeError;
+        const auto fileBytes = std::filesystem::file_size(modelPath, sizeError);
+        if (!sizeError) modelFileBytes += static_cast<size_t>(fileBytes);
+        
+        if (config.optimizedModelCacheDir.empty()) {
+            return createSession(*env, modelPath, options, prepacked(), config.mapModelFiles);
+        }
         
-        std::string mimiEncoderPath = config.modelsDir + "/mimi_encoder.onnx";
-        std::string textConditionerPath = config.modelsDir + "/text_conditioner.onnx";
-        std::string flowLmMainPath = config.modelsDir + "/flow_lm_main" + suffix + ".onnx";
-        std::string flowLmFlowPath = config.modelsDir + "/flow_lm_flow" + suffix + ".onnx";
-        std::string mimiDecoderPath = config.modelsDir + "/mimi_decoder" + suffix + ".onnx";
+        namespace fs = std::filesystem;
+        const std::string ep = config.executionProvider.empty() ? "cpu" : config.executionProvider;
+        const fs::path cachePath = fs::path(config.optimizedModelCacheDir) /
+            (fs::path(modelPath).stem().string() + "." + ep + ".opt.onnx");
+        
+        std::error_code ec;
+        auto sourceTime = fs::last_write_time(modelPath, ec);
+        if (!ec) {
+            auto cacheTime = fs::last_write_time(cachePath, ec);
+            if (!ec && cacheTime >= sourceTime) {
+                // Already optimized; re-running the optimizers would only cost time
+                options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+                return createSession(*env, cachePath.string(), options, prepacked(),
+                                     config.mapModelFiles);
+            }
+        }
         
+        // Write to a private name and rename, so concurrently starting
+        // workers never load a half-written graph
+        fs::create_directories(config.optimizedModelCacheDir, ec);
+        const fs::path tmpPath = cachePath.string() + ".tmp" + std::to_string(std::random_device{}());
+        const OrtPath tmpOrtPath = toOrtPath(tmpPath.string());
+        options.SetOptimizedModelFilePath(tmpOrtPath.c_str());
+        auto session = createSession(*env, modelPath, options, prepacked(), config.mapModelFiles);
+        fs::rename(tmpPath, cachePath, ec);
+        if (ec) {
+            fs::remove(tmpPath, ec);
+        }
+        return session;
+    }
+    
+    std::string modelFile(const std::string& name, bool quantized) const {
+        std::string suffix;
+        if (quantized && config.precision != "fp32") suffix = "_" + config.precision;
+        return config.modelsDir + "/" + name + suffix + ".onnx";
+    }
+    
+    // Sessions that may be created lazily; thread-safe, and retried on the
+    // next call if creation throws
+    Ort::Session& voiceEncoder() {
+        if (!config.loadVoiceEncoder) {
+            throw std::runtime_error("Voice encoder is disabled (loadVoiceEncoder=false).");
+        }
+        std::call_once(mimiEncoderOnce, [this] {
+            mimiEncoder = openSession(modelFile("mimi_encoder", false), config.mimiEncoderThreads);
+        });
+        return *mimiEncoder;
+    }
+    
+    Ort::Session& conditioner() {
+        std::call_once(textConditionerOnce, [this] {
+            textConditioner = openSession(modelFile("text_conditioner", false), config.textConditionerThreads);
+        });
+        return *textConditioner;
+    }
+    
+    void loadModels() {
         if (config.verbose) {
             std::cout << "Loading models from " << config.modelsDir << " (precision: " << config.precision << ")..." << std::endl;
         }
         
-        if (config.loadVoiceEncoder) {
-            mimiEncoder = createSession(env, mimiEncoderPath, sessionOptions);
+        if (config.sharePrepackedWeights) {
+            prepackedWeights = sharedPrepackedWeights();
+        }
+        
+        if (!config.lazyLoad) {
+            if (config.loadVoiceEncoder) {
+                voiceEncoder();
+            }
+            conditioner();
+        }
+        flowLmMain = openSession(modelFile("flow_lm_main", true), config.flowLmMainThreads);
+        flowLmFlow = openSession(modelFile("flow_lm_flow", true), config.flowLmFlowThreads);
+        mimiDecoder = openSession(modelFile("mimi_decoder", true), config.mimiDecoderThreads);
+        if (config.fusedFlow) {
+            flowLmFlowFused = openSession(modelFile("flow_lm_flow_fused", true), config.flowLmFlowThreads);
+        }
+        
+        if (config.precision == "fp16") {
+            requireFloatIo(*flowLmMain, "flow_lm_main");
+            requireFloatIo(*flowLmFlow, "flow_lm_flow");
+            requireFloatIo(*mimiDecoder, "mimi_decoder");
+            if (flowLmFlowFused) requireFloatIo(*flowLmFlowFused, "flow_lm_flow_fused");
+        }
+        
+        flowLmMainSig = buildSignature(*flowLmMain);
+        mimiDecoderSig = buildSignature(*mimiDecoder);
+        
+        Ort::AllocatorWithDefaultOptions allocator;
+        for (size_t i = 0; i < flowLmFlow->GetInputCount(); ++i) {
+            auto namePtr = flowLmFlow->GetInputNameAllocated(i, allocator);
+            if (std::string(namePtr.get()) == "x") {
+                auto shape = flowLmFlow->GetInputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape();
+                flowBatchable = !shape.empty() && shape[0] < 0;
+            }
         }
-        textConditioner = createSession(env, textConditionerPath, sessionOptions);
-        flowLmMain = createSession(env, flowLmMainPath, sessionOptions);
-        flowLmFlow = createSession(env, flowLmFlowPath, sessionOptions);
-        mimiDecoder = createSession(env, mimiDecoderPath, sessionOptions);
         
         if (config.verbose) {
             std::cout << "Models loaded successfully." << std::endl;
         }
     }
     
+    // fp16 graphs must be exported with float32 data inputs and outputs
+    // (keep_io_types); only the opaque state tensors may be half precision
+    static void requireFloatIo(Ort::Session& session, const std::string& model) {
+        Ort::AllocatorWithDefaultOptions allocator;
+        auto check = [&](const std::string& name, ONNXTensorElementDataType type) {
+            if (name.find("state_") == std::string::npos && type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) {
+                throw std::runtime_error(model + ": '" + name + "' is float16; export fp16 models with "
+                                         "float32 inputs and outputs (keep_io_types)");
+            }
+        };
+        for (size_t i = 0; i < session.GetInputCount(); ++i) {
+            check(session.GetInputNameAllocated(i, allocator).get(),
+                  session.GetInputTypeInfo(i).GetTensorTypeAndShapeInfo().GetElementType());
+        }
+        for (size_t i = 0; i < session.GetOutputCount(); ++i) {
+            check(session.GetOutputNameAllocated(i, allocator).get(),
+                  session.GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetElementType());
+        }
+    }
+    
     void loadTokenizer() {
         tokenizer = std::make_unique<Tokenizer>(config.tokenizerPath);
         if (config.verbose) {
@@ -119,157 +882,486 @@ struct PocketTTS::Impl {
         }
     }
     
-    void precomputeFlowBuffers() {
-        float dt = 1.0f / config.lsdSteps;
-        stBuffers.clear();
-        for (int j = 0; j < config.lsdSteps; ++j) {
-            float s = static_cast<float>(j) / config.lsdSteps;
-            float t = s + dt;
-            stBuffers.emplace_back(s, t);
+    // Allocate a zero-filled state tensor
+    Ort::Value allocateState(const std::vector<int64_t>& shape, ONNXTensorElementDataType dtype) {
+        Ort::AllocatorWithDefaultOptions allocator;
+        auto value = Ort::Value::CreateTensor(allocator, shape.data(), shape.size(), dtype);
+        
+        size_t count = 1;
+        for (auto dim : shape) count *= static_cast<size_t>(dim);
+        if (count > 0) {
+            std::memset(value.GetTensorMutableRawData(), 0, count * elementSize(dtype));
         }
+        return value;
     }
     
-    // Initialize state tensors for stateful model with proper types
-    std::map<std::string, StateEntry> initState(Ort::Session& session) {
-        std::map<std::string, StateEntry> state;
+    // Resolve the state layout and output names of a stateful session
+    SessionSignature buildSignature(Ort::Session& session) {
+        SessionSignature sig;
         Ort::AllocatorWithDefaultOptions allocator;
         
+        // State inputs keyed by index N so slots come out in order
+        std::map<int, StateSlot> slotsByIndex;
         size_t numInputs = session.GetInputCount();
         for (size_t i = 0; i < numInputs; ++i) {
             auto namePtr = session.GetInputNameAllocated(i, allocator);
             std::string name = namePtr.get();
             
             if (name.find("state_") == 0) {
-                auto typeInfo = session.GetInputTypeInfo(i);
-                auto tensorInfo = typeInfo.GetTensorTypeAndShapeInfo();
-                auto shape = tensorInfo.GetShape();
-                auto dtype = tensorInfo.GetElementType();
-                
-                // Replace dynamic dims with their default values from shape
-                for (auto& dim : shape) {
-                    if (dim < 0) dim = 0;
-                }
+                auto tensorInfo = session.GetInputTypeInfo(i).GetTensorTypeAndShapeInfo();
                 
-                // Calculate total size
-                int64_t totalSize = 1;
-                for (auto dim : shape) {
-                    if (dim > 0) totalSize *= dim;
-                }
-                if (totalSize <= 0) totalSize = 1;
-                
-                StateEntry entry;
-                entry.shape = shape;
-                entry.dtype = dtype;
+                StateSlot slot;
+                slot.inputName = name;
+                slot.initShape = tensorInfo.GetShape();
                 
-                switch (dtype) {
+                switch (tensorInfo.GetElementType()) {
                     case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
-                        entry.floatData.resize(totalSize, 0.0f);
-                        break;
                     case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
-                        entry.int64Data.resize(totalSize, 0);
-                        break;
                     case ONNX_TENSOR_ELEMENT_DATA_TYPE_BOOL:
-                        entry.boolData.resize(totalSize, 0);
+                    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16:
+                        slot.dtype = tensorInfo.GetElementType();
                         break;
                     default:
                         // Default to float
-                        entry.floatData.resize(totalSize, 0.0f);
-                        entry.dtype = ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+                        slot.dtype = ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
                         break;
                 }
                 
-                state[name] = std::move(entry);
+                slotsByIndex[std::stoi(name.substr(6))] = std::move(slot);
             }
         }
         
-        return state;
-    }
-    
-    // Create Ort::Value from StateEntry
-    Ort::Value createStateValue(StateEntry& entry) {
-        switch (entry.dtype) {
-            case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
-                return Ort::Value::CreateTensor<float>(
-                    memoryInfo, entry.floatData.data(), entry.floatData.size(),
-                    entry.shape.data(), entry.shape.size());
-            case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
-                return Ort::Value::CreateTensor<int64_t>(
-                    memoryInfo, entry.int64Data.data(), entry.int64Data.size(),
-                    entry.shape.data(), entry.shape.size());
-            case ONNX_TENSOR_ELEMENT_DATA_TYPE_BOOL:
-                // Cast uint8_t* to bool* - they're compatible in memory
-                return Ort::Value::CreateTensor<bool>(
-                    memoryInfo, reinterpret_cast<bool*>(entry.boolData.data()), entry.boolData.size(),
-                    entry.shape.data(), entry.shape.size());
-            default:
-                return Ort::Value::CreateTensor<float>(
-                    memoryInfo, entry.floatData.data(), entry.floatData.size(),
-                    entry.shape.data(), entry.shape.size());
-        }
-    }
-    
-    // Update state from output tensor
-    void updateStateFromOutput(StateEntry& entry, Ort::Value& outputTensor) {
-        auto info = outputTensor.GetTensorTypeAndShapeInfo();
-        entry.shape = info.GetShape();
-        size_t count = info.GetElementCount();
-        
-        switch (entry.dtype) {
-            case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT: {
-                float* data = outputTensor.GetTensorMutableData<float>();
-                entry.floatData.assign(data, data + count);
-                break;
-            }
-            case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64: {
-                int64_t* data = outputTensor.GetTensorMutableData<int64_t>();
-                entry.int64Data.assign(data, data + count);
-                break;
+        std::map<int, int> slotOfIndex;
+        for (auto& [idx, slot] : slotsByIndex) {
+            slotOfIndex[idx] = static_cast<int>(sig.states.size());
+            sig.states.push_back(std::move(slot));
+        }
+        
+        size_t numOutputs = session.GetOutputCount();
+        for (size_t i = 0; i < numOutputs; ++i) {
+            auto namePtr = session.GetOutputNameAllocated(i, allocator);
+            std::string name = namePtr.get();
+            
+            int slotIdx = -1;
+            if (name.find("out_state_") == 0) {
+                auto it = slotOfIndex.find(std::stoi(name.substr(10)));
+                if (it != slotOfIndex.end()) {
+                    slotIdx = it->second;
+                    
+                    // Output shapes tell fixed-size states apart from growing ones
+                    auto& slot = sig.states[slotIdx];
+                    auto outShape = session.GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape();
+                    slot.fixedShape = (outShape == slot.initShape);
+                }
             }
-            case ONNX_TENSOR_ELEMENT_DATA_TYPE_BOOL: {
-                bool* data = outputTensor.GetTensorMutableData<bool>();
-                entry.boolData.resize(count);
-                for (size_t i = 0; i < count; ++i) {
-                    entry.boolData[i] = data[i] ? 1 : 0;
+            
+            sig.outputNameStrs.push_back(name);
+            sig.outputSlots.push_back(slotIdx);
+        }
+        for (const auto& name : sig.outputNameStrs) {
+            sig.outputNames.push_back(name.c_str());
+        }
+        
+        // Replace dynamic dims with their default values from shape
+        for (auto& slot : sig.states) {
+            for (auto& dim : slot.initShape) {
+                if (dim < 0) {
+                    dim = 0;
+                    slot.fixedShape = false;
                 }
-                break;
             }
-            default:
-                break;
         }
+        
+        return sig;
     }
     
-    std::vector<float> encodeVoice(const std::string& audioPath) {
-        // Check cache
-        auto it = voiceCache.find(audioPath);
-        if (it != voiceCache.end()) {
-            return it->second.first;
+    // Initialize state tensors for stateful model with proper types
+    SessionState initState(const SessionSignature& sig) {
+        SessionState state(sig.states.size());
+        for (size_t i = 0; i < sig.states.size(); ++i) {
+            const auto& slot = sig.states[i];
+            auto& entry = state[i];
+            entry.value = allocateState(slot.initShape, slot.dtype);
+            if (slot.fixedShape) {
+                entry.spare = allocateState(slot.initShape, slot.dtype);
+            }
         }
-
-        if (!mimiEncoder) {
-            throw std::runtime_error("Voice encoder is disabled (loadVoiceEncoder=false).");
+        return state;
+    }
+    
+    // Run a stateful session through IoBinding. State inputs are bound from
+    // `state`, state outputs are bound to the spare buffers (fixed shape) or
+    // left to ORT (growing), then swapped/adopted as the next step's inputs.
+    // Returns the non-state outputs in session order.
+    std::vector<Ort::Value> runWithState(
+        Ort::Session& session,
+        const SessionSignature& sig,
+        const char* const* inputNames,
+        const Ort::Value* inputs,
+        size_t inputCount,
+        SessionState& state,
+        SessionStats* runStats = nullptr,
+        uint64_t* stateBytesAllocated = nullptr
+    ) {
+        Ort::IoBinding binding(session);
+        
+        for (size_t i = 0; i < inputCount; ++i) {
+            binding.BindInput(inputNames[i], inputs[i]);
         }
-
-        // Load audio
-        auto audio = AudioUtils::loadWav(audioPath, AudioUtils::TARGET_SAMPLE_RATE);
-        // Long reference clips explode KV-cache memory in the autoregressive pass.
-        // A short reference (few seconds) is enough for stable voice conditioning.
-        constexpr size_t MAX_REFERENCE_SAMPLES = static_cast<size_t>(AudioUtils::TARGET_SAMPLE_RATE) * 5;
-        if (audio.size() > MAX_REFERENCE_SAMPLES) {
-            audio.resize(MAX_REFERENCE_SAMPLES);
+        for (size_t i = 0; i < state.size(); ++i) {
+            binding.BindInput(sig.states[i].inputName.c_str(), state[i].input());
         }
         
-        // Prepare input: [1, 1, samples]
-        std::vector<int64_t> audioShape = {1, 1, static_cast<int64_t>(audio.size())};
-        auto audioTensor = createTensor(memoryInfo, audio, audioShape);
-        
-        // Run MIMI encoder
-        const char* inputNames[] = {"audio"};
-        const char* outputNames[] = {"latents"};
+        for (size_t i = 0; i < sig.outputNames.size(); ++i) {
+            int slot = sig.outputSlots[i];
+            if (slot >= 0 && sig.states[slot].fixedShape) {
+                binding.BindOutput(sig.outputNames[i], state[slot].spare);
+            } else {
+                binding.BindOutput(sig.outputNames[i], memoryInfo);
+            }
+        }
         
-        auto outputs = mimiEncoder->Run(
-            Ort::RunOptions{nullptr},
-            inputNames, &audioTensor, 1,
-            outputNames, 1
+        {
+            RunTimer timer(runStats);
+            session.Run(runOptions, binding);
+        }
+        auto outputs = binding.GetOutputValues();
+        uint64_t allocated = 0;
+        
+        // Data outputs are compacted to the front of `outputs` in place
+        size_t dataOutputs = 0;
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            int slot = sig.outputSlots[i];
+            if (slot < 0) {
+                if (dataOutputs != i) outputs[dataOutputs] = std::move(outputs[i]);
+                ++dataOutputs;
+            } else if (sig.states[slot].fixedShape) {
+                std::swap(state[slot].value, state[slot].spare);
+                if (state[slot].shared) {
+                    // The snapshot stays untouched; give this request its own spare
+                    state[slot].shared.reset();
+                    state[slot].spare = allocateState(sig.states[slot].initShape, sig.states[slot].dtype);
+                    allocated += stateBytes(sig.states[slot]);
+                }
+            } else {
+                if (stateBytesAllocated) {
+                    // Moved into the slot, but ORT allocated it for this run
+                    allocated += outputs[i].GetTensorTypeAndShapeInfo().GetElementCount() *
+                              elementSize(sig.states[slot].dtype);
+                }
+                state[slot].value = std::move(outputs[i]);
+                state[slot].shared.reset();
+            }
+        }
+        if (stateBytesAllocated) *stateBytesAllocated += allocated;
+        
+        outputs.erase(outputs.begin() + static_cast<std::ptrdiff_t>(dataOutputs), outputs.end());
+        return outputs;
+    }
+    
+    // Freeze a state into a snapshot; `state` is left empty
+    static StateSnapshot snapshotState(SessionState& state) {
+        StateSnapshot snapshot;
+        snapshot.reserve(state.size());
+        for (auto& entry : state) {
+            snapshot.push_back(entry.shared ? entry.shared
+                                            : std::make_shared<const Ort::Value>(std::move(entry.value)));
+        }
+        state.clear();
+        return snapshot;
+    }
+    
+    // Copy-on-write clone: requests read the snapshot tensors directly and
+    // only allocate their own buffers once a run produces new state
+    SessionState cloneState(const SessionSignature& sig, const StateSnapshot& snapshot,
+                            uint64_t* stateBytesAllocated = nullptr) {
+        SessionState state(sig.states.size());
+        for (size_t i = 0; i < sig.states.size(); ++i) {
+            state[i].shared = snapshot[i];
+            if (sig.states[i].fixedShape) {
+                state[i].spare = allocateState(sig.states[i].initShape, sig.states[i].dtype);
+                if (stateBytesAllocated) *stateBytesAllocated += stateBytes(sig.states[i]);
+            }
+        }
+        return state;
+    }
+    
+    // LM state right after the voice conditioning pass, cached per voice
+    std::shared_ptr<const StateSnapshot> voicePrefix(
+        const std::vector<float>& voiceEmb,
+        const std::vector<int64_t>& voiceShape,
+        GenerationStats* stats = nullptr
+    ) {
+        const uint64_t key = hashEmbeddings(voiceEmb, voiceShape);
+        if (config.voicePrefixCacheSize > 0) {
+            std::lock_guard<std::mutex> lock(voicePrefixMutex);
+            auto it = voicePrefixCache.find(key);
+            if (it != voicePrefixCache.end()) {
+                voicePrefixOrder.splice(voicePrefixOrder.begin(), voicePrefixOrder, it->second.second);
+                if (stats) stats->voicePrefixCached = true;
+                return it->second.first;
+            }
+        }
+        
+        // Voice conditioning pass
+        SessionState state = initState(flowLmMainSig);
+        std::vector<float> emptySeq;
+        std::vector<int64_t> emptySeqShape = {1, 0, 32};
+        std::vector<float> conditioning;
+        {
+            StageTimer timer(config.onStageTiming, Stage::VoicePrefill);
+            runFlowLmMainStep(emptySeq, emptySeqShape, voiceEmb, voiceShape, state, conditioning, stats);
+        }
+        
+        auto snapshot = std::make_shared<const StateSnapshot>(snapshotState(state));
+        if (config.voicePrefixCacheSize > 0) {
+            storeVoicePrefix(key, snapshot);
+        }
+        return snapshot;
+    }
+    
+    void storeVoicePrefix(uint64_t key, std::shared_ptr<const StateSnapshot> snapshot) {
+        std::lock_guard<std::mutex> lock(voicePrefixMutex);
+        auto it = voicePrefixCache.find(key);
+        if (it != voicePrefixCache.end()) {
+            voicePrefixOrder.erase(it->second.second);
+            voicePrefixCache.erase(it);
+        }
+        voicePrefixOrder.push_front(key);
+        voicePrefixCache.emplace(key, std::make_pair(std::move(snapshot), voicePrefixOrder.begin()));
+        
+        // Evict least recently used voices
+        while (voicePrefixCache.size() > static_cast<size_t>(std::max(0, config.voicePrefixCacheSize))) {
+            voicePrefixCache.erase(voicePrefixOrder.back());
+            voicePrefixOrder.pop_back();
+        }
+    }
+    
+    // On-disk voice prefix: magic, key, slot count, then per slot
+    // dtype, rank, dims and raw tensor bytes
+    static constexpr char VOICE_PREFIX_MAGIC[8] = {'P', 'T', 'T', 'S', 'P', 'F', 'X', '1'};
+    
+    void saveVoicePrefix(const VoiceEmbedding& voice, const std::string& path) {
+        const uint64_t key = hashEmbeddings(voice.embeddings, voice.shape);
+        auto snapshot = voicePrefix(voice.embeddings, voice.shape);
+        
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Failed to create voice prefix file: " + path);
+        }
+        auto writePod = [&file](const auto& v) {
+            file.write(reinterpret_cast<const char*>(&v), sizeof(v));
+        };
+        
+        file.write(VOICE_PREFIX_MAGIC, sizeof(VOICE_PREFIX_MAGIC));
+        writePod(key);
+        writePod(static_cast<uint32_t>(snapshot->size()));
+        for (const auto& value : *snapshot) {
+            auto info = value->GetTensorTypeAndShapeInfo();
+            auto shape = info.GetShape();
+            writePod(static_cast<int32_t>(info.GetElementType()));
+            writePod(static_cast<uint32_t>(shape.size()));
+            for (auto dim : shape) writePod(dim);
+            file.write(static_cast<const char*>(value->GetTensorRawData()),
+                       static_cast<std::streamsize>(info.GetElementCount() * elementSize(info.GetElementType())));
+        }
+        if (!file) {
+            throw std::runtime_error("Failed to write voice prefix file: " + path);
+        }
+    }
+    
+    void loadVoicePrefix(const std::string& path) {
+        MappedFile file(path);
+        size_t offset = 0;
+        auto corrupt = [&path]() {
+            return std::runtime_error("Corrupt voice prefix file: " + path);
+        };
+        auto read = [&](void* dst, size_t bytes) {
+            if (bytes > file.size() - offset) {
+                throw corrupt();
+            }
+            std::memcpy(dst, file.data() + offset, bytes);
+            offset += bytes;
+        };
+        
+        char magic[sizeof(VOICE_PREFIX_MAGIC)];
+        read(magic, sizeof(magic));
+        if (std::memcmp(magic, VOICE_PREFIX_MAGIC, sizeof(magic)) != 0) {
+            throw std::runtime_error("Not a voice prefix file: " + path);
+        }
+        uint64_t key;
+        uint32_t count;
+        read(&key, sizeof(key));
+        read(&count, sizeof(count));
+        if (count != flowLmMainSig.states.size()) {
+            throw std::runtime_error("Voice prefix does not match the loaded flow_lm_main: " + path);
+        }
+        
+        StateSnapshot snapshot;
+        for (uint32_t i = 0; i < count; ++i) {
+            int32_t dtype;
+            uint32_t rank;
+            read(&dtype, sizeof(dtype));
+            read(&rank, sizeof(rank));
+            const auto& spec = flowLmMainSig.states[i];
+            if (rank != spec.initShape.size()) {
+                throw std::runtime_error("Voice prefix does not match the loaded flow_lm_main: " + path);
+            }
+            std::vector<int64_t> shape(rank);
+            read(shape.data(), rank * sizeof(int64_t));
+            
+            auto type = static_cast<ONNXTensorElementDataType>(dtype);
+            if (type != spec.dtype || (spec.fixedShape && shape != spec.initShape)) {
+                throw std::runtime_error("Voice prefix does not match the loaded flow_lm_main: " + path);
+            }
+            // Sizes come from the file: check them before allocating anything
+            size_t bytes = elementSize(type);
+            for (auto dim : shape) {
+                if (dim < 0) throw corrupt();
+                const auto extent = static_cast<size_t>(dim);
+                if (extent != 0 && bytes > std::numeric_limits<size_t>::max() / extent) throw corrupt();
+                bytes *= extent;
+            }
+            if (bytes > file.size() - offset) {
+                throw corrupt();
+            }
+            
+            Ort::AllocatorWithDefaultOptions allocator;
+            auto value = Ort::Value::CreateTensor(allocator, shape.data(), shape.size(), type);
+            read(value.GetTensorMutableRawData(), bytes);
+            snapshot.push_back(std::make_shared<const Ort::Value>(std::move(value)));
+        }
+        
+        storeVoicePrefix(key, std::make_shared<const StateSnapshot>(std::move(snapshot)));
+    }
+    
+    // Key of a voice prefix: hash of the embedding values and shape
+    static uint64_t hashEmbeddings(const std::vector<float>& emb, const std::vector<int64_t>& shape) {
+        uint64_t hash = 14695981039346656037ULL;
+        auto mix = [&hash](uint64_t word) {
+            hash ^= word;
+            hash *= 1099511628211ULL;
+            hash ^= hash >> 29;
+        };
+        for (auto dim : shape) mix(static_cast<uint64_t>(dim));
+        size_t i = 0;
+        for (; i + 1 < emb.size(); i += 2) {
+            uint64_t word;
+            std::memcpy(&word, &emb[i], sizeof(word));
+            mix(word);
+        }
+        if (i < emb.size()) {
+            uint32_t last;
+            std::memcpy(&last, &emb[i], sizeof(last));
+            mix(last);
+        }
+        return hash;
+    }
+    
+    std::vector<float> encodeVoice(const std::string& audioPath) {
+        return encodeVoiceEmbedding(audioPath).embeddings;
+    }
+    
+    // Voice embeddings, their [1, N, 1024] shape and the source content hash
+    VoiceEmbedding encodeVoiceEmbedding(const std::string& audioPath) {
+        if (!config.loadVoiceEncoder) {
+            throw std::runtime_error("Voice encoder is disabled (loadVoiceEncoder=false).");
+        }
+        // Only the part of the file that is kept gets decoded
+        return encodeReference(AudioUtils::loadWav(audioPath, AudioUtils::TARGET_SAMPLE_RATE,
+                                                   MAX_REFERENCE_SAMPLES));
+    }
+    
+    // Same as encodeVoiceEmbedding for audio already in memory
+    VoiceEmbedding encodeVoiceFromSamples(const float* samples, size_t count, int sampleRate) {
+        if (!samples || count == 0) {
+            throw std::invalid_argument("Voice audio must not be empty");
+        }
+        if (sampleRate <= 0) {
+            throw std::invalid_argument("Invalid sample rate: " + std::to_string(sampleRate));
+        }
+        
+        std::vector<float> audio(samples, samples + count);
+        if (sampleRate != AudioUtils::TARGET_SAMPLE_RATE) {
+            audio = AudioUtils::resample(audio, sampleRate, AudioUtils::TARGET_SAMPLE_RATE);
+        }
+        // Match what loadWav does to file input: normalize over the kept window
+        if (audio.size() > MAX_REFERENCE_SAMPLES) {
+            audio.resize(MAX_REFERENCE_SAMPLES);
+        }
+        return encodeReference(AudioUtils::normalize(audio));
+    }
+    
+    // Encode 24 kHz mono reference audio, cached by content hash
+    VoiceEmbedding encodeReference(std::vector<float> audio) {
+        if (!config.loadVoiceEncoder) {
+            throw std::runtime_error("Voice encoder is disabled (loadVoiceEncoder=false).");
+        }
+        
+        if (audio.size() > MAX_REFERENCE_SAMPLES) {
+            audio.resize(MAX_REFERENCE_SAMPLES);
+        }
+        
+        const uint64_t hash = hashAudio(audio.data(), audio.size());
+        if (auto cached = findCachedVoice(hash)) {
+            return *cached;
+        }
+        
+        VoiceEmbedding voice = runVoiceEncoder(audio);
+        voice.sourceHash = hash;
+        cacheVoice(voice);
+        return voice;
+    }
+    
+    std::optional<VoiceEmbedding> findCachedVoice(uint64_t hash) {
+        std::lock_guard<std::mutex> lock(voiceCacheMutex);
+        auto it = voiceCache.find(hash);
+        if (it == voiceCache.end()) {
+            return std::nullopt;
+        }
+        voiceCacheOrder.splice(voiceCacheOrder.begin(), voiceCacheOrder, it->second.lru);
+        return it->second.voice;
+    }
+    
+    // Insert a voice and evict least recently used ones over the byte budget
+    void cacheVoice(const VoiceEmbedding& voice) {
+        const size_t bytes = voice.embeddings.size() * sizeof(float);
+        if (bytes > config.voiceCacheBytes) {
+            return;
+        }
+        
+        std::lock_guard<std::mutex> lock(voiceCacheMutex);
+        if (voiceCache.count(voice.sourceHash)) {
+            return;
+        }
+        voiceCacheOrder.push_front(voice.sourceHash);
+        voiceCache.emplace(voice.sourceHash, VoiceCacheEntry{voice, voiceCacheOrder.begin()});
+        voiceCacheUsed += bytes;
+        
+        while (voiceCacheUsed > config.voiceCacheBytes) {
+            auto victim = voiceCache.find(voiceCacheOrder.back());
+            voiceCacheUsed -= victim->second.voice.embeddings.size() * sizeof(float);
+            voiceCache.erase(victim);
+            voiceCacheOrder.pop_back();
+        }
+    }
+    
+    // Run mimi_encoder on prepared reference audio
+    VoiceEmbedding runVoiceEncoder(std::vector<float>& audio) {
+        VoiceEmbedding voice;
+        
+        // Prepare input: [1, 1, samples]
+        std::vector<int64_t> audioShape = {1, 1, static_cast<int64_t>(audio.size())};
+        auto audioTensor = createTensor(memoryInfo, audio, audioShape);
+        
+        // Run MIMI encoder
+        const char* inputNames[] = {"audio"};
+        const char* outputNames[] = {"latents"};
+        
+        auto outputs = voiceEncoder().Run(
+            runOptions,
+            inputNames, &audioTensor, 1,
+            outputNames, 1
         );
         
         // Get embeddings
@@ -279,34 +1371,32 @@ struct PocketTTS::Impl {
         size_t embSize = embInfo.GetElementCount();
         
         float* embData = embTensor.GetTensorMutableData<float>();
-        std::vector<float> embeddings(embData, embData + embSize);
+        voice.embeddings.assign(embData, embData + embSize);
         
         // Ensure shape is [1, N, 1024]
-        std::vector<int64_t> finalShape = embShape;
-        while (finalShape.size() > 3) {
-            finalShape.erase(finalShape.begin());
+        voice.shape = embShape;
+        while (voice.shape.size() > 3) {
+            voice.shape.erase(voice.shape.begin());
         }
-        if (finalShape.size() < 3) {
-            finalShape.insert(finalShape.begin(), 1);
+        if (voice.shape.size() < 3) {
+            voice.shape.insert(voice.shape.begin(), 1);
         }
         
-        // Cache
-        voiceCache[audioPath] = {embeddings, finalShape};
-        
-        return embeddings;
+        return voice;
     }
     
-    std::vector<float> runTextConditioner(const std::vector<int64_t>& tokenIds) {
+    std::vector<float> runTextConditioner(const std::vector<int64_t>& tokenIds, SessionStats* runStats = nullptr) {
+        StageTimer timer(config.onStageTiming, Stage::TextConditioner);
         // Prepare input: [1, seq_len]
-        std::vector<int64_t> ids = tokenIds;  // Copy for non-const tensor
-        std::vector<int64_t> idsShape = {1, static_cast<int64_t>(ids.size())};
-        auto idsTensor = createTensor(memoryInfo, ids, idsShape);
+        std::vector<int64_t> idsShape = {1, static_cast<int64_t>(tokenIds.size())};
+        auto idsTensor = createInputTensor(memoryInfo, tokenIds, idsShape);
         
         const char* inputNames[] = {"token_ids"};
         const char* outputNames[] = {"embeddings"};
         
-        auto outputs = textConditioner->Run(
-            Ort::RunOptions{nullptr},
+        RunTimer runTimer(runStats);
+        auto outputs = conditioner().Run(
+            runOptions,
             inputNames, &idsTensor, 1,
             outputNames, 1
         );
@@ -319,358 +1409,948 @@ struct PocketTTS::Impl {
         return std::vector<float>(embData, embData + embSize);
     }
     
-    // Run flow LM main model - returns conditioning and EOS logit
-    std::pair<std::vector<float>, float> runFlowLmMainStep(
+    // Run flow LM main model. Writes the conditioning into `conditioning`
+    // (reusing its storage) and returns the EOS logit.
+    float runFlowLmMainStep(
         const std::vector<float>& sequence,
         const std::vector<int64_t>& seqShape,
         const std::vector<float>& textEmb,
         const std::vector<int64_t>& textShape,
-        std::map<std::string, StateEntry>& state
+        SessionState& state,
+        std::vector<float>& conditioning,
+        GenerationStats* stats = nullptr
     ) {
-        Ort::AllocatorWithDefaultOptions allocator;
-        
-        // Build inputs
-        std::vector<Ort::Value> inputTensors;
-        std::vector<const char*> inputNames;
-        std::vector<std::string> inputNameStrs;
-        
-        // Sequence input
-        std::vector<float> seqCopy = sequence;
-        inputTensors.push_back(createTensor(memoryInfo, seqCopy, seqShape));
-        inputNameStrs.push_back("sequence");
-        
-        // Text embeddings input
-        std::vector<float> textCopy = textEmb;
-        inputTensors.push_back(createTensor(memoryInfo, textCopy, textShape));
-        inputNameStrs.push_back("text_embeddings");
-        
-        // State inputs - in sorted order for consistency
-        std::vector<std::string> stateNames;
-        for (auto& [name, entry] : state) {
-            stateNames.push_back(name);
-        }
-        std::sort(stateNames.begin(), stateNames.end(), [](const std::string& a, const std::string& b) {
-            int idxA = std::stoi(a.substr(6));
-            int idxB = std::stoi(b.substr(6));
-            return idxA < idxB;
-        });
-        
-        for (const auto& name : stateNames) {
-            inputTensors.push_back(createStateValue(state[name]));
-            inputNameStrs.push_back(name);
-        }
-        
-        // Convert to const char*
-        for (const auto& name : inputNameStrs) {
-            inputNames.push_back(name.c_str());
-        }
-        
-        // Get output names
-        size_t numOutputs = flowLmMain->GetOutputCount();
-        std::vector<std::string> outputNameStrs;
-        std::vector<const char*> outputNames;
-        for (size_t i = 0; i < numOutputs; ++i) {
-            auto namePtr = flowLmMain->GetOutputNameAllocated(i, allocator);
-            outputNameStrs.push_back(namePtr.get());
-        }
-        for (const auto& name : outputNameStrs) {
-            outputNames.push_back(name.c_str());
-        }
+        // Sequence and text (or voice) embeddings, wrapped without copying
+        Ort::Value inputTensors[] = {
+            createInputTensor(memoryInfo, sequence, seqShape),
+            createInputTensor(memoryInfo, textEmb, textShape)
+        };
+        static const char* const inputNames[] = {"sequence", "text_embeddings"};
         
         // Run
-        auto outputs = flowLmMain->Run(
-            Ort::RunOptions{nullptr},
-            inputNames.data(), inputTensors.data(), inputTensors.size(),
-            outputNames.data(), outputNames.size()
-        );
+        auto outputs = runWithState(*flowLmMain, flowLmMainSig, inputNames, inputTensors, 2, state,
+                                    stats ? &stats->flowLmMain : nullptr,
+                                    stats ? &stats->stateBytesAllocated : nullptr);
         
         // Get conditioning (output 0)
         auto& condTensor = outputs[0];
-        auto condInfo = condTensor.GetTensorTypeAndShapeInfo();
-        size_t condSize = condInfo.GetElementCount();
-        float* condData = condTensor.GetTensorMutableData<float>();
-        std::vector<float> conditioning(condData, condData + condSize);
+        size_t condSize = condTensor.GetTensorTypeAndShapeInfo().GetElementCount();
+        const float* condData = condTensor.GetTensorData<float>();
+        conditioning.assign(condData, condData + condSize);
         
         // Get EOS logit (output 1)
-        float eosLogit = outputs[1].GetTensorMutableData<float>()[0];
-        
-        // Update state from outputs
-        for (size_t i = 2; i < outputs.size(); ++i) {
-            const std::string& outName = outputNameStrs[i];
-            if (outName.find("out_state_") == 0) {
-                int idx = std::stoi(outName.substr(10));
-                std::string stateName = "state_" + std::to_string(idx);
-                
-                if (state.find(stateName) != state.end()) {
-                    updateStateFromOutput(state[stateName], outputs[i]);
-                }
+        return outputs[1].GetTensorData<float>()[0];
+    }
+    
+    // Token ids and text embeddings of text, from the text cache when possible
+    std::shared_ptr<const TextConditioning> conditionText(const std::string& text, GenerationStats* stats) {
+        std::string normalized = Tokenizer::normalize(text);
+        if (textCache.enabled()) {
+            if (auto cached = textCache.find(normalized)) {
+                if (stats) stats->textCached = true;
+                return cached;
             }
         }
         
-        return {conditioning, eosLogit};
+        auto result = std::make_shared<TextConditioning>();
+        {
+            StageTimer timer(config.onStageTiming, Stage::Tokenize);
+            result->tokenIds = tokenizer->encodeNormalized(normalized);
+        }
+        result->embeddings = runTextConditioner(result->tokenIds, stats ? &stats->textConditioner : nullptr);
+        
+        if (textCache.enabled()) {
+            const size_t bytes = result->tokenIds.size() * sizeof(int64_t) +
+                                 result->embeddings.size() * sizeof(float) + sizeof(TextConditioning);
+            textCache.insert(normalized, result, bytes);
+        }
+        return result;
     }
     
-    // Run flow network for Euler integration
-    std::vector<float> runFlowLmFlow(
-        const std::vector<float>& conditioning,
-        float s, float t,
-        const std::vector<float>& x
+    // Tokenize, condition and run the voice and text passes through flow_lm_main
+    Utterance startUtterance(
+        const std::string& text,
+        const std::vector<float>& voiceEmb,
+        const std::vector<int64_t>& voiceShape
     ) {
-        std::vector<float> cCopy = conditioning;
-        std::vector<float> sCopy = {s};
-        std::vector<float> tCopy = {t};
-        std::vector<float> xCopy = x;
+        Utterance u;
         
-        std::vector<int64_t> cShape = {1, static_cast<int64_t>(conditioning.size())};
-        std::vector<int64_t> stShape = {1, 1};
-        std::vector<int64_t> xShape = {1, 32};
+        // Tokenize and get text embeddings
+        auto conditioning = conditionText(text, &u.stats);
+        const auto& tokenIds = conditioning->tokenIds;
+        const auto& textEmb = conditioning->embeddings;
+        u.stats.textTokens = static_cast<int>(tokenIds.size());
+        std::vector<int64_t> textShape = {1, static_cast<int64_t>(tokenIds.size()), 1024};
         
-        auto cTensor = createTensor(memoryInfo, cCopy, cShape);
-        auto sTensor = createTensor(memoryInfo, sCopy, stShape);
-        auto tTensor = createTensor(memoryInfo, tCopy, stShape);
-        auto xTensor = createTensor(memoryInfo, xCopy, xShape);
+        // Start from the voice-conditioned LM state (cached per voice)
+        u.lmState = cloneState(flowLmMainSig, *voicePrefix(voiceEmb, voiceShape, &u.stats),
+                               &u.stats.stateBytesAllocated);
         
-        std::vector<Ort::Value> inputs;
-        inputs.push_back(std::move(cTensor));
-        inputs.push_back(std::move(sTensor));
-        inputs.push_back(std::move(tTensor));
-        inputs.push_back(std::move(xTensor));
+        // Empty sequence for conditioning passes
+        std::vector<float> emptySeq;
+        std::vector<int64_t> emptySeqShape = {1, 0, 32};
         
-        const char* inputNames[] = {"c", "s", "t", "x"};
-        const char* outputNames[] = {"flow_dir"};
+        // Text conditioning pass
+        {
+            StageTimer timer(config.onStageTiming, Stage::TextPrefill);
+            runFlowLmMainStep(emptySeq, emptySeqShape, textEmb, textShape, u.lmState, u.conditioning, &u.stats);
+        }
         
-        auto outputs = flowLmFlow->Run(
-            Ort::RunOptions{nullptr},
-            inputNames, inputs.data(), 4,
-            outputNames, 1
-        );
+        if (config.contextWindowFrames > 0) {
+            // Keep the primed state to rebuild from; the live state reads it copy-on-write
+            u.primed = std::make_shared<const StateSnapshot>(snapshotState(u.lmState));
+            u.lmState = cloneState(flowLmMainSig, *u.primed, &u.stats.stateBytesAllocated);
+            u.history.reserve(static_cast<size_t>(config.contextWindowFrames));
+        }
+        u.stats.lmStateBytes = stateBytes(u.lmState);
         
-        auto& outTensor = outputs[0];
-        float* outData = outTensor.GetTensorMutableData<float>();
-        return std::vector<float>(outData, outData + 32);
+        return u;
+    }
+    
+    // Latents replayed after a re-prime, always fewer than the window
+    size_t contextKeepFrames() const {
+        const int window = config.contextWindowFrames;
+        const int keep = config.contextKeepFrames > 0 ? config.contextKeepFrames : window / 2;
+        return static_cast<size_t>(std::clamp(keep, 0, window - 1));
+    }
+    
+    // Rebuild the LM state of a full bounded context: the primed voice + text
+    // state followed by the most recent latents as one sequence pass
+    void reprime(Utterance& u) {
+        static const std::vector<float> emptyText;
+        static const std::vector<int64_t> emptyTextShape = {1, 0, 1024};
+        
+        const size_t keep = std::min(contextKeepFrames(), u.history.size());
+        u.history.dropFront(u.history.size() - keep);
+        u.lmState = cloneState(flowLmMainSig, *u.primed, &u.stats.stateBytesAllocated);
+        if (keep > 0) {
+            const std::vector<int64_t> seqShape = {1, static_cast<int64_t>(keep), static_cast<int64_t>(LATENT_DIM)};
+            std::vector<float> scratch;
+            runFlowLmMainStep(u.history.data, seqShape, emptyText, emptyTextShape, u.lmState, scratch, &u.stats);
+        }
+        ++u.stats.contextReprimes;
     }
     
-    // Decode latents to audio
-    std::vector<float> decodeLatents(const std::vector<std::vector<float>>& latents) {
-        if (latents.empty()) return {};
+    // Run the main step for the next frame. Returns false (and marks the
+    // utterance finished) once EOS plus framesAfterEos or maxFrames is reached.
+    bool advance(Utterance& u) {
+        // The tail after EOS is complete: stop before a main step whose
+        // conditioning would never be used
+        if (u.finished || u.step >= config.maxFrames ||
+            (u.eosStep >= 0 && u.step >= u.eosStep + config.framesAfterEos)) {
+            u.finished = true;
+            return false;
+        }
         
-        // Initialize decoder state
-        auto state = initState(*mimiDecoder);
+        StageTimer timer(config.onStageTiming, Stage::MainStep);
+        static const std::vector<int64_t> currentShape = {1, 1, static_cast<int64_t>(LATENT_DIM)};
+        static const std::vector<float> emptyText;
+        static const std::vector<int64_t> emptyTextShape = {1, 0, 1024};
         
-        std::vector<float> audioChunks;
-        const int chunkSize = 15;  // Frames per chunk
+        if (u.primed) {
+            if (u.history.size() >= static_cast<size_t>(config.contextWindowFrames)) {
+                reprime(u);
+            }
+            u.history.push(u.current);
+        }
+        
+        const float eosLogit = runFlowLmMainStep(
+            u.current, currentShape, emptyText, emptyTextShape, u.lmState, u.conditioning, &u.stats
+        );
+        u.stats.lmStateBytes = std::max<uint64_t>(u.stats.lmStateBytes, stateBytes(u.lmState));
+        
+        // Check EOS
+        if (eosLogit > -4.0f && u.eosStep < 0) {
+            u.eosStep = u.step;
+        }
+        
+        // EOS on this very frame with framesAfterEos = 0
+        if (u.eosStep >= 0 && u.step >= u.eosStep + config.framesAfterEos) {
+            u.finished = true;
+            return false;
+        }
+        
+        return true;
+    }
+    
+    // Feed the integrated latent back as the next step's input
+    void commitFrame(Utterance& u, const std::vector<float>& latent) {
+        std::copy(latent.begin(), latent.end(), u.current.begin());
+        ++u.step;
+        u.stats.framesGenerated = u.step;
+        u.stats.eosStep = u.eosStep;
+    }
+    
+    // Decode latents to audio, appending to `audio` (its storage is reused),
+    // continuing from an existing decoder state
+    void decodeLatents(const LatentFrames& latents, SessionState& state, std::vector<float>& audio,
+                       GenerationStats* stats = nullptr) {
+        audio.reserve(audio.size() + latents.size() * PocketTTS::SAMPLES_PER_FRAME);
+        decodeLatents(latents, state, [&audio](const float* samples, size_t count) {
+            audio.insert(audio.end(), samples, samples + count);
+        }, stats);
+    }
+    
+    // Decode latents, handing each decoder output straight to sink
+    size_t decodeLatents(const LatentFrames& latents, SessionState& state,
+                         const SampleSink& sink, GenerationStats* stats = nullptr) {
+        StageTimer timer(config.onStageTiming, Stage::Decode);
+        size_t total = 0;
+        const size_t chunkSize = DECODE_GROUP_FRAMES;
+        static const char* const inputNames[] = {"latent"};
         
         for (size_t i = 0; i < latents.size(); i += chunkSize) {
-            size_t end = std::min(i + chunkSize, latents.size());
-            size_t numFrames = end - i;
-            
-            // Combine frames: [1, numFrames, 32]
-            std::vector<float> chunk(numFrames * 32);
-            for (size_t j = 0; j < numFrames; ++j) {
-                std::copy(latents[i + j].begin(), latents[i + j].end(), 
-                          chunk.begin() + j * 32);
-            }
-            
-            std::vector<int64_t> chunkShape = {1, static_cast<int64_t>(numFrames), 32};
+            const size_t numFrames = std::min(chunkSize, latents.size() - i);
             
-            // Build inputs
-            Ort::AllocatorWithDefaultOptions allocator;
-            std::vector<Ort::Value> inputTensors;
-            std::vector<const char*> inputNames;
-            std::vector<std::string> inputNameStrs;
-            
-            inputTensors.push_back(createTensor(memoryInfo, chunk, chunkShape));
-            inputNameStrs.push_back("latent");
-            
-            // State inputs in sorted order
-            std::vector<std::string> stateNames;
-            for (auto& [name, entry] : state) {
-                stateNames.push_back(name);
-            }
-            std::sort(stateNames.begin(), stateNames.end(), [](const std::string& a, const std::string& b) {
-                int idxA = std::stoi(a.substr(6));
-                int idxB = std::stoi(b.substr(6));
-                return idxA < idxB;
-            });
-            
-            for (const auto& name : stateNames) {
-                inputTensors.push_back(createStateValue(state[name]));
-                inputNameStrs.push_back(name);
-            }
-            
-            for (const auto& name : inputNameStrs) {
-                inputNames.push_back(name.c_str());
-            }
-            
-            // Get output names
-            size_t numOutputs = mimiDecoder->GetOutputCount();
-            std::vector<std::string> outputNameStrs;
-            std::vector<const char*> outputNames;
-            for (size_t o = 0; o < numOutputs; ++o) {
-                auto namePtr = mimiDecoder->GetOutputNameAllocated(o, allocator);
-                outputNameStrs.push_back(namePtr.get());
-            }
-            for (const auto& name : outputNameStrs) {
-                outputNames.push_back(name.c_str());
-            }
+            // Frames are contiguous, so [1, numFrames, 32] is a view of the buffer
+            const int64_t chunkShape[] = {1, static_cast<int64_t>(numFrames), static_cast<int64_t>(LATENT_DIM)};
+            Ort::Value chunk = Ort::Value::CreateTensor<float>(
+                memoryInfo, const_cast<float*>(latents.frame(i)), numFrames * LATENT_DIM, chunkShape, 3);
             
             // Run decoder
-            auto outputs = mimiDecoder->Run(
-                Ort::RunOptions{nullptr},
-                inputNames.data(), inputTensors.data(), inputTensors.size(),
-                outputNames.data(), outputNames.size()
-            );
+            auto outputs = runWithState(*mimiDecoder, mimiDecoderSig, inputNames, &chunk, 1, state,
+                                        stats ? &stats->mimiDecoder : nullptr,
+                                        stats ? &stats->stateBytesAllocated : nullptr);
             
             // Get audio output
             auto& audioTensor = outputs[0];
             auto audioInfo = audioTensor.GetTensorTypeAndShapeInfo();
             size_t audioSize = audioInfo.GetElementCount();
-            float* audioData = audioTensor.GetTensorMutableData<float>();
-            audioChunks.insert(audioChunks.end(), audioData, audioData + audioSize);
-            
-            // Update state
-            for (size_t k = 1; k < outputs.size(); ++k) {
-                const std::string& outName = outputNameStrs[k];
-                if (outName.find("out_state_") == 0) {
-                    int idx = std::stoi(outName.substr(10));
-                    std::string stateName = "state_" + std::to_string(idx);
-                    
-                    if (state.find(stateName) != state.end()) {
-                        updateStateFromOutput(state[stateName], outputs[k]);
-                    }
-                }
-            }
+            sink(audioTensor.GetTensorData<float>(), audioSize);
+            total += audioSize;
         }
         
-        return audioChunks;
+        return total;
     }
+};
+
+// ── PocketTTSModel ─────────────────────────────────────────────────────
+
+PocketTTSModel::PocketTTSModel(const PocketTTSConfig& config)
+    : impl_(std::make_unique<Impl>(config)) {}
+
+PocketTTSModel::~PocketTTSModel() = default;
+
+std::shared_ptr<PocketTTSModel> PocketTTSModel::load(const PocketTTSConfig& config) {
+    return std::make_shared<PocketTTSModel>(config);
+}
+
+const PocketTTSConfig& PocketTTSModel::config() const {
+    return impl_->config;
+}
+
+std::vector<float> PocketTTSModel::encodeVoice(const std::string& audioPath) const {
+    return impl_->encodeVoice(audioPath);
+}
+
+VoiceEmbedding PocketTTSModel::encodeVoiceEmbedding(const std::string& audioPath) const {
+    return impl_->encodeVoiceEmbedding(audioPath);
+}
+
+VoiceEmbedding PocketTTSModel::encodeVoiceFromSamples(const float* samples, size_t count, int sampleRate) const {
+    return impl_->encodeVoiceFromSamples(samples, count, sampleRate);
+}
+
+void PocketTTSModel::saveVoicePrefix(const VoiceEmbedding& voice, const std::string& path) const {
+    impl_->saveVoicePrefix(voice, path);
+}
+
+void PocketTTSModel::loadVoicePrefix(const std::string& path) const {
+    impl_->loadVoicePrefix(path);
+}
+
+CacheStats PocketTTSModel::cacheStats() const {
+    CacheStats stats;
+    stats.text = impl_->textCache.counters();
+    stats.audio = impl_->audioCache.counters();
+    return stats;
+}
+
+void PocketTTSModel::prefetch(
+    const std::string& text,
+    const std::vector<float>& voiceEmbeddings,
+    const std::vector<int64_t>& voiceEmbeddingShape
+) const {
+    impl_->conditionText(text, nullptr);
+    impl_->voicePrefix(voiceEmbeddings, voiceEmbeddingShape);
+}
+
+void PocketTTSModel::clearCaches() const {
+    impl_->textCache.clear();
+    impl_->audioCache.clear();
+}
+
+MemoryUsage PocketTTSModel::memoryUsage() const {
+    MemoryUsage usage;
+    const ProcessMemory process = processMemory();
+    usage.residentBytes = process.resident;
+    usage.peakResidentBytes = process.peakResident;
+    usage.modelFileBytes = impl_->modelFileBytes.load();
+    {
+        std::lock_guard<std::mutex> lock(impl_->voiceCacheMutex);
+        usage.voiceCacheBytes = impl_->voiceCacheUsed;
+    }
+    {
+        std::lock_guard<std::mutex> lock(impl_->voicePrefixMutex);
+        for (const auto& [key, entry] : impl_->voicePrefixCache) {
+            for (const auto& tensor : *entry.first) {
+                auto info = tensor->GetTensorTypeAndShapeInfo();
+                usage.voiceCacheBytes += info.GetElementCount() * elementSize(info.GetElementType());
+            }
+        }
+    }
+    usage.textCacheBytes = impl_->textCache.counters().bytes;
+    usage.audioCacheBytes = impl_->audioCache.counters().bytes;
+    return usage;
+}
+
+// ── PocketTTS (generation context) ─────────────────────────────────────
+
+struct PocketTTS::Impl {
+    // Shared, read-only model
+    std::shared_ptr<PocketTTSModel> model;
+    PocketTTSModel::Impl& m;
+    const PocketTTSConfig& config;
     
-    std::vector<float> generate(const std::string& text, const std::string& voicePath) {
-        auto start = std::chrono::high_resolution_clock::now();
+    // One decoded chunk; samples are valid only during the sink call
+    struct DecodedChunk {
+        const float* samples = nullptr;
+        size_t count = 0;
+        size_t frames = 0;  // Latent frames it was decoded from
+        bool isFinal = false;
+        float decodeMs = 0.0f;
+    };
+    
+    // Incremental mimi_decoder shared by every generation mode. Owns the
+    // persistent decoder state, the pending latents and the output buffer,
+    // and decodes each chunk inline or on a DecodeWorker thread. Chunks reach
+    // the sink in order, on whichever thread decodes.
+    class StreamingDecoder {
+    public:
+        using Sink = std::function<void(const DecodedChunk&)>;
+        
+        struct Options {
+            size_t chunkFrames = DECODE_GROUP_FRAMES;  // push() flushes at this many latents
+            size_t queueDepth = 0;                     // > 0: decoder thread with this many chunks in flight
+            std::function<bool()> cancelled;           // Chunks still pending once true are dropped; a final one arrives empty
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();  // For time to first audio
+        };
+        
+        StreamingDecoder(PocketTTSModel::Impl& model, Sink sink, Options options)
+            : m_(model), sink_(std::move(sink)), options_(std::move(options)),
+              state_(model.initState(model.mimiDecoderSig)) {
+            options_.chunkFrames = std::max<size_t>(1, options_.chunkFrames);
+            pending_.latents.reserve(options_.chunkFrames);
+            if (options_.queueDepth > 0) {
+                worker_ = std::make_unique<DecodeWorker>(options_.queueDepth, [this](DecodeJob& job) { decode(job); });
+            }
+        }
         
-        // Get voice embeddings
-        auto voiceEmb = encodeVoice(voicePath);
-        auto voiceShape = voiceCache[voicePath].second;
+        StreamingDecoder(const StreamingDecoder&) = delete;
+        StreamingDecoder& operator=(const StreamingDecoder&) = delete;
         
-        // Tokenize text
-        auto tokenIds = tokenizer->encode(text);
+        /// Queue one latent frame without decoding
+        void append(const std::vector<float>& latent) { pending_.latents.push(latent); }
         
-        // Get text embeddings
-        auto textEmb = runTextConditioner(tokenIds);
-        std::vector<int64_t> textShape = {1, static_cast<int64_t>(tokenIds.size()), 1024};
+        /// Queue one latent frame and flush once chunkFrames are pending or on
+        /// the last frame; false once the decoder thread has failed
+        bool push(const std::vector<float>& latent, bool isFinal = false) {
+            append(latent);
+            if (pending_.latents.size() < options_.chunkFrames && !isFinal) return true;
+            return flush(isFinal);
+        }
         
-        // Initialize flow LM state
-        auto lmState = initState(*flowLmMain);
+        /// Decode the pending latents; with none, only a first final flush
+        /// reaches the sink (as an empty final chunk). False once the decoder
+        /// thread has failed, finish() then rethrows its error
+        bool flush(bool isFinal = false) {
+            if (pending_.latents.empty() && (!isFinal || finalQueued_)) return true;
+            finalQueued_ = finalQueued_ || isFinal;
+            pending_.isFinal = isFinal;
+            if (!worker_) {
+                decode(pending_);
+                pending_.latents.clear();  // Keeps the buffer for the next chunk
+                return true;
+            }
+            if (!worker_->submit(std::move(pending_))) return false;
+            pending_ = DecodeJob{};
+            pending_.latents.reserve(options_.chunkFrames);
+            return true;
+        }
         
-        // Empty tensors for conditioning passes
-        std::vector<float> emptySeq;
-        std::vector<int64_t> emptySeqShape = {1, 0, 32};
-        std::vector<float> emptyText;
-        std::vector<int64_t> emptyTextShape = {1, 0, 1024};
+        /// End a cancelled request: drop the pending latents and send only an
+        /// empty final chunk (unless one was already queued), so consumers
+        /// waiting for isFinal terminate
+        bool cancel() {
+            pending_.latents.clear();
+            return flush(true);
+        }
         
-        // Voice conditioning pass
-        auto [_, __] = runFlowLmMainStep(emptySeq, emptySeqShape, voiceEmb, voiceShape, lmState);
+        /// Wait for the decoder thread to drain; rethrows a decode or sink error
+        void finish() {
+            if (worker_) worker_->finish();
+        }
         
-        // Text conditioning pass
-        std::tie(_, __) = runFlowLmMainStep(emptySeq, emptySeqShape, textEmb, textShape, lmState);
+        size_t pending() const { return pending_.latents.size(); }
         
-        // Autoregressive generation
-        std::vector<std::vector<float>> allLatents;
-        std::vector<float> current(32, std::nanf(""));
-        std::vector<int64_t> currentShape = {1, 1, 32};
+        /// Samples decoded so far (after finish() when threaded)
+        size_t samples() const { return samples_; }
         
-        float dt = 1.0f / config.lsdSteps;
-        int eosStep = -1;
+        /// Add the decoder-side counters to a request's stats (after finish())
+        void mergeStats(GenerationStats& stats) const {
+            stats.mimiDecoder = stats_.mimiDecoder;
+            stats.stateBytesAllocated += stats_.stateBytesAllocated;
+            if (stats.timeToFirstAudioMs <= 0.0) stats.timeToFirstAudioMs = stats_.timeToFirstAudioMs;
+        }
+    
+    private:
+        void decode(DecodeJob& job) {
+            if (options_.cancelled && options_.cancelled()) {
+                // Skip the decode but still end the stream
+                if (job.isFinal) {
+                    DecodedChunk chunk;
+                    chunk.isFinal = true;
+                    sink_(chunk);
+                }
+                return;
+            }
+            auto decodeStart = std::chrono::steady_clock::now();
+            audio_.clear();
+            m_.decodeLatents(job.latents, state_, audio_, &stats_);
+            auto decoded = std::chrono::steady_clock::now();
+            if (stats_.timeToFirstAudioMs <= 0.0 && !audio_.empty()) {
+                stats_.timeToFirstAudioMs = std::chrono::duration<double, std::milli>(decoded - options_.start).count();
+            }
+            samples_ += audio_.size();
+            
+            DecodedChunk chunk;
+            chunk.samples = audio_.data();
+            chunk.count = audio_.size();
+            chunk.frames = job.latents.size();
+            chunk.isFinal = job.isFinal;
+            chunk.decodeMs = std::chrono::duration<float, std::milli>(decoded - decodeStart).count();
+            sink_(chunk);
+        }
         
-        if (config.verbose) {
-            std::cout << "Generating latents..." << std::flush;
+        PocketTTSModel::Impl& m_;
+        Sink sink_;
+        Options options_;
+        
+        // Only touched by the thread that decodes
+        SessionState state_;
+        std::vector<float> audio_;  // Reused across chunks
+        GenerationStats stats_;     // Decoder-side counters
+        size_t samples_ = 0;
+        
+        DecodeJob pending_;  // Producer side
+        bool finalQueued_ = false;
+        std::unique_ptr<DecodeWorker> worker_;  // Last: joined before the rest is torn down
+    };
+    
+    // flow_lm_flow tensors created once over persistent buffers and reused for
+    // every solver step; only the s/t scalars and x change between runs.
+    struct FlowBinding {
+        std::vector<float> c;
+        float s = 0.0f;
+        float t = 0.0f;
+        std::vector<float> x = std::vector<float>(LATENT_DIM, 0.0f);
+        std::vector<float> flowDir = std::vector<float>(LATENT_DIM, 0.0f);
+        std::vector<float> x0 = std::vector<float>(LATENT_DIM, 0.0f);  // Heun: start of the step
+        std::vector<float> k1 = std::vector<float>(LATENT_DIM, 0.0f);  // Heun: predictor slope
+        std::vector<float> sSteps;  // Fused graph: all step start times
+        std::vector<float> tSteps;  // Fused graph: all step end times
+        const FlowSteps* boundSteps = nullptr;  // Fused graph: schedule in sSteps/tSteps
+        std::vector<int64_t> cShape;
+        std::vector<int64_t> stShape = {1, 1};
+        std::vector<int64_t> xShape = {1, static_cast<int64_t>(LATENT_DIM)};
+        std::vector<int64_t> stepsShape;
+        std::vector<Ort::Value> inputs;
+        Ort::Value output{nullptr};
+    };
+    FlowBinding flowBinding;
+    
+    // Reused buffers of integrateFlowBatch
+    struct BatchFlowScratch {
+        std::vector<float> c, s, t, x, flowDir, x0, k1;
+    };
+    BatchFlowScratch batchFlowScratch;
+    
+    // Integrator settings of this context and their time grids, rebuilt by
+    // setFlowConfig(); tailSteps is used once EOS has been detected
+    FlowConfig flow;
+    FlowSteps flowSteps;
+    FlowSteps tailSteps;
+    
+    // Cancellation flag for streaming
+    std::atomic<bool> cancelRequested{false};
+    // Long-form workers: the calling context's flag, checked every frame
+    const std::atomic<bool>* parentCancel = nullptr;
+    
+    // Progress logging of generate(); off for long-form worker contexts
+    bool verbose;
+    
+    // generate() decodes on a second thread; off for long-form workers,
+    // which already run one segment per core
+    bool overlapDecode;
+    
+    // Noise seed of the following requests (< 0 = a fresh one per request,
+    // drawn from seedSource). The noise itself is counter-based, so no
+    // generator state is shared between requests or threads.
+    int64_t seed;
+    std::mt19937_64 seedSource{std::random_device{}()};
+    
+    // Stats of the latest request on this context; reportStats forwards them
+    // to onGenerationStats (off for long-form workers, which report in total)
+    GenerationStats lastStats;
+    bool reportStats = true;
+    
+    // Utterance prefilled by prefetch(), taken by the next matching request.
+    // Declared last so a pending prefill finishes before anything it uses
+    // is destroyed.
+    struct Prefetch {
+        std::string text;
+        uint64_t voiceKey = 0;
+        std::future<Utterance> utterance;
+    };
+    Prefetch prefetched;
+    std::mutex prefetchMutex;
+    
+    explicit Impl(std::shared_ptr<PocketTTSModel> sharedModel)
+        : model(std::move(sharedModel)), m(*model->impl_), config(m.config), verbose(config.verbose),
+          overlapDecode(config.overlapDecode), seed(config.seed) {
+        setFlowConfig(config.flow);
+    }
+    
+    // Conditioning passes of a request, or the prefetched utterance if it
+    // was prepared for the same text and voice
+    Utterance beginUtterance(const std::string& text, const std::vector<float>& voiceEmb,
+                             const std::vector<int64_t>& voiceShape) {
+        Prefetch pending;
+        {
+            std::lock_guard<std::mutex> lock(prefetchMutex);
+            pending = std::move(prefetched);
+            prefetched = Prefetch{};
+        }
+        if (pending.utterance.valid() && pending.text == text &&
+            pending.voiceKey == PocketTTSModel::Impl::hashEmbeddings(voiceEmb, voiceShape)) {
+            Utterance u = pending.utterance.get();
+            u.stats.prefetched = true;
+            return u;
+        }
+        return m.startUtterance(text, voiceEmb, voiceShape);
+    }
+    
+    // Finish a request's stats: store them for lastStats() and report them
+    void publishStats(GenerationStats stats, std::chrono::steady_clock::time_point start) {
+        stats.totalMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        if (stats.timeToFirstAudioMs <= 0.0) {
+            stats.timeToFirstAudioMs = stats.totalMs;
+        }
+        lastStats = stats;
+        if (reportStats && config.onGenerationStats) {
+            config.onGenerationStats(lastStats);
+        }
+    }
+    
+    void setFlowConfig(const FlowConfig& cfg) {
+        flow = cfg;
+        const int steps = flow.steps > 0 ? flow.steps : std::max(1, config.lsdSteps);
+        flowSteps = makeFlowSteps(flow.schedule, steps);
+        tailSteps = flow.postEosSteps > 0 ? makeFlowSteps(flow.schedule, flow.postEosSteps) : flowSteps;
+        flowBinding.boundSteps = nullptr;
+    }
+    
+    // Schedule for the utterance's next frame: fewer steps in the tail after EOS
+    const FlowSteps& stepsFor(const Utterance& u) const {
+        return u.eosStep >= 0 ? tailSteps : flowSteps;
+    }
+    
+    // (Re)create the bound flow tensors when the conditioning size or, for
+    // the fused graph, the schedule changes
+    void bindFlow(size_t condSize, const FlowSteps& steps) {
+        auto& fb = flowBinding;
+        if (!fb.inputs.empty() && fb.c.size() == condSize &&
+            (!m.flowLmFlowFused || fb.boundSteps == &steps)) {
+            return;
         }
         
-        for (int step = 0; step < config.maxFrames; ++step) {
-            // Run main model
-            auto [conditioning, eosLogit] = runFlowLmMainStep(
-                current, currentShape, emptyText, emptyTextShape, lmState
+        fb.c.assign(condSize, 0.0f);
+        fb.cShape = {1, static_cast<int64_t>(condSize)};
+        fb.inputs.clear();
+        fb.inputs.push_back(createTensor(m.memoryInfo, fb.c, fb.cShape));
+        
+        if (m.flowLmFlowFused) {
+            fb.sSteps.clear();
+            fb.tSteps.clear();
+            for (const auto& [s, t] : steps) {
+                fb.sSteps.push_back(s);
+                fb.tSteps.push_back(t);
+            }
+            fb.boundSteps = &steps;
+            fb.stepsShape = {static_cast<int64_t>(steps.size())};
+            fb.inputs.push_back(createTensor(m.memoryInfo, fb.x, fb.xShape));
+            fb.inputs.push_back(createTensor(m.memoryInfo, fb.sSteps, fb.stepsShape));
+            fb.inputs.push_back(createTensor(m.memoryInfo, fb.tSteps, fb.stepsShape));
+        } else {
+            fb.inputs.push_back(Ort::Value::CreateTensor<float>(
+                m.memoryInfo, &fb.s, 1, fb.stShape.data(), fb.stShape.size()));
+            fb.inputs.push_back(Ort::Value::CreateTensor<float>(
+                m.memoryInfo, &fb.t, 1, fb.stShape.data(), fb.stShape.size()));
+            fb.inputs.push_back(createTensor(m.memoryInfo, fb.x, fb.xShape));
+        }
+        fb.output = createTensor(m.memoryInfo, fb.flowDir, fb.xShape);
+    }
+    
+    // Integrate the flow of the utterance's next frame over `steps` from the
+    // noise in u.latent (in place), using the fused graph or one
+    // flow_lm_flow run per Euler step (two per Heun step).
+    void integrateFlow(Utterance& u, const FlowSteps& steps) {
+        StageTimer timer(config.onStageTiming, Stage::Flow);
+        bindFlow(u.conditioning.size(), steps);
+        auto& fb = flowBinding;
+        SessionStats* runStats = &u.stats.flowLmFlow;
+        std::copy(u.conditioning.begin(), u.conditioning.end(), fb.c.begin());
+        std::copy(u.latent.begin(), u.latent.end(), fb.x.begin());
+        
+        if (m.flowLmFlowFused) {
+            // The unrolled graph runs its own Euler loop over the schedule
+            const char* inputNames[] = {"c", "x", "s", "t"};
+            const char* outputNames[] = {"x_out"};
+            RunTimer runTimer(runStats);
+            m.flowLmFlowFused->Run(
+                m.runOptions,
+                inputNames, fb.inputs.data(), 4,
+                outputNames, &fb.output, 1
             );
-            
-            // Check EOS
-            if (eosLogit > -4.0f && eosStep < 0) {
-                eosStep = step;
+            std::copy(fb.flowDir.begin(), fb.flowDir.end(), u.latent.begin());
+            return;
+        }
+        
+        const char* inputNames[] = {"c", "s", "t", "x"};
+        const char* outputNames[] = {"flow_dir"};
+        // flow_dir = mean velocity over [s, t] from fb.x; s == t gives the
+        // instantaneous velocity at s
+        auto evaluate = [&](float s, float t) {
+            fb.s = s;
+            fb.t = t;
+            RunTimer runTimer(runStats);
+            m.flowLmFlow->Run(
+                m.runOptions,
+                inputNames, fb.inputs.data(), 4,
+                outputNames, &fb.output, 1
+            );
+        };
+        
+        for (const auto& [s, t] : steps) {
+            const float h = t - s;
+            if (flow.solver == FlowSolver::Heun) {
+                // Trapezoidal step on the instantaneous velocity: predict the
+                // endpoint, then average the slopes at both ends
+                evaluate(s, s);
+                for (size_t k = 0; k < LATENT_DIM; ++k) {
+                    fb.x0[k] = fb.x[k];
+                    fb.k1[k] = fb.flowDir[k];
+                    fb.x[k] += fb.flowDir[k] * h;
+                }
+                evaluate(t, t);
+                for (size_t k = 0; k < LATENT_DIM; ++k) {
+                    fb.x[k] = fb.x0[k] + 0.5f * h * (fb.k1[k] + fb.flowDir[k]);
+                }
+            } else {
+                evaluate(s, t);  // Shortcut step along the mean velocity
+                for (size_t k = 0; k < LATENT_DIM; ++k) {
+                    fb.x[k] += fb.flowDir[k] * h;
+                }
             }
-            
-            // Stop after frames_after_eos
-            if (eosStep >= 0 && step >= eosStep + config.framesAfterEos) {
+        }
+        std::copy(fb.x.begin(), fb.x.end(), u.latent.begin());
+    }
+    
+    // Batched counterpart of integrateFlow over each utterance's `latent`:
+    // one flow_lm_flow run per solver evaluation for all utterances at once
+    // when the graph has a dynamic batch dim. Utterances in their post-EOS
+    // tail keep the full schedule so the batch stays in lockstep; the
+    // per-utterance fallback does too, so batch size never changes output.
+    void integrateFlowBatch(const std::vector<Utterance*>& utterances) {
+        const size_t batch = utterances.size();
+        if (batch < 2 || !m.flowBatchable || m.flowLmFlowFused) {
+            for (size_t b = 0; b < batch; ++b) {
+                integrateFlow(*utterances[b], flowSteps);  // Same schedule as a batched run
+            }
+            return;
+        }
+        
+        StageTimer timer(config.onStageTiming, Stage::Flow);
+        const size_t condSize = utterances[0]->conditioning.size();
+        const size_t latentSize = batch * LATENT_DIM;
+        auto& bs = batchFlowScratch;  // Grows to the largest batch, then reused
+        bs.c.resize(batch * condSize);
+        bs.s.resize(batch);
+        bs.t.resize(batch);
+        bs.x.resize(latentSize);
+        bs.flowDir.resize(latentSize);
+        bs.x0.resize(latentSize);
+        bs.k1.resize(latentSize);
+        for (size_t b = 0; b < batch; ++b) {
+            std::copy(utterances[b]->conditioning.begin(), utterances[b]->conditioning.end(),
+                      bs.c.begin() + b * condSize);
+            std::copy(utterances[b]->latent.begin(), utterances[b]->latent.end(), bs.x.begin() + b * LATENT_DIM);
+        }
+        
+        const int64_t cShape[] = {static_cast<int64_t>(batch), static_cast<int64_t>(condSize)};
+        const int64_t stShape[] = {static_cast<int64_t>(batch), 1};
+        const int64_t xShape[] = {static_cast<int64_t>(batch), static_cast<int64_t>(LATENT_DIM)};
+        
+        Ort::Value inputs[] = {
+            Ort::Value::CreateTensor<float>(m.memoryInfo, bs.c.data(), bs.c.size(), cShape, 2),
+            Ort::Value::CreateTensor<float>(m.memoryInfo, bs.s.data(), bs.s.size(), stShape, 2),
+            Ort::Value::CreateTensor<float>(m.memoryInfo, bs.t.data(), bs.t.size(), stShape, 2),
+            Ort::Value::CreateTensor<float>(m.memoryInfo, bs.x.data(), bs.x.size(), xShape, 2)
+        };
+        auto output = Ort::Value::CreateTensor<float>(m.memoryInfo, bs.flowDir.data(), bs.flowDir.size(), xShape, 2);
+        
+        const char* inputNames[] = {"c", "s", "t", "x"};
+        const char* outputNames[] = {"flow_dir"};
+        SessionStats batchRuns;
+        auto evaluate = [&](float s, float t) {
+            std::fill(bs.s.begin(), bs.s.end(), s);
+            std::fill(bs.t.begin(), bs.t.end(), t);
+            RunTimer runTimer(&batchRuns);
+            m.flowLmFlow->Run(
+                m.runOptions,
+                inputNames, inputs, 4,
+                outputNames, &output, 1
+            );
+        };
+        
+        for (const auto& [s, t] : flowSteps) {
+            const float h = t - s;
+            if (flow.solver == FlowSolver::Heun) {
+                evaluate(s, s);
+                for (size_t k = 0; k < latentSize; ++k) {
+                    bs.x0[k] = bs.x[k];
+                    bs.k1[k] = bs.flowDir[k];
+                    bs.x[k] += bs.flowDir[k] * h;
+                }
+                evaluate(t, t);
+                for (size_t k = 0; k < latentSize; ++k) {
+                    bs.x[k] = bs.x0[k] + 0.5f * h * (bs.k1[k] + bs.flowDir[k]);
+                }
+            } else {
+                evaluate(s, t);
+                for (size_t k = 0; k < latentSize; ++k) {
+                    bs.x[k] += bs.flowDir[k] * h;
+                }
+            }
+        }
+        
+        for (size_t b = 0; b < batch; ++b) {
+            std::copy(bs.x.begin() + b * LATENT_DIM, bs.x.begin() + (b + 1) * LATENT_DIM, utterances[b]->latent.begin());
+            utterances[b]->stats.flowLmFlow.runs += batchRuns.runs;
+            utterances[b]->stats.flowLmFlow.totalMs += batchRuns.totalMs;
+        }
+    }
+    
+    // Everything a deterministic result depends on besides the model itself;
+    // the seed only matters when there is noise
+    std::string audioCacheKey(
+        const std::string& text,
+        const std::vector<float>& voiceEmb,
+        const std::vector<int64_t>& voiceShape,
+        uint64_t noiseSeed
+    ) const {
+        std::string key = Tokenizer::normalize(text);
+        char settings[128];
+        std::snprintf(settings, sizeof(settings), "|%016llx|%d|%d|%d|%d|%016llx",
+                      static_cast<unsigned long long>(PocketTTSModel::Impl::hashEmbeddings(voiceEmb, voiceShape)),
+                      static_cast<int>(flow.solver), static_cast<int>(flow.schedule),
+                      static_cast<int>(flowSteps.size()), static_cast<int>(tailSteps.size()),
+                      static_cast<unsigned long long>(config.temperature > 0.0f ? noiseSeed : 0));
+        key += settings;
+        if (config.temperature > 0.0f) {
+            key += "|" + std::to_string(config.temperature);
+        }
+        return key;
+    }
+    
+    // Seed of a request: requested if >= 0, else this context's seed, else
+    // a fresh one (63 bits, so it can be passed back to setSeed)
+    uint64_t resolveSeed(int64_t requested) {
+        if (requested >= 0) return static_cast<uint64_t>(requested);
+        if (seed >= 0) return static_cast<uint64_t>(seed);
+        return seedSource() >> 1;
+    }
+    
+    // Starting noise of the utterance's current frame
+    void sampleNoise(Utterance& u) {
+        if (config.temperature > 0) {
+            FrameNoise::fill(u.noiseSeed, static_cast<uint64_t>(u.step), std::sqrt(config.temperature),
+                             u.latent.data(), u.latent.size());
+        } else {
+            std::fill(u.latent.begin(), u.latent.end(), 0.0f);
+        }
+    }
+    
+    std::vector<float> generate(
+        const std::string& text,
+        const std::vector<float>& voiceEmb,
+        const std::vector<int64_t>& voiceShape,
+        int64_t requestSeed = -1
+    ) {
+        std::vector<float> audio;
+        generate(text, voiceEmb, voiceShape, [&audio](const float* samples, size_t count) {
+            audio.insert(audio.end(), samples, samples + count);
+        }, requestSeed);
+        return audio;
+    }
+    
+    // Core of generate(). Every DECODE_GROUP_FRAMES latents go to
+    // mimi_decoder as soon as they exist (the same groups a decode after the
+    // loop would use, so the audio is identical); with overlapDecode that
+    // happens on a decoder thread while the LM keeps stepping. sink is
+    // called from that thread, in order.
+    size_t generate(
+        const std::string& text,
+        const std::vector<float>& voiceEmb,
+        const std::vector<int64_t>& voiceShape,
+        const SampleSink& sink,
+        int64_t requestSeed = -1
+    ) {
+        auto start = std::chrono::high_resolution_clock::now();
+        auto statsStart = std::chrono::steady_clock::now();
+        const bool seeded = requestSeed >= 0 || seed >= 0;
+        const uint64_t noiseSeed = resolveSeed(requestSeed);
+        
+        // At temperature 0 or with a fixed seed the result is a function of
+        // text, voice, flow settings and seed, so a repeated request is
+        // replayed from the audio cache
+        std::string memoKey;
+        std::vector<float> memoAudio;
+        if (m.audioCache.enabled() && (config.temperature <= 0.0f || seeded)) {
+            memoKey = audioCacheKey(text, voiceEmb, voiceShape, noiseSeed);
+            if (auto cached = m.audioCache.find(memoKey)) {
+                sink(cached->data(), cached->size());
+                GenerationStats stats;
+                stats.audioCached = true;
+                stats.seed = noiseSeed;
+                stats.audioSamples = static_cast<int>(cached->size());
+                publishStats(std::move(stats), statsStart);
+                return cached->size();
+            }
+        }
+        SampleSink memoSink;
+        if (!memoKey.empty()) {
+            memoSink = [&](const float* samples, size_t count) {
+                memoAudio.insert(memoAudio.end(), samples, samples + count);
+                sink(samples, count);
+            };
+        }
+        const SampleSink& output = memoKey.empty() ? sink : memoSink;
+        
+        // Voice and text conditioning passes
+        auto u = beginUtterance(text, voiceEmb, voiceShape);
+        u.noiseSeed = noiseSeed;
+        u.stats.seed = noiseSeed;
+        
+        // With overlapDecode the decoder runs on its own thread
+        StreamingDecoder::Options decodeOptions;
+        decodeOptions.queueDepth = overlapDecode ? 4 : 0;
+        decodeOptions.start = statsStart;
+        StreamingDecoder decoder(m, [&output](const DecodedChunk& chunk) {
+            output(chunk.samples, chunk.count);
+        }, std::move(decodeOptions));
+        
+        if (verbose) {
+            std::cout << "Generating..." << std::flush;
+        }
+        
+        while (m.advance(u)) {
+            if (parentCancel && parentCancel->load(std::memory_order_relaxed)) {
+                u.stats.cancelled = true;
                 break;
             }
             
             // Flow matching with Euler integration
-            std::vector<float> x(32);
-            if (config.temperature > 0) {
-                float stddev = std::sqrt(config.temperature);
-                std::normal_distribution<float> dist(0.0f, stddev);
-                for (auto& val : x) {
-                    val = dist(rng);
-                }
-            }
+            sampleNoise(u);
+            integrateFlow(u, stepsFor(u));
             
-            for (int j = 0; j < config.lsdSteps; ++j) {
-                float s = stBuffers[j].first;
-                float t = stBuffers[j].second;
-                auto flowOut = runFlowLmFlow(conditioning, s, t, x);
-                for (size_t k = 0; k < 32; ++k) {
-                    x[k] += flowOut[k] * dt;
-                }
+            m.commitFrame(u, u.latent);
+            if (!decoder.push(u.latent)) {
+                break;  // Decoder thread failed; finish() rethrows
             }
             
-            allLatents.push_back(x);
-            current = x;
-            
-            if ((step + 1) % 10 == 0 && config.verbose) {
+            if (u.step % 10 == 0 && verbose) {
                 std::cout << "." << std::flush;
             }
         }
         
-        if (config.verbose) {
-            std::cout << " " << allLatents.size() << " frames" << std::endl;
-        }
-        
-        // Decode to audio
-        if (config.verbose) {
-            std::cout << "Decoding audio..." << std::flush;
+        decoder.flush();
+        decoder.finish();
+        
+        if (verbose) {
+            std::cout << " " << u.step << " frames" << std::endl;
         }
-        auto audio = decodeLatents(allLatents);
-        if (config.verbose) {
-            std::cout << " done" << std::endl;
+        
+        decoder.mergeStats(u.stats);
+        const size_t total = decoder.samples();
+        u.stats.audioSamples = static_cast<int>(total);
+        publishStats(std::move(u.stats), statsStart);
+        
+        if (!memoKey.empty() && !lastStats.cancelled) {
+            const size_t bytes = memoAudio.size() * sizeof(float);
+            m.audioCache.insert(memoKey, std::make_shared<const std::vector<float>>(std::move(memoAudio)), bytes);
         }
         
         auto end = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
         
-        float audioDuration = static_cast<float>(audio.size()) / SAMPLE_RATE;
+        float audioDuration = static_cast<float>(total) / SAMPLE_RATE;
         float rtfx = audioDuration / (duration / 1000.0f);
         
-        if (config.verbose) {
+        if (verbose) {
             std::cout << "Generated " << audioDuration << "s audio in " 
                       << (duration / 1000.0f) << "s (RTFx: " << rtfx << "x)" << std::endl;
         }
         
-        return audio;
+        return total;
     }
 };
 
 PocketTTS::PocketTTS(const PocketTTSConfig& config)
-    : impl_(std::make_unique<Impl>(config)) {}
+    : impl_(std::make_unique<Impl>(PocketTTSModel::load(config))) {}
+
+PocketTTS::PocketTTS(std::shared_ptr<PocketTTSModel> model)
+    : impl_(model ? std::make_unique<Impl>(std::move(model)) : nullptr) {
+    if (!impl_) {
+        throw std::invalid_argument("Model must not be null");
+    }
+}
 
 PocketTTS::~PocketTTS() = default;
 
 PocketTTS::PocketTTS(PocketTTS&&) noexcept = default;
 PocketTTS& PocketTTS::operator=(PocketTTS&&) noexcept = default;
 
+std::shared_ptr<PocketTTSModel> PocketTTS::model() const {
+    return impl_->model;
+}
+
 std::vector<float> PocketTTS::generate(const std::string& text, const std::string& voicePath) {
-    return impl_->generate(text, voicePath);
+    auto voice = impl_->m.encodeVoiceEmbedding(voicePath);
+    return impl_->generate(text, voice.embeddings, voice.shape);
 }
 
 std::vector<float> PocketTTS::encodeVoice(const std::string& audioPath) {
-    return impl_->encodeVoice(audioPath);
+    return impl_->m.encodeVoice(audioPath);
+}
+
+VoiceEmbedding PocketTTS::encodeVoiceEmbedding(const std::string& audioPath) {
+    return impl_->m.encodeVoiceEmbedding(audioPath);
+}
+
+VoiceEmbedding PocketTTS::encodeVoiceFromSamples(const float* samples, size_t count, int sampleRate) {
+    return impl_->m.encodeVoiceFromSamples(samples, count, sampleRate);
 }
 
 std::vector<float> PocketTTS::generateWithEmbeddings(
@@ -678,9 +2358,71 @@ std::vector<float> PocketTTS::generateWithEmbeddings(
     const std::vector<float>& voiceEmbeddings,
     const std::vector<int64_t>& voiceEmbeddingShape
 ) {
-    // Store in cache temporarily
-    impl_->voiceCache["__embeddings__"] = {voiceEmbeddings, voiceEmbeddingShape};
-    return impl_->generate(text, "__embeddings__");
+    return impl_->generate(text, voiceEmbeddings, voiceEmbeddingShape);
+}
+
+size_t PocketTTS::generateInto(
+    const std::string& text,
+    const std::vector<float>& voiceEmbeddings,
+    const std::vector<int64_t>& voiceEmbeddingShape,
+    float* output,
+    size_t capacity
+) {
+    if (!output && capacity > 0) {
+        throw std::invalid_argument("Output buffer must not be null");
+    }
+    size_t written = 0;
+    return impl_->generate(text, voiceEmbeddings, voiceEmbeddingShape,
+        [&](const float* samples, size_t count) {
+            const size_t n = std::min(count, capacity - written);
+            std::copy(samples, samples + n, output + written);
+            written += n;
+        });
+}
+
+void PocketTTS::setSeed(int64_t seed) {
+    impl_->seed = seed;
+}
+
+int64_t PocketTTS::seed() const {
+    return impl_->seed;
+}
+
+void PocketTTS::prefetch(
+    const std::string& text,
+    const std::vector<float>& voiceEmbeddings,
+    const std::vector<int64_t>& voiceEmbeddingShape
+) {
+    Impl::Prefetch next;
+    next.text = text;
+    next.voiceKey = PocketTTSModel::Impl::hashEmbeddings(voiceEmbeddings, voiceEmbeddingShape);
+    next.utterance = std::async(std::launch::async,
+        [&m = impl_->m, text, voiceEmbeddings, voiceEmbeddingShape] {
+            return m.startUtterance(text, voiceEmbeddings, voiceEmbeddingShape);
+        });
+    
+    Impl::Prefetch replaced;
+    {
+        std::lock_guard<std::mutex> lock(impl_->prefetchMutex);
+        replaced = std::move(impl_->prefetched);
+        impl_->prefetched = std::move(next);
+    }
+    // `replaced` waits for its prefill outside the lock
+}
+
+void PocketTTS::setFlowConfig(const FlowConfig& flow) {
+    if (flow.steps < 0 || flow.postEosSteps < 0) {
+        throw std::invalid_argument("Flow step counts must not be negative");
+    }
+    impl_->setFlowConfig(flow);
+}
+
+const FlowConfig& PocketTTS::flowConfig() const {
+    return impl_->flow;
+}
+
+size_t PocketTTS::maxSamples() const {
+    return static_cast<size_t>(std::max(0, impl_->m.config.maxFrames)) * SAMPLES_PER_FRAME;
 }
 
 int PocketTTS::generateStreaming(
@@ -690,199 +2432,88 @@ int PocketTTS::generateStreaming(
     AudioChunkCallback callback,
     const StreamingConfig& streamConfig
 ) {
-    if (!callback) {
-        throw std::invalid_argument("Callback must be provided");
+    if (!callback && streamConfig.sinks.empty()) {
+        throw std::invalid_argument("Callback or sink must be provided");
     }
     
     // Reset cancellation flag
     impl_->cancelRequested = false;
+    const CancellationToken& token = streamConfig.cancellation;
+    auto cancelled = [&] {
+        return impl_->cancelRequested.load(std::memory_order_relaxed) || token.cancelled();
+    };
     
     auto start = std::chrono::high_resolution_clock::now();
+    auto statsStart = std::chrono::steady_clock::now();
     
-    // Tokenize text
-    auto tokenIds = impl_->tokenizer->encode(text);
+    // Voice and text conditioning passes
+    auto u = impl_->beginUtterance(text, voiceEmbeddings, voiceEmbeddingShape);
+    u.noiseSeed = impl_->resolveSeed(streamConfig.seed);
+    u.stats.seed = u.noiseSeed;
     
-    // Get text embeddings
-    auto textEmb = impl_->runTextConditioner(tokenIds);
-    std::vector<int64_t> textShape = {1, static_cast<int64_t>(tokenIds.size()), 1024};
-    
-    // Initialize flow LM state
-    auto lmState = impl_->initState(*impl_->flowLmMain);
-    
-    // Empty tensors for conditioning passes
-    std::vector<float> emptySeq;
-    std::vector<int64_t> emptySeqShape = {1, 0, 32};
-    std::vector<float> emptyText;
-    std::vector<int64_t> emptyTextShape = {1, 0, 1024};
-    
-    // Voice conditioning pass
-    auto [_, __] = impl_->runFlowLmMainStep(emptySeq, emptySeqShape, 
-                                            const_cast<std::vector<float>&>(voiceEmbeddings), 
-                                            const_cast<std::vector<int64_t>&>(voiceEmbeddingShape), 
-                                            lmState);
-    
-    // Text conditioning pass
-    std::tie(_, __) = impl_->runFlowLmMainStep(emptySeq, emptySeqShape, textEmb, textShape, lmState);
-    
-    // Autoregressive generation with streaming
-    std::vector<std::vector<float>> pendingLatents;
-    std::vector<float> current(32, std::nanf(""));
-    std::vector<int64_t> currentShape = {1, 1, 32};
-    
-    float dt = 1.0f / impl_->config.lsdSteps;
-    int eosStep = -1;
     int totalSamples = 0;
+    ChunkPlanner planner(streamConfig);
+    bool sinksFinished = false;
     
-    // Initialize decoder state for streaming
-    auto decoderState = impl_->initState(*impl_->mimiDecoder);
+    // Pipelined mode decodes on a dedicated thread; otherwise inline
+    Impl::StreamingDecoder::Options decodeOptions;
+    decodeOptions.chunkFrames = static_cast<size_t>(std::max(1, streamConfig.chunkSizeFrames));
+    decodeOptions.queueDepth = streamConfig.pipelined ? static_cast<size_t>(std::max(1, streamConfig.queueDepth)) : 0;
+    decodeOptions.cancelled = cancelled;
+    decodeOptions.start = statsStart;
+    Impl::StreamingDecoder decoder(impl_->m, [&](const Impl::DecodedChunk& chunk) {
+        planner.recordDecode(chunk.decodeMs, chunk.frames);
+        for (const auto& sink : streamConfig.sinks) {
+            sink->write(chunk.samples, chunk.count);
+            if (chunk.isFinal) sink->finish();
+        }
+        sinksFinished = chunk.isFinal;
+        if (callback) {
+            callback(chunk.samples, static_cast<int>(chunk.count), chunk.isFinal);
+        }
+        totalSamples += static_cast<int>(chunk.count);
+    }, std::move(decodeOptions));
     
     if (impl_->config.verbose) {
         std::cout << "Streaming latent generation..." << std::flush;
     }
     
-    for (int step = 0; step < impl_->config.maxFrames; ++step) {
+    for (;;) {
         // Check cancellation
-        if (streamConfig.enableCancellation && impl_->cancelRequested) {
+        if (cancelled()) {
+            u.stats.cancelled = true;
             if (impl_->config.verbose) {
                 std::cout << " cancelled" << std::endl;
             }
             break;
         }
         
-        // Run main model
-        auto [conditioning, eosLogit] = impl_->runFlowLmMainStep(
-            current, currentShape, emptyText, emptyTextShape, lmState
-        );
-        
-        // Check EOS
-        if (eosLogit > -4.0f && eosStep < 0) {
-            eosStep = step;
-        }
+        auto frameStart = std::chrono::steady_clock::now();
         
-        // Stop after frames_after_eos
-        if (eosStep >= 0 && step >= eosStep + impl_->config.framesAfterEos) {
+        // Run main model; stops after frames_after_eos
+        if (!impl_->m.advance(u)) {
             break;
         }
+        const int step = u.step;
         
         // Flow matching with Euler integration
-        std::vector<float> x(32);
-        if (impl_->config.temperature > 0) {
-            float stddev = std::sqrt(impl_->config.temperature);
-            std::normal_distribution<float> dist(0.0f, stddev);
-            for (auto& val : x) {
-                val = dist(impl_->rng);
-            }
-        }
-        
-        for (int j = 0; j < impl_->config.lsdSteps; ++j) {
-            float s = impl_->stBuffers[j].first;
-            float t = impl_->stBuffers[j].second;
-            auto flowOut = impl_->runFlowLmFlow(conditioning, s, t, x);
-            for (size_t k = 0; k < 32; ++k) {
-                x[k] += flowOut[k] * dt;
+        impl_->sampleNoise(u);
+        impl_->integrateFlow(u, impl_->stepsFor(u));
+        
+        decoder.append(u.latent);
+        impl_->m.commitFrame(u, u.latent);
+        planner.recordFrame(std::chrono::duration<float, std::milli>(
+            std::chrono::steady_clock::now() - frameStart).count());
+        
+        // Decode and stream when we have enough frames; the final chunk is
+        // flushed after the loop, once advance() reports the end
+        if (static_cast<int>(decoder.pending()) >= planner.target()) {
+            if (!decoder.flush()) {
+                break;  // Decoder thread failed; its error is rethrown below
             }
-        }
-        
-        pendingLatents.push_back(x);
-        current = x;
-        
-        // Decode and stream when we have enough frames
-        if (static_cast<int>(pendingLatents.size()) >= streamConfig.chunkSizeFrames || 
-            (eosStep >= 0 && step >= eosStep + impl_->config.framesAfterEos)) {
-            
-            // Decode pending latents
-            std::vector<float> chunkAudio;
-            
-            for (size_t i = 0; i < pendingLatents.size(); i += 15) {
-                size_t end = std::min(i + 15, pendingLatents.size());
-                size_t numFrames = end - i;
-                
-                // Combine frames: [1, numFrames, 32]
-                std::vector<float> chunk(numFrames * 32);
-                for (size_t j = 0; j < numFrames; ++j) {
-                    std::copy(pendingLatents[i + j].begin(), pendingLatents[i + j].end(), 
-                              chunk.begin() + j * 32);
-                }
-                
-                std::vector<int64_t> chunkShape = {1, static_cast<int64_t>(numFrames), 32};
-                
-                // Build decoder inputs
-                Ort::AllocatorWithDefaultOptions allocator;
-                std::vector<Ort::Value> inputTensors;
-                std::vector<const char*> inputNames;
-                std::vector<std::string> inputNameStrs;
-                
-                inputTensors.push_back(createTensor(impl_->memoryInfo, chunk, chunkShape));
-                inputNameStrs.push_back("latent");
-                
-                // State inputs in sorted order
-                std::vector<std::string> stateNames;
-                for (auto& [name, entry] : decoderState) {
-                    stateNames.push_back(name);
-                }
-                std::sort(stateNames.begin(), stateNames.end(), [](const std::string& a, const std::string& b) {
-                    int idxA = std::stoi(a.substr(6));
-                    int idxB = std::stoi(b.substr(6));
-                    return idxA < idxB;
-                });
-                
-                for (const auto& name : stateNames) {
-                    inputTensors.push_back(impl_->createStateValue(decoderState[name]));
-                    inputNameStrs.push_back(name);
-                }
-                
-                for (const auto& name : inputNameStrs) {
-                    inputNames.push_back(name.c_str());
-                }
-                
-                // Get output names
-                size_t numOutputs = impl_->mimiDecoder->GetOutputCount();
-                std::vector<std::string> outputNameStrs;
-                std::vector<const char*> outputNames;
-                for (size_t o = 0; o < numOutputs; ++o) {
-                    auto namePtr = impl_->mimiDecoder->GetOutputNameAllocated(o, allocator);
-                    outputNameStrs.push_back(namePtr.get());
-                }
-                for (const auto& name : outputNameStrs) {
-                    outputNames.push_back(name.c_str());
-                }
-                
-                // Run decoder
-                auto outputs = impl_->mimiDecoder->Run(
-                    Ort::RunOptions{nullptr},
-                    inputNames.data(), inputTensors.data(), inputTensors.size(),
-                    outputNames.data(), outputNames.size()
-                );
-                
-                // Get audio output
-                auto& audioTensor = outputs[0];
-                auto audioInfo = audioTensor.GetTensorTypeAndShapeInfo();
-                size_t audioSize = audioInfo.GetElementCount();
-                float* audioData = audioTensor.GetTensorMutableData<float>();
-                chunkAudio.insert(chunkAudio.end(), audioData, audioData + audioSize);
-                
-                // Update decoder state
-                for (size_t k = 1; k < outputs.size(); ++k) {
-                    const std::string& outName = outputNameStrs[k];
-                    if (outName.find("out_state_") == 0) {
-                        int idx = std::stoi(outName.substr(10));
-                        std::string stateName = "state_" + std::to_string(idx);
-                        
-                        if (decoderState.find(stateName) != decoderState.end()) {
-                            impl_->updateStateFromOutput(decoderState[stateName], outputs[k]);
-                        }
-                    }
-                }
-            }
-            
-            // Call user callback with audio chunk
-            bool isFinal = (eosStep >= 0 && step >= eosStep + impl_->config.framesAfterEos);
-            callback(chunkAudio.data(), static_cast<int>(chunkAudio.size()), isFinal);
+            planner.chunkEmitted();
             
-            totalSamples += static_cast<int>(chunkAudio.size());
-            pendingLatents.clear();
-            
-            if (impl_->config.verbose && !isFinal) {
+            if (impl_->config.verbose) {
                 std::cout << "." << std::flush;
             }
         }
@@ -893,86 +2524,204 @@ int PocketTTS::generateStreaming(
         }
     }
     
-    // Decode and send any remaining latents
-    if (!pendingLatents.empty() && !impl_->cancelRequested) {
-        std::vector<float> finalAudio;
+    // Decode and send any remaining latents; a cancelled stream only gets
+    // an empty final chunk
+    if (u.stats.cancelled) {
+        decoder.cancel();
+    } else {
+        decoder.flush(true);
+    }
+    
+    // Wait for the decoder thread to drain; rethrows a decode/callback error
+    decoder.finish();
+    
+    // Cancelled before the final chunk: sinks still close their output
+    if (!sinksFinished) {
+        for (const auto& sink : streamConfig.sinks) {
+            sink->finish();
+        }
+    }
+    
+    decoder.mergeStats(u.stats);
+    u.stats.audioSamples = totalSamples;
+    impl_->publishStats(std::move(u.stats), statsStart);
+    
+    if (impl_->config.verbose) {
+        auto end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+        float audioDuration = static_cast<float>(totalSamples) / SAMPLE_RATE;
+        float rtfx = audioDuration / (duration / 1000.0f);
         
-        for (size_t i = 0; i < pendingLatents.size(); i += 15) {
-            size_t end = std::min(i + 15, pendingLatents.size());
-            size_t numFrames = end - i;
-            
-            std::vector<float> chunk(numFrames * 32);
-            for (size_t j = 0; j < numFrames; ++j) {
-                std::copy(pendingLatents[i + j].begin(), pendingLatents[i + j].end(), 
-                          chunk.begin() + j * 32);
-            }
-            
-            std::vector<int64_t> chunkShape = {1, static_cast<int64_t>(numFrames), 32};
-            
-            Ort::AllocatorWithDefaultOptions allocator;
-            std::vector<Ort::Value> inputTensors;
-            std::vector<const char*> inputNames;
-            std::vector<std::string> inputNameStrs;
-            
-            inputTensors.push_back(createTensor(impl_->memoryInfo, chunk, chunkShape));
-            inputNameStrs.push_back("latent");
-            
-            std::vector<std::string> stateNames;
-            for (auto& [name, entry] : decoderState) {
-                stateNames.push_back(name);
-            }
-            std::sort(stateNames.begin(), stateNames.end(), [](const std::string& a, const std::string& b) {
-                int idxA = std::stoi(a.substr(6));
-                int idxB = std::stoi(b.substr(6));
-                return idxA < idxB;
-            });
-            
-            for (const auto& name : stateNames) {
-                inputTensors.push_back(impl_->createStateValue(decoderState[name]));
-                inputNameStrs.push_back(name);
+        std::cout << " done" << std::endl;
+        std::cout << "Streamed " << audioDuration << "s audio in " 
+                  << (duration / 1000.0f) << "s (RTFx: " << rtfx << "x)" << std::endl;
+    }
+    
+    return totalSamples;
+}
+
+int PocketTTS::generateLongForm(
+    const std::string& text,
+    const std::vector<float>& voiceEmbeddings,
+    const std::vector<int64_t>& voiceEmbeddingShape,
+    AudioChunkCallback callback,
+    const LongFormConfig& longFormConfig
+) {
+    if (!callback) {
+        throw std::invalid_argument("Callback must be provided");
+    }
+    
+    impl_->cancelRequested = false;
+    auto start = std::chrono::high_resolution_clock::now();
+    auto statsStart = std::chrono::steady_clock::now();
+    GenerationStats stats;
+    
+    auto& m = impl_->m;
+    auto segments = splitText(text, static_cast<size_t>(std::max(1, longFormConfig.maxTokensPerSegment)),
+                              [&m](const std::string& t) { return m.tokenizer->encode(t).size(); });
+    if (segments.empty()) {
+        impl_->publishStats(stats, statsStart);
+        return 0;
+    }
+    
+    // Each worker runs its own generation context; the sessions are shared.
+    // Default to one worker per intra-op thread group to avoid oversubscription.
+    int numThreads = longFormConfig.numThreads;
+    if (numThreads <= 0) {
+        int hw = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        numThreads = std::max(1, hw / std::max(1, impl_->config.intraOpThreads));
+    }
+    numThreads = std::min(numThreads, static_cast<int>(segments.size()));
+    
+    if (impl_->config.verbose) {
+        std::cout << "Long-form: " << segments.size() << " segments on "
+                  << numThreads << " threads..." << std::flush;
+    }
+    
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::vector<std::optional<std::vector<float>>> results(segments.size());
+    std::vector<GenerationStats> segmentStats(segments.size());
+    std::atomic<size_t> nextSegment{0};
+    std::atomic<bool> stop{false};
+    std::exception_ptr error;
+    const uint64_t baseSeed = impl_->resolveSeed(-1);
+    stats.seed = baseSeed;
+    
+    int running = numThreads;  // Workers that haven't exited yet
+    
+    auto worker = [&](Impl& ctx) {
+        for (;;) {
+            size_t idx = nextSegment.fetch_add(1);
+            if (idx >= segments.size() || stop || impl_->cancelRequested) break;
+            try {
+                // The voice prefix cache makes every segment reuse one voice pass.
+                // Segment seeds depend only on the index, not on which worker runs it.
+                const auto segmentSeed = static_cast<int64_t>(FrameNoise::deriveSeed(baseSeed, idx) >> 1);
+                auto audio = ctx.generate(segments[idx], voiceEmbeddings, voiceEmbeddingShape, segmentSeed);
+                if (ctx.lastStats.cancelled) break;  // Truncated; never delivered
+                std::lock_guard<std::mutex> lock(mutex);
+                results[idx] = std::move(audio);
+                segmentStats[idx] = ctx.lastStats;
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) error = std::current_exception();
+                stop = true;
             }
-            
-            for (const auto& name : inputNameStrs) {
-                inputNames.push_back(name.c_str());
+            ready.notify_all();
+        }
+        // Under the lock so the delivery loop can't miss it between its check and its wait
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --running;
+        }
+        ready.notify_all();
+    };
+    
+    std::vector<std::unique_ptr<Impl>> contexts;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i) {
+        contexts.push_back(std::make_unique<Impl>(impl_->model));
+        contexts.back()->verbose = false;
+        contexts.back()->reportStats = false;
+        contexts.back()->overlapDecode = false;
+        contexts.back()->setFlowConfig(impl_->flow);
+        contexts.back()->parentCancel = &impl_->cancelRequested;
+        threads.emplace_back(worker, std::ref(*contexts.back()));
+    }
+    
+    // Deliver segments in order on the calling thread, holding back the end
+    // of each one to crossfade it with the start of the next
+    const size_t crossfade = static_cast<size_t>(
+        std::max(0, longFormConfig.crossfadeMs) * SAMPLE_RATE / 1000);
+    std::vector<float> tail;
+    int totalSamples = 0;
+    auto emit = [&](const float* data, size_t count, bool isFinal) {
+        if (count == 0 && !isFinal) return;
+        if (stats.timeToFirstAudioMs <= 0.0) {
+            stats.timeToFirstAudioMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - statsStart).count();
+        }
+        callback(data, static_cast<int>(count), isFinal);
+        totalSamples += static_cast<int>(count);
+    };
+    
+    try {
+        for (size_t idx = 0; idx < segments.size(); ++idx) {
+            std::vector<float> audio;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                // Every exit of a worker notifies, so a cancel is seen once
+                // the running segments have stopped at their next frame
+                ready.wait(lock, [&] { return results[idx].has_value() || stop || running == 0; });
+                if (!results[idx] || impl_->cancelRequested) {
+                    stats.cancelled = stats.cancelled || impl_->cancelRequested;
+                    break;
+                }
+                audio = std::move(*results[idx]);
+                results[idx].reset();
+                accumulateStats(stats, segmentStats[idx]);
             }
             
-            size_t numOutputs = impl_->mimiDecoder->GetOutputCount();
-            std::vector<std::string> outputNameStrs;
-            std::vector<const char*> outputNames;
-            for (size_t o = 0; o < numOutputs; ++o) {
-                auto namePtr = impl_->mimiDecoder->GetOutputNameAllocated(o, allocator);
-                outputNameStrs.push_back(namePtr.get());
-            }
-            for (const auto& name : outputNameStrs) {
-                outputNames.push_back(name.c_str());
+            size_t fade = std::min({crossfade, tail.size(), audio.size()});
+            for (size_t i = 0; i < fade; ++i) {
+                float w = static_cast<float>(i + 1) / static_cast<float>(fade + 1);
+                audio[i] = tail[tail.size() - fade + i] * (1.0f - w) + audio[i] * w;
             }
+            emit(tail.data(), tail.size() - fade, false);
             
-            auto outputs = impl_->mimiDecoder->Run(
-                Ort::RunOptions{nullptr},
-                inputNames.data(), inputTensors.data(), inputTensors.size(),
-                outputNames.data(), outputNames.size()
-            );
+            const bool last = idx + 1 == segments.size();
+            size_t hold = last ? 0 : std::min(crossfade, audio.size());
+            emit(audio.data(), audio.size() - hold, last);
+            tail.assign(audio.end() - static_cast<std::ptrdiff_t>(hold), audio.end());
             
-            auto& audioTensor = outputs[0];
-            auto audioInfo = audioTensor.GetTensorTypeAndShapeInfo();
-            size_t audioSize = audioInfo.GetElementCount();
-            float* audioData = audioTensor.GetTensorMutableData<float>();
-            finalAudio.insert(finalAudio.end(), audioData, audioData + audioSize);
+            if (longFormConfig.onProgress) {
+                longFormConfig.onProgress(static_cast<int>(idx + 1), static_cast<int>(segments.size()));
+            }
         }
-        
-        callback(finalAudio.data(), static_cast<int>(finalAudio.size()), true);
-        totalSamples += static_cast<int>(finalAudio.size());
+    } catch (...) {
+        stop = true;
+        for (auto& thread : threads) thread.join();
+        throw;
+    }
+    
+    stop = true;
+    for (auto& thread : threads) thread.join();
+    if (error) {
+        std::rethrow_exception(error);
     }
     
+    // Segment sample counts include the crossfaded overlap; report what was delivered
+    stats.audioSamples = totalSamples;
+    impl_->publishStats(stats, statsStart);
+    
     if (impl_->config.verbose) {
         auto end = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
         float audioDuration = static_cast<float>(totalSamples) / SAMPLE_RATE;
-        float rtfx = audioDuration / (duration / 1000.0f);
-        
         std::cout << " done" << std::endl;
-        std::cout << "Streamed " << audioDuration << "s audio in " 
-                  << (duration / 1000.0f) << "s (RTFx: " << rtfx << "x)" << std::endl;
+        std::cout << "Generated " << audioDuration << "s audio in " << (duration / 1000.0f)
+                  << "s (RTFx: " << audioDuration / (duration / 1000.0f) << "x)" << std::endl;
     }
     
     return totalSamples;
@@ -982,4 +2731,317 @@ void PocketTTS::cancelStreaming() {
     impl_->cancelRequested = true;
 }
 
+const GenerationStats& PocketTTS::lastStats() const {
+    return impl_->lastStats;
+}
+
+std::vector<std::vector<float>> PocketTTS::generateBatch(
+    const std::vector<BatchRequest>& requests,
+    int maxBatchSize
+) {
+    BatchScheduler scheduler(*this, maxBatchSize);
+    std::vector<int> ids;
+    for (const auto& request : requests) {
+        ids.push_back(scheduler.submit(request));
+    }
+    scheduler.runUntilIdle();
+    
+    std::vector<std::vector<float>> results;
+    for (int id : ids) {
+        results.push_back(scheduler.takeResult(id));
+    }
+    return results;
+}
+
+// ── BatchScheduler ─────────────────────────────────────────────────────
+
+struct BatchScheduler::Impl {
+    // One request in flight
+    struct Active {
+        int id;
+        BatchRequest request;
+        Utterance utterance;
+        std::unique_ptr<PocketTTS::Impl::StreamingDecoder> decoder;
+        std::vector<float> audio;
+        std::exception_ptr error;
+        std::chrono::steady_clock::time_point start;
+        uint64_t seed = 0;
+    };
+    
+    struct Result {
+        std::vector<float> audio;
+        std::exception_ptr error;
+        RequestStatus status = RequestStatus::Completed;
+    };
+    
+    PocketTTS::Impl& tts;
+    int maxBatchSize;
+    WorkerPool pool;
+    
+    // Guards requests, stopping, results and the size of active
+    mutable std::mutex mutex;
+    RequestQueue<Active> requests;  // Queued and paused
+    std::vector<std::unique_ptr<Active>> stopping;  // Cancelled, left to drain by finishStopping()
+    std::map<int, Result> results;
+    
+    std::vector<std::unique_ptr<Active>> active;
+    std::vector<Utterance*> generating;  // Per-step scratch of step()
+    std::vector<Active*> owners;
+    
+    Impl(PocketTTS::Impl& engine, int batchSize)
+        : tts(engine), maxBatchSize(std::max(1, batchSize)), pool(maxBatchSize - 1) {}
+    
+    // Retire a request that will not run any further (caller holds mutex).
+    // Stats of successful requests go to completed, for reportStats() once
+    // the lock is released.
+    void retire(Active& r, RequestStatus status, std::vector<GenerationStats>& completed) {
+        if (r.decoder) r.decoder->mergeStats(r.utterance.stats);
+        if (status == RequestStatus::Completed && !r.error && tts.config.onGenerationStats) {
+            auto& stats = r.utterance.stats;
+            stats.audioSamples = static_cast<int>(r.decoder ? r.decoder->samples() : r.audio.size());
+            stats.totalMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - r.start).count();
+            completed.push_back(stats);
+        }
+        results[r.id] = Result{std::move(r.audio), r.error, r.error ? RequestStatus::Failed : status};
+    }
+    
+    // Send retired requests' stats to onGenerationStats without the lock, so
+    // the hook may call back into the scheduler
+    void reportStats(const std::vector<GenerationStats>& completed) const {
+        for (const auto& stats : completed) {
+            tts.config.onGenerationStats(stats);
+        }
+    }
+    
+    // Drop cancelled requests wherever they are and expired queued ones
+    // (caller holds mutex)
+    void dropCancelled() {
+        requests.dropQueued(std::chrono::steady_clock::now(), [this](int id, RequestStatus status) {
+            results[id] = Result{{}, nullptr, status};
+        });
+        const size_t before = stopping.size();
+        requests.takeCancelled(active, stopping);
+        for (size_t i = before; i < stopping.size(); ++i) {
+            stopping[i]->utterance.stats.cancelled = true;
+        }
+    }
+    
+    // Retire cancelled requests without decoding their pending latents, as
+    // generateStreaming does; a stream still gets an empty final chunk.
+    // Runs without the lock: the decoder calls user callbacks.
+    void finishStopping() {
+        std::vector<std::unique_ptr<Active>> draining;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping.empty()) return;
+            draining.swap(stopping);
+        }
+        for (auto& r : draining) {
+            if (!r->decoder) continue;
+            try {
+                r->decoder->cancel();
+            } catch (...) {
+                r->error = std::current_exception();
+            }
+        }
+        std::vector<GenerationStats> completed;  // Stays empty: cancelled requests don't report
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& r : draining) {
+            retire(*r, RequestStatus::Cancelled, completed);
+        }
+    }
+    
+    // Fill batch slots at a frame boundary: paused requests resume and
+    // queued ones are prefilled in parallel, best first; when the batch is
+    // full a better waiting request pauses the worst active one
+    void admit() {
+        std::vector<std::unique_ptr<Active>> admitted;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            dropCancelled();
+            requests.admit(active, admitted, static_cast<size_t>(maxBatchSize), [](const Active& r) {
+                return !r.error && !r.utterance.finished;
+            });
+            for (auto& entry : admitted) {
+                entry->seed = tts.resolveSeed(entry->request.seed);  // Before the parallel prefill
+            }
+        }
+        
+        pool.run(admitted.size(), [&](size_t i) {
+            auto& r = *admitted[i];
+            r.start = std::chrono::steady_clock::now();
+            try {
+                r.utterance = tts.m.startUtterance(
+                    r.request.text, r.request.voiceEmbeddings, r.request.voiceEmbeddingShape);
+                r.utterance.noiseSeed = r.seed;
+                r.utterance.stats.seed = r.seed;
+                PocketTTS::Impl::StreamingDecoder::Options decodeOptions;
+                decodeOptions.start = r.start;
+                r.decoder = std::make_unique<PocketTTS::Impl::StreamingDecoder>(
+                    tts.m, [&r](const PocketTTS::Impl::DecodedChunk& chunk) {
+                        // Streamed audio is only handed to the callback, not kept
+                        if (r.request.callback) {
+                            r.request.callback(chunk.samples, static_cast<int>(chunk.count), chunk.isFinal);
+                        } else {
+                            r.audio.insert(r.audio.end(), chunk.samples, chunk.samples + chunk.count);
+                        }
+                    }, std::move(decodeOptions));
+            } catch (...) {
+                r.error = std::current_exception();
+            }
+        });
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& entry : admitted) {
+            active.push_back(std::move(entry));
+        }
+    }
+    
+    bool step() {
+        admit();
+        finishStopping();
+        if (active.empty()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return !requests.empty();
+        }
+        
+        // Main step for every active request (independent KV states)
+        pool.run(active.size(), [&](size_t i) {
+            auto& r = *active[i];
+            if (r.error) return;
+            try {
+                tts.m.advance(r.utterance);
+            } catch (...) {
+                r.error = std::current_exception();
+            }
+        });
+        
+        // Flow matching for all requests still generating, batched
+        generating.clear();
+        owners.clear();
+        for (auto& r : active) {
+            if (!r->error && !r->utterance.finished) {
+                generating.push_back(&r->utterance);
+                owners.push_back(r.get());
+                tts.sampleNoise(r->utterance);
+            }
+        }
+        tts.integrateFlowBatch(generating);
+        for (size_t b = 0; b < generating.size(); ++b) {
+            owners[b]->decoder->append(generating[b]->latent);
+            tts.m.commitFrame(*generating[b], generating[b]->latent);
+        }
+        
+        // Decode finished requests and full chunks: the request's chunk size
+        // when streaming, otherwise decoder groups as they fill up
+        pool.run(active.size(), [&](size_t i) {
+            auto& r = *active[i];
+            if (r.error) return;
+            
+            const bool finished = r.utterance.finished;
+            const size_t chunkFrames = r.request.callback
+                ? static_cast<size_t>(std::max(1, r.request.chunkSizeFrames)) : DECODE_GROUP_FRAMES;
+            if (!finished && r.decoder->pending() < chunkFrames) return;
+            
+            try {
+                r.decoder->flush(finished);
+            } catch (...) {
+                r.error = std::current_exception();
+            }
+        });
+        
+        // Retire finished and failed requests
+        std::vector<GenerationStats> completed;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto it = active.begin(); it != active.end();) {
+                auto& r = **it;
+                if (r.error || r.utterance.finished) {
+                    retire(r, r.error ? RequestStatus::Failed : RequestStatus::Completed, completed);
+                    it = active.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        reportStats(completed);
+        return true;
+    }
+};
+
+BatchScheduler::BatchScheduler(PocketTTS& tts, int maxBatchSize)
+    : impl_(std::make_unique<Impl>(*tts.impl_, maxBatchSize)) {}
+
+BatchScheduler::~BatchScheduler() = default;
+
+int BatchScheduler::submit(BatchRequest request) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->requests.submit(std::move(request));
+}
+
+bool BatchScheduler::step() {
+    return impl_->step();
+}
+
+void BatchScheduler::runUntilIdle() {
+    while (impl_->step()) {
+    }
+}
+
+bool BatchScheduler::isDone(int requestId) const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->results.count(requestId) > 0;
+}
+
+std::vector<float> BatchScheduler::takeResult(int requestId) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto it = impl_->results.find(requestId);
+    if (it == impl_->results.end()) {
+        throw std::runtime_error("Request " + std::to_string(requestId) + " is not finished");
+    }
+    auto result = std::move(it->second);
+    impl_->results.erase(it);
+    if (result.status == RequestStatus::Failed && result.error) {
+        std::rethrow_exception(result.error);
+    }
+    return std::move(result.audio);
+}
+
+int BatchScheduler::activeCount() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return static_cast<int>(impl_->active.size());
+}
+
+int BatchScheduler::queuedCount() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return static_cast<int>(impl_->requests.queuedCount());
+}
+
+int BatchScheduler::pausedCount() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return static_cast<int>(impl_->requests.pausedCount());
+}
+
+RequestStatus BatchScheduler::status(int requestId) const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto result = impl_->results.find(requestId);
+    if (result != impl_->results.end()) return result->second.status;
+    for (const auto& r : impl_->active) {
+        if (r->id == requestId) return RequestStatus::Running;
+    }
+    for (const auto& r : impl_->stopping) {
+        if (r->id == requestId) return RequestStatus::Running;  // Draining its decoder
+    }
+    return impl_->requests.status(requestId);
+}
+
+bool BatchScheduler::cancel(int requestId) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    for (const auto& r : impl_->active) {
+        if (r->id == requestId) { r->request.cancellation.cancel(); return true; }
+    }
+    return impl_->requests.cancel(requestId);
+}
+
 } // namespace pocket_tts
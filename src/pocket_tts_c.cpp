@@ -1,11 +1,14 @@
 #include "pocket_tts/pocket_tts_c.h"
 #include "pocket_tts/pocket_tts.hpp"
 #include "pocket_tts/audio_utils.hpp"
+#include "pocket_tts/voice_store.hpp"
 
 #include <string>
 #include <vector>
 #include <memory>
 #include <cstring>
+#include <algorithm>
+#include <stdexcept>
 
 // Thread-local error message
 static thread_local std::string g_lastError;
@@ -17,32 +20,114 @@ static const char* VERSION = "1.0.0";
 struct VoiceData {
     std::vector<float> embeddings;
     std::vector<int64_t> shape;
+    uint64_t sourceHash = 0;
+    std::string modelVersion = pocket_tts::VOICE_MODEL_VERSION;
 };
 
+static VoiceData* newVoiceData(pocket_tts::VoiceEmbedding&& voice) {
+    auto* data = new VoiceData();
+    data->embeddings = std::move(voice.embeddings);
+    data->shape = std::move(voice.shape);
+    data->sourceHash = voice.sourceHash;
+    data->modelVersion = std::move(voice.modelVersion);
+    return data;
+}
+
 // Set error message
 static void setError(const std::string& msg) {
     g_lastError = msg;
 }
 
-extern "C" {
+// Map C flow settings onto FlowConfig; false on unknown enum values
+static bool toFlowConfig(int solver, int schedule, int steps, int postEosSteps,
+                         pocket_tts::FlowConfig& flow) {
+    if (solver < POCKET_TTS_FLOW_EULER || solver > POCKET_TTS_FLOW_HEUN ||
+        schedule < POCKET_TTS_SCHEDULE_UNIFORM || schedule > POCKET_TTS_SCHEDULE_QUADRATIC) {
+        return false;
+    }
+    flow.solver = static_cast<pocket_tts::FlowSolver>(solver);
+    flow.schedule = static_cast<pocket_tts::FlowSchedule>(schedule);
+    flow.steps = std::max(0, steps);
+    flow.postEosSteps = std::max(0, postEosSteps);
+    return true;
+}
 
-POCKET_TTS_API PocketTTSHandle pocket_tts_create(const PocketTTSConfig* config) {
-    try {
-        pocket_tts::PocketTTSConfig cfg;
+// Seeds are int64 in C++, where negative means "random"
+static int64_t toSeed(uint64_t seed) {
+    if (seed > static_cast<uint64_t>(INT64_MAX)) {
+        throw std::invalid_argument("seed must be below 2^63");
+    }
+    return static_cast<int64_t>(seed);
+}
+
+// Convert the C config to the C++ one; zero / NULL fields keep defaults
+static pocket_tts::PocketTTSConfig toCppConfig(const PocketTTSConfig* config) {
+    pocket_tts::PocketTTSConfig cfg;
+    
+    if (config) {
+        if (config->models_dir) cfg.modelsDir = config->models_dir;
+        if (config->tokenizer_path) cfg.tokenizerPath = config->tokenizer_path;
+        if (config->precision) cfg.precision = config->precision;
+        if (config->temperature > 0) cfg.temperature = config->temperature;
+        if (config->lsd_steps > 0) cfg.lsdSteps = config->lsd_steps;
+        if (config->max_frames > 0) cfg.maxFrames = config->max_frames;
         
-        if (config) {
-            if (config->models_dir) cfg.modelsDir = config->models_dir;
-            if (config->tokenizer_path) cfg.tokenizerPath = config->tokenizer_path;
-            if (config->precision) cfg.precision = config->precision;
-            if (config->temperature > 0) cfg.temperature = config->temperature;
-            if (config->lsd_steps > 0) cfg.lsdSteps = config->lsd_steps;
-            if (config->max_frames > 0) cfg.maxFrames = config->max_frames;
+        if (config->intra_op_threads > 0) cfg.intraOpThreads = config->intra_op_threads;
+        if (config->inter_op_threads > 0) cfg.interOpThreads = config->inter_op_threads;
+        if (config->disable_spinning) cfg.allowSpinning = false;
+        if (config->thread_affinity) cfg.threadAffinity = config->thread_affinity;
+        cfg.textConditionerThreads = std::max(0, config->text_conditioner_threads);
+        cfg.flowLmMainThreads = std::max(0, config->flow_lm_main_threads);
+        cfg.flowLmFlowThreads = std::max(0, config->flow_lm_flow_threads);
+        cfg.mimiDecoderThreads = std::max(0, config->mimi_decoder_threads);
+        cfg.mimiEncoderThreads = std::max(0, config->mimi_encoder_threads);
+        
+        if (config->execution_provider) cfg.executionProvider = config->execution_provider;
+        if (config->device_id > 0) cfg.deviceId = config->device_id;
+        
+        if (config->optimized_model_cache_dir) cfg.optimizedModelCacheDir = config->optimized_model_cache_dir;
+        if (config->lazy_load) cfg.lazyLoad = true;
+        if (config->disable_prepacked_sharing) cfg.sharePrepackedWeights = false;
+        if (config->disable_model_mapping) cfg.mapModelFiles = false;
+        if (config->disable_overlap_decode) cfg.overlapDecode = false;
+        if (config->text_cache_mb != 0) {
+            cfg.textCacheBytes = static_cast<size_t>(std::max(0, config->text_cache_mb)) * 1024 * 1024;
         }
+        cfg.audioCacheBytes = static_cast<size_t>(std::max(0, config->audio_cache_mb)) * 1024 * 1024;
+        if (config->fixed_seed) cfg.seed = toSeed(config->seed);
+        if (config->context_window_frames > 0) cfg.contextWindowFrames = config->context_window_frames;
+        if (config->context_keep_frames > 0) cfg.contextKeepFrames = config->context_keep_frames;
+        if (config->global_thread_pools) cfg.globalThreadPools = true;
+        if (config->disable_cpu_arena) cfg.cpuArena = false;
+        if (config->shared_arena) cfg.sharedArena = true;
+        if (config->arena_extend_strategy) cfg.arenaExtendStrategy = config->arena_extend_strategy;
+        cfg.arenaMaxBytes = static_cast<size_t>(std::max(0, config->arena_max_mb)) * 1024 * 1024;
+        if (config->arena_shrinkage) cfg.arenaShrinkage = true;
         
-        // Disable stdout logging for C API
-        cfg.verbose = false;
+        if (!toFlowConfig(config->flow_solver, config->flow_schedule, 0,
+                          config->post_eos_lsd_steps, cfg.flow)) {
+            throw std::invalid_argument("Unknown flow_solver or flow_schedule");
+        }
         
-        auto* tts = new pocket_tts::PocketTTS(cfg);
+        if (config->stage_timing_callback) {
+            auto callback = config->stage_timing_callback;
+            void* userData = config->stage_timing_user_data;
+            cfg.onStageTiming = [callback, userData](pocket_tts::Stage stage, double ms) {
+                callback(static_cast<int>(stage), pocket_tts::stageName(stage), ms, userData);
+            };
+        }
+    }
+    
+    // Disable stdout logging for C API
+    cfg.verbose = false;
+    return cfg;
+}
+
+extern "C" {
+
+POCKET_TTS_API PocketTTSHandle pocket_tts_create(const PocketTTSConfig* config) {
+    try {
+        auto* tts = new pocket_tts::PocketTTS(toCppConfig(config));
         return static_cast<PocketTTSHandle>(tts);
     } catch (const std::exception& e) {
         setError(std::string("Failed to create PocketTTS: ") + e.what());
@@ -56,6 +141,39 @@ POCKET_TTS_API void pocket_tts_destroy(PocketTTSHandle handle) {
     }
 }
 
+POCKET_TTS_API PocketTTSModelHandle pocket_tts_model_create(const PocketTTSConfig* config) {
+    try {
+        auto* model = new std::shared_ptr<pocket_tts::PocketTTSModel>(
+            pocket_tts::PocketTTSModel::load(toCppConfig(config)));
+        return static_cast<PocketTTSModelHandle>(model);
+    } catch (const std::exception& e) {
+        setError(std::string("Failed to load model: ") + e.what());
+        return nullptr;
+    }
+}
+
+POCKET_TTS_API void pocket_tts_model_destroy(PocketTTSModelHandle model) {
+    if (model) {
+        delete static_cast<std::shared_ptr<pocket_tts::PocketTTSModel>*>(model);
+    }
+}
+
+POCKET_TTS_API PocketTTSHandle pocket_tts_create_from_model(PocketTTSModelHandle model) {
+    if (!model) {
+        setError("Invalid model handle");
+        return nullptr;
+    }
+    
+    try {
+        auto& shared = *static_cast<std::shared_ptr<pocket_tts::PocketTTSModel>*>(model);
+        auto* tts = new pocket_tts::PocketTTS(shared);
+        return static_cast<PocketTTSHandle>(tts);
+    } catch (const std::exception& e) {
+        setError(std::string("Failed to create PocketTTS: ") + e.what());
+        return nullptr;
+    }
+}
+
 POCKET_TTS_API VoiceHandle pocket_tts_encode_voice(PocketTTSHandle handle, const char* audio_path) {
     if (!handle || !audio_path) {
         setError("Invalid handle or audio path");
@@ -64,17 +182,7 @@ POCKET_TTS_API VoiceHandle pocket_tts_encode_voice(PocketTTSHandle handle, const
     
     try {
         auto* tts = static_cast<pocket_tts::PocketTTS*>(handle);
-        auto embeddings = tts->encodeVoice(audio_path);
-        
-        // Create voice data structure
-        auto* voice = new VoiceData();
-        voice->embeddings = std::move(embeddings);
-        
-        // Estimate shape from size (embeddings are [1, N, 1024])
-        int64_t frames = static_cast<int64_t>(voice->embeddings.size()) / 1024;
-        voice->shape = {1, frames, 1024};
-        
-        return static_cast<VoiceHandle>(voice);
+        return static_cast<VoiceHandle>(newVoiceData(tts->encodeVoiceEmbedding(audio_path)));
     } catch (const std::exception& e) {
         setError(std::string("Failed to encode voice: ") + e.what());
         return nullptr;
@@ -93,24 +201,54 @@ POCKET_TTS_API VoiceHandle pocket_tts_encode_voice_from_samples(
     }
     
     try {
-        // Resample if needed
-        std::vector<float> audio(audio_data, audio_data + sample_count);
-        if (sample_rate != pocket_tts::AudioUtils::TARGET_SAMPLE_RATE) {
-            audio = pocket_tts::AudioUtils::resample(audio, sample_rate, pocket_tts::AudioUtils::TARGET_SAMPLE_RATE);
-        }
-        
-        // Save to temporary file (PocketTTS currently requires file path)
-        // TODO: Add direct buffer encoding to PocketTTS class
-        std::string tempPath = "/tmp/pocket_tts_temp_voice.wav";
-        pocket_tts::AudioUtils::saveWav(tempPath, audio);
-        
-        return pocket_tts_encode_voice(handle, tempPath.c_str());
+        auto* tts = static_cast<pocket_tts::PocketTTS*>(handle);
+        return static_cast<VoiceHandle>(newVoiceData(tts->encodeVoiceFromSamples(
+            audio_data, static_cast<size_t>(sample_count), sample_rate)));
     } catch (const std::exception& e) {
         setError(std::string("Failed to encode voice from samples: ") + e.what());
         return nullptr;
     }
 }
 
+POCKET_TTS_API VoiceHandle pocket_tts_load_voice(const char* voice_path) {
+    if (!voice_path) {
+        setError("Invalid voice path");
+        return nullptr;
+    }
+    
+    try {
+        return static_cast<VoiceHandle>(newVoiceData(pocket_tts::loadVoice(voice_path)));
+    } catch (const std::exception& e) {
+        setError(std::string("Failed to load voice: ") + e.what());
+        return nullptr;
+    }
+}
+
+POCKET_TTS_API int pocket_tts_save_voice(VoiceHandle voice, const char* voice_path) {
+    if (!voice || !voice_path) {
+        setError("Invalid parameters");
+        return -1;
+    }
+    
+    try {
+        auto* voiceData = static_cast<VoiceData*>(voice);
+        pocket_tts::VoiceEmbedding embedding;
+        embedding.embeddings = voiceData->embeddings;
+        embedding.shape = voiceData->shape;
+        embedding.sourceHash = voiceData->sourceHash;
+        embedding.modelVersion = voiceData->modelVersion;
+        pocket_tts::saveVoice(voice_path, embedding);
+        return 0;
+    } catch (const std::exception& e) {
+        setError(std::string("Failed to save voice: ") + e.what());
+        return -1;
+    }
+}
+
+POCKET_TTS_API uint64_t pocket_tts_voice_hash(VoiceHandle voice) {
+    return voice ? static_cast<VoiceData*>(voice)->sourceHash : 0;
+}
+
 POCKET_TTS_API void pocket_tts_free_voice(VoiceHandle voice) {
     if (voice) {
         delete static_cast<VoiceData*>(voice);
@@ -132,14 +270,14 @@ POCKET_TTS_API int pocket_tts_generate(
         auto* tts = static_cast<pocket_tts::PocketTTS*>(handle);
         auto* voiceData = static_cast<VoiceData*>(voice);
         
-        // Generate using embeddings
-        auto audio = tts->generateWithEmbeddings(text, voiceData->embeddings, voiceData->shape);
+        // Generate using embeddings; the result takes over the vector
+        auto audio = std::make_unique<std::vector<float>>(
+            tts->generateWithEmbeddings(text, voiceData->embeddings, voiceData->shape));
         
-        // Allocate and copy result
-        result->data = new float[audio.size()];
-        std::memcpy(result->data, audio.data(), audio.size() * sizeof(float));
-        result->sample_count = static_cast<int>(audio.size());
+        result->data = audio->data();
+        result->sample_count = static_cast<int>(audio->size());
         result->sample_rate = 24000;  // PocketTTS sample rate
+        result->owner = audio.release();
         
         return 0;
     } catch (const std::exception& e) {
@@ -149,11 +287,52 @@ POCKET_TTS_API int pocket_tts_generate(
 }
 
 POCKET_TTS_API void pocket_tts_free_audio(AudioResult* result) {
-    if (result && result->data) {
+    if (!result) {
+        return;
+    }
+    if (result->owner) {
+        delete static_cast<std::vector<float>*>(result->owner);
+    } else {
         delete[] result->data;
-        result->data = nullptr;
-        result->sample_count = 0;
     }
+    result->data = nullptr;
+    result->owner = nullptr;
+    result->sample_count = 0;
+}
+
+POCKET_TTS_API int pocket_tts_generate_into(
+    PocketTTSHandle handle,
+    const char* text,
+    VoiceHandle voice,
+    float* buffer,
+    int capacity,
+    int* sample_count
+) {
+    if (!handle || !text || !voice || !sample_count || capacity < 0 || (!buffer && capacity > 0)) {
+        setError("Invalid parameters");
+        return -1;
+    }
+    
+    try {
+        auto* tts = static_cast<pocket_tts::PocketTTS*>(handle);
+        auto* voiceData = static_cast<VoiceData*>(voice);
+        
+        size_t total = tts->generateInto(text, voiceData->embeddings, voiceData->shape,
+                                         buffer, static_cast<size_t>(capacity));
+        *sample_count = static_cast<int>(total);
+        return total > static_cast<size_t>(capacity) ? 1 : 0;
+    } catch (const std::exception& e) {
+        setError(std::string("Failed to generate: ") + e.what());
+        return -1;
+    }
+}
+
+POCKET_TTS_API int pocket_tts_max_samples(PocketTTSHandle handle) {
+    if (!handle) {
+        setError("Invalid handle");
+        return -1;
+    }
+    return static_cast<int>(static_cast<pocket_tts::PocketTTS*>(handle)->maxSamples());
 }
 
 POCKET_TTS_API const char* pocket_tts_get_last_error(void) {
@@ -189,6 +368,21 @@ POCKET_TTS_API int pocket_tts_generate_streaming(
         if (config && config->chunk_size_frames > 0) {
             streamCfg.chunkSizeFrames = config->chunk_size_frames;
         }
+        if (config) {
+            streamCfg.pipelined = config->pipelined != 0;
+            if (config->queue_depth > 0) streamCfg.queueDepth = config->queue_depth;
+            if (config->chunk_schedule && config->chunk_schedule_length > 0) {
+                streamCfg.chunkSchedule.assign(config->chunk_schedule,
+                                               config->chunk_schedule + config->chunk_schedule_length);
+            }
+            if (config->first_chunk_frames > 0) streamCfg.firstChunkFrames = config->first_chunk_frames;
+            if (config->chunk_growth > 0) streamCfg.chunkGrowth = config->chunk_growth;
+            if (config->target_latency_ms > 0) streamCfg.targetLatencyMs = config->target_latency_ms;
+            if (config->fixed_seed) streamCfg.seed = toSeed(config->seed);
+            if (config->cancel_token) {
+                streamCfg.cancellation = *static_cast<pocket_tts::CancellationToken*>(config->cancel_token);
+            }
+        }
         streamCfg.enableCancellation = true;  // Always enable for C API
         
         // Call C++ streaming implementation
@@ -207,6 +401,102 @@ POCKET_TTS_API int pocket_tts_generate_streaming(
     }
 }
 
+POCKET_TTS_API int pocket_tts_get_last_stats(PocketTTSHandle handle, PocketTTSStats* stats) {
+    if (!handle || !stats) {
+        setError("Invalid handle or stats pointer");
+        return -1;
+    }
+    
+    const auto& s = static_cast<pocket_tts::PocketTTS*>(handle)->lastStats();
+    stats->text_tokens = s.textTokens;
+    stats->frames_generated = s.framesGenerated;
+    stats->eos_step = s.eosStep;
+    stats->audio_samples = s.audioSamples;
+    stats->voice_prefix_cached = s.voicePrefixCached ? 1 : 0;
+    stats->text_conditioner_runs = s.textConditioner.runs;
+    stats->text_conditioner_ms = s.textConditioner.totalMs;
+    stats->flow_lm_main_runs = s.flowLmMain.runs;
+    stats->flow_lm_main_ms = s.flowLmMain.totalMs;
+    stats->flow_lm_flow_runs = s.flowLmFlow.runs;
+    stats->flow_lm_flow_ms = s.flowLmFlow.totalMs;
+    stats->mimi_decoder_runs = s.mimiDecoder.runs;
+    stats->mimi_decoder_ms = s.mimiDecoder.totalMs;
+    stats->state_bytes_copied = s.stateBytesCopied;
+    stats->time_to_first_audio_ms = s.timeToFirstAudioMs;
+    stats->total_ms = s.totalMs;
+    stats->text_cached = s.textCached ? 1 : 0;
+    stats->audio_cached = s.audioCached ? 1 : 0;
+    stats->seed = s.seed;
+    stats->lm_state_bytes = s.lmStateBytes;
+    stats->context_reprimes = s.contextReprimes;
+    stats->prefetched = s.prefetched ? 1 : 0;
+    stats->cancelled = s.cancelled ? 1 : 0;
+    stats->state_bytes_allocated = s.stateBytesAllocated;
+    return 0;
+}
+
+POCKET_TTS_API int pocket_tts_prefetch(PocketTTSHandle handle, const char* text, VoiceHandle voice) {
+    if (!handle || !text || !voice) {
+        setError("Invalid parameters");
+        return -1;
+    }
+    
+    try {
+        auto* voiceData = static_cast<VoiceData*>(voice);
+        static_cast<pocket_tts::PocketTTS*>(handle)->prefetch(text, voiceData->embeddings, voiceData->shape);
+        return 0;
+    } catch (const std::exception& e) {
+        setError(std::string("Failed to prefetch: ") + e.what());
+        return -1;
+    }
+}
+
+POCKET_TTS_API int pocket_tts_get_memory_usage(PocketTTSHandle handle, PocketTTSMemoryUsage* usage) {
+    if (!handle || !usage) {
+        setError("Invalid handle or usage pointer");
+        return -1;
+    }
+    
+    try {
+        const auto u = static_cast<pocket_tts::PocketTTS*>(handle)->model()->memoryUsage();
+        usage->resident_bytes = u.residentBytes;
+        usage->peak_resident_bytes = u.peakResidentBytes;
+        usage->model_file_bytes = u.modelFileBytes;
+        usage->voice_cache_bytes = u.voiceCacheBytes;
+        usage->text_cache_bytes = u.textCacheBytes;
+        usage->audio_cache_bytes = u.audioCacheBytes;
+        return 0;
+    } catch (const std::exception& e) {
+        setError(std::string("Failed to get memory usage: ") + e.what());
+        return -1;
+    }
+}
+
+POCKET_TTS_API int pocket_tts_set_seed(PocketTTSHandle handle, int64_t seed) {
+    if (!handle) {
+        setError("Invalid handle");
+        return -1;
+    }
+    static_cast<pocket_tts::PocketTTS*>(handle)->setSeed(seed);
+    return 0;
+}
+
+POCKET_TTS_API int pocket_tts_set_flow(
+    PocketTTSHandle handle,
+    int solver,
+    int schedule,
+    int steps,
+    int post_eos_steps
+) {
+    pocket_tts::FlowConfig flow;
+    if (!handle || !toFlowConfig(solver, schedule, steps, post_eos_steps, flow)) {
+        setError("Invalid parameters");
+        return -1;
+    }
+    static_cast<pocket_tts::PocketTTS*>(handle)->setFlowConfig(flow);
+    return 0;
+}
+
 POCKET_TTS_API void pocket_tts_cancel_streaming(PocketTTSHandle handle) {
     if (!handle) {
         return;
@@ -220,6 +510,29 @@ POCKET_TTS_API void pocket_tts_cancel_streaming(PocketTTSHandle handle) {
     }
 }
 
+POCKET_TTS_API PocketTTSCancelToken pocket_tts_cancel_token_create(void) {
+    try {
+        return new pocket_tts::CancellationToken();
+    } catch (const std::exception& e) {
+        setError(std::string("Failed to create cancel token: ") + e.what());
+        return nullptr;
+    }
+}
+
+POCKET_TTS_API void pocket_tts_cancel_token_cancel(PocketTTSCancelToken token) {
+    if (token) {
+        static_cast<pocket_tts::CancellationToken*>(token)->cancel();
+    }
+}
+
+POCKET_TTS_API int pocket_tts_cancel_token_is_cancelled(PocketTTSCancelToken token) {
+    return token && static_cast<pocket_tts::CancellationToken*>(token)->cancelled() ? 1 : 0;
+}
+
+POCKET_TTS_API void pocket_tts_cancel_token_destroy(PocketTTSCancelToken token) {
+    delete static_cast<pocket_tts::CancellationToken*>(token);
+}
+
 POCKET_TTS_API const char* pocket_tts_version(void) {
     return VERSION;
 }
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>  // K32GetProcessMemoryInfo lives in kernel32; no psapi.lib needed
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace pocket_tts {
+
+/// Resident set size of the calling process, current and peak (0 if unknown)
+struct ProcessMemory {
+    size_t resident = 0;
+    size_t peakResident = 0;
+};
+
+inline ProcessMemory processMemory() {
+    ProcessMemory usage;
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        usage.resident = counters.WorkingSetSize;
+        usage.peakResident = counters.PeakWorkingSetSize;
+    }
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        usage.resident = static_cast<size_t>(info.resident_size);
+        usage.peakResident = static_cast<size_t>(info.resident_size_max);
+    }
+#else
+    // statm: total and resident pages
+    if (FILE* file = std::fopen("/proc/self/statm", "r")) {
+        unsigned long totalPages = 0, residentPages = 0;
+        if (std::fscanf(file, "%lu %lu", &totalPages, &residentPages) == 2) {
+            usage.resident = static_cast<size_t>(residentPages) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        }
+        std::fclose(file);
+    }
+    struct rusage self;
+    if (getrusage(RUSAGE_SELF, &self) == 0) {
+        usage.peakResident = static_cast<size_t>(self.ru_maxrss) * 1024;  // kilobytes
+    }
+#endif
+    return usage;
+}
+
+} // namespace pocket_tts
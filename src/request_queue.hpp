@@ -0,0 +1,174 @@
+#pragma once
+
+#include "pocket_tts/pocket_tts.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace pocket_tts {
+
+/**
+ * @brief Admission policy of BatchScheduler, independent of the engine
+ *
+ * Queued requests are ordered by priority, then deadline, then submission.
+ * Entries preempted at a frame boundary wait in a paused list, oldest
+ * first, and win ties against queued requests of the same priority.
+ * Entry is the scheduler's per-request state and needs `int id` and
+ * `BatchRequest request` members. Not thread-safe: the scheduler calls it
+ * under its own lock.
+ */
+template<typename Entry>
+class RequestQueue {
+public:
+    using EntryPtr = std::unique_ptr<Entry>;
+    using Clock = std::chrono::steady_clock;
+
+    /// Queue a request; returns its id
+    int submit(BatchRequest request) {
+        const int id = nextId_++;
+        queue_.emplace(Key{static_cast<int>(request.priority), request.deadline, id}, std::move(request));
+        return id;
+    }
+
+    /// Remove queued requests that were cancelled or are past their
+    /// deadline, calling onDropped(id, RequestStatus) for each
+    template<typename OnDropped>
+    void dropQueued(Clock::time_point now, OnDropped&& onDropped) {
+        for (auto it = queue_.begin(); it != queue_.end();) {
+            const auto& request = it->second;
+            if (request.cancellation.cancelled() || request.deadline <= now) {
+                onDropped(std::get<2>(it->first),
+                          request.cancellation.cancelled() ? RequestStatus::Cancelled : RequestStatus::Expired);
+                it = queue_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    /// Move cancelled entries out of active and paused into cancelled
+    void takeCancelled(std::vector<EntryPtr>& active, std::vector<EntryPtr>& cancelled) {
+        for (auto* list : {&paused_, &active}) {
+            for (auto it = list->begin(); it != list->end();) {
+                if ((*it)->request.cancellation.cancelled()) {
+                    cancelled.push_back(std::move(*it));
+                    it = list->erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Fill batch slots at a frame boundary
+     *
+     * Paused entries go straight back to active; queued requests become new
+     * entries in admitted, which the caller prefills and then appends to
+     * active. While active plus admitted hold capacity entries, a better
+     * waiting request pauses the lowest-priority, most recently submitted
+     * active entry for which canPreempt(entry) is true.
+     */
+    template<typename CanPreempt>
+    void admit(std::vector<EntryPtr>& active, std::vector<EntryPtr>& admitted, size_t capacity,
+               CanPreempt&& canPreempt) {
+        for (;;) {
+            // Best waiting request; paused ones win ties (they are older)
+            auto bestPaused = paused_.end();
+            for (auto it = paused_.begin(); it != paused_.end(); ++it) {
+                if (bestPaused == paused_.end() || (*it)->request.priority < (*bestPaused)->request.priority) {
+                    bestPaused = it;
+                }
+            }
+            const bool haveQueued = !queue_.empty();
+            if (bestPaused == paused_.end() && !haveQueued) return;
+
+            const bool resume = bestPaused != paused_.end() &&
+                (!haveQueued || (*bestPaused)->request.priority <= queue_.begin()->second.priority);
+            const int priority = resume ? static_cast<int>((*bestPaused)->request.priority)
+                                        : std::get<0>(queue_.begin()->first);
+
+            EntryPtr parked;
+            if (active.size() + admitted.size() >= capacity) {
+                auto victim = preemptible(active, priority, canPreempt);
+                if (victim == active.end()) return;
+                parked = std::move(*victim);
+                active.erase(victim);
+            }
+            if (resume) {
+                active.push_back(std::move(*bestPaused));
+                paused_.erase(bestPaused);
+            }
+            // Parked last so paused stays oldest first
+            if (parked) paused_.push_back(std::move(parked));
+            if (resume) continue;
+
+            auto entry = std::make_unique<Entry>();
+            entry->id = std::get<2>(queue_.begin()->first);
+            entry->request = std::move(queue_.begin()->second);
+            queue_.erase(queue_.begin());
+            admitted.push_back(std::move(entry));
+        }
+    }
+
+    /// Queued or Paused, or Unknown if the request is not waiting here
+    RequestStatus status(int id) const {
+        for (const auto& entry : paused_) {
+            if (entry->id == id) return RequestStatus::Paused;
+        }
+        for (const auto& [key, request] : queue_) {
+            if (std::get<2>(key) == id) return RequestStatus::Queued;
+        }
+        return RequestStatus::Unknown;
+    }
+
+    /// Cancel a queued or paused request; false if it is not waiting here
+    bool cancel(int id) const {
+        for (const auto& entry : paused_) {
+            if (entry->id == id) {
+                entry->request.cancellation.cancel();
+                return true;
+            }
+        }
+        for (const auto& [key, request] : queue_) {
+            if (std::get<2>(key) == id) {
+                request.cancellation.cancel();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t queuedCount() const { return queue_.size(); }
+    size_t pausedCount() const { return paused_.size(); }
+    bool empty() const { return queue_.empty() && paused_.empty(); }
+
+private:
+    using Key = std::tuple<int, Clock::time_point, int>;  // Priority, deadline, id
+
+    template<typename CanPreempt>
+    static typename std::vector<EntryPtr>::iterator preemptible(std::vector<EntryPtr>& active, int priority,
+                                                                 CanPreempt& canPreempt) {
+        auto victim = active.end();
+        for (auto it = active.begin(); it != active.end(); ++it) {
+            const int p = static_cast<int>((*it)->request.priority);
+            if (p <= priority || !canPreempt(**it)) continue;
+            if (victim == active.end() || p > static_cast<int>((*victim)->request.priority) ||
+                (p == static_cast<int>((*victim)->request.priority) && (*it)->id > (*victim)->id)) {
+                victim = it;
+            }
+        }
+        return victim;
+    }
+
+    std::map<Key, BatchRequest> queue_;
+    std::vector<EntryPtr> paused_;
+    int nextId_ = 0;
+};
+
+} // namespace pocket_tts
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pocket_tts {
+
+/**
+ * @brief Bounded lock-free single-producer / single-consumer ring buffer
+ *
+ * Exactly one thread may call tryPush() and exactly one other thread may
+ * call tryPop(). Slots are default-constructed up front and reused, so
+ * pushing moves into an existing element instead of allocating.
+ */
+template<typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity)
+        : slots_(capacity + 1) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /// Returns false (and leaves value untouched) when the queue is full
+    bool tryPush(T&& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t next = increment(tail);
+        if (next == head_.load(std::memory_order_acquire)) return false;
+        slots_[tail] = std::move(value);
+        tail_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /// Returns false when the queue is empty
+    bool tryPop(T& value) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) return false;
+        value = std::move(slots_[head]);
+        head_.store(increment(head), std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return slots_.size() - 1; }
+
+private:
+    size_t increment(size_t index) const {
+        return index + 1 == slots_.size() ? 0 : index + 1;
+    }
+
+    std::vector<T> slots_;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+};
+
+/**
+ * @brief Spin, then yield, then sleep while waiting on a SpscQueue
+ *
+ * Keeps hand-off latency low when the other side is about to make room or
+ * data available, without burning a core during long waits.
+ */
+class Backoff {
+public:
+    void pause() {
+        if (spins_ < 64) {
+            ++spins_;
+        } else if (spins_ < 128) {
+            ++spins_;
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    void reset() { spins_ = 0; }
+
+private:
+    int spins_ = 0;
+};
+
+} // namespace pocket_tts
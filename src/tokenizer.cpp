@@ -25,16 +25,19 @@ Tokenizer::Tokenizer(Tokenizer&&) noexcept = default;
 Tokenizer& Tokenizer::operator=(Tokenizer&&) noexcept = default;
 
 std::vector<int64_t> Tokenizer::encode(const std::string& text) const {
+    return encodeNormalized(normalize(text));
+}
+
+std::string Tokenizer::normalize(const std::string& text) {
     // Preprocess text like Python version
-    std::string processedText = text;
     
     // Trim whitespace
-    auto start = processedText.find_first_not_of(" \t\n\r");
-    auto end = processedText.find_last_not_of(" \t\n\r");
+    auto start = text.find_first_not_of(" \t\n\r");
+    auto end = text.find_last_not_of(" \t\n\r");
     if (start == std::string::npos) {
         throw std::runtime_error("Text cannot be empty");
     }
-    processedText = processedText.substr(start, end - start + 1);
+    std::string processedText = text.substr(start, end - start + 1);
     
     // Ensure proper punctuation at end
     char lastChar = processedText.back();
@@ -47,9 +50,13 @@ std::vector<int64_t> Tokenizer::encode(const std::string& text) const {
         processedText[0] = std::toupper(static_cast<unsigned char>(processedText[0]));
     }
     
+    return processedText;
+}
+
+std::vector<int64_t> Tokenizer::encodeNormalized(const std::string& normalizedText) const {
     // Encode with SentencePiece
     std::vector<int> ids;
-    auto status = impl_->processor.Encode(processedText, &ids);
+    auto status = impl_->processor.Encode(normalizedText, &ids);
     if (!status.ok()) {
         throw std::runtime_error("Tokenization failed: " + status.ToString());
     }
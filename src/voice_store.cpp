@@ -0,0 +1,226 @@
+#include "pocket_tts/voice_store.hpp"
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+
+namespace pocket_tts {
+
+namespace {
+
+constexpr char VOICE_MAGIC[8] = {'P', 'T', 'T', 'S', 'V', 'O', 'I', 'C'};
+constexpr uint64_t VOICE_DATA_OFFSET = 128;
+constexpr uint32_t MAX_VOICE_RANK = 4;
+
+// On-disk header, followed by padding up to VOICE_DATA_OFFSET
+struct VoiceFileHeader {
+    char magic[8];
+    uint32_t formatVersion;
+    uint32_t rank;
+    int64_t shape[MAX_VOICE_RANK];
+    uint64_t sourceHash;
+    uint64_t dataOffset;
+    uint64_t elementCount;
+    char modelVersion[32];  // NUL-padded
+};
+
+static_assert(sizeof(VoiceFileHeader) <= VOICE_DATA_OFFSET, "Voice header must fit before the data");
+
+// Product of the dims, or false if one is negative or it overflows
+bool shapeElements(const int64_t* shape, size_t rank, uint64_t& elements) {
+    elements = 1;
+    for (size_t i = 0; i < rank; ++i) {
+        if (shape[i] < 0) return false;
+        const auto dim = static_cast<uint64_t>(shape[i]);
+        if (dim != 0 && elements > std::numeric_limits<uint64_t>::max() / dim) return false;
+        elements *= dim;
+    }
+    return true;
+}
+
+std::string hashToHex(uint64_t hash) {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(hash));
+    return buf;
+}
+
+} // namespace
+
+uint64_t hashAudio(const float* samples, size_t count) {
+    uint64_t hash = 14695981039346656037ULL;
+    const auto* bytes = reinterpret_cast<const uint8_t*>(samples);
+    for (size_t i = 0; i < count * sizeof(float); ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void saveVoice(const std::string& path, const VoiceEmbedding& voice) {
+    if (voice.shape.empty() || voice.shape.size() > MAX_VOICE_RANK) {
+        throw std::runtime_error("Voice shape must have 1 to 4 dimensions");
+    }
+    uint64_t elements = 0;
+    if (!shapeElements(voice.shape.data(), voice.shape.size(), elements) ||
+        elements != voice.embeddings.size()) {
+        throw std::runtime_error("Voice shape does not match its embeddings");
+    }
+
+    VoiceFileHeader header{};
+    std::memcpy(header.magic, VOICE_MAGIC, sizeof(VOICE_MAGIC));
+    header.formatVersion = VOICE_FILE_FORMAT_VERSION;
+    header.rank = static_cast<uint32_t>(voice.shape.size());
+    std::copy(voice.shape.begin(), voice.shape.end(), header.shape);
+    header.sourceHash = voice.sourceHash;
+    header.dataOffset = VOICE_DATA_OFFSET;
+    header.elementCount = voice.embeddings.size();
+    std::strncpy(header.modelVersion, voice.modelVersion.c_str(), sizeof(header.modelVersion) - 1);
+
+    // Write to a temporary file and rename so readers never see a partial voice
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Failed to create voice file: " + path);
+        }
+
+        char padded[VOICE_DATA_OFFSET] = {};
+        std::memcpy(padded, &header, sizeof(header));
+        file.write(padded, sizeof(padded));
+        file.write(reinterpret_cast<const char*>(voice.embeddings.data()),
+                   static_cast<std::streamsize>(voice.embeddings.size() * sizeof(float)));
+        if (!file) {
+            throw std::runtime_error("Failed to write voice file: " + path);
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmpPath, ec);
+        throw std::runtime_error("Failed to write voice file: " + path);
+    }
+}
+
+VoiceEmbedding loadVoice(const std::string& path) {
+    MappedFile file(path);
+
+    VoiceFileHeader header;
+    if (file.size() < sizeof(header)) {
+        throw std::runtime_error("Not a voice file: " + path);
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, VOICE_MAGIC, sizeof(VOICE_MAGIC)) != 0) {
+        throw std::runtime_error("Not a voice file: " + path);
+    }
+    if (header.formatVersion != VOICE_FILE_FORMAT_VERSION) {
+        throw std::runtime_error("Unsupported voice file version " +
+                                 std::to_string(header.formatVersion) + ": " + path);
+    }
+    // Every size comes from the file, so check it without overflowing
+    uint64_t elements = 0;
+    if (header.rank == 0 || header.rank > MAX_VOICE_RANK ||
+        !shapeElements(header.shape, header.rank, elements) || elements != header.elementCount ||
+        header.dataOffset < sizeof(VoiceFileHeader) || header.dataOffset > file.size() ||
+        header.elementCount > (file.size() - header.dataOffset) / sizeof(float)) {
+        throw std::runtime_error("Corrupt voice file: " + path);
+    }
+
+    VoiceEmbedding voice;
+    voice.shape.assign(header.shape, header.shape + header.rank);
+    voice.sourceHash = header.sourceHash;
+    voice.modelVersion.assign(header.modelVersion,
+                              strnlen(header.modelVersion, sizeof(header.modelVersion)));
+
+    // memcpy: dataOffset need not be float-aligned in a foreign file
+    voice.embeddings.resize(static_cast<size_t>(header.elementCount));
+    std::memcpy(voice.embeddings.data(), file.data() + header.dataOffset,
+                voice.embeddings.size() * sizeof(float));
+    return voice;
+}
+
+// ── VoiceLibrary ───────────────────────────────────────────────────────
+
+struct VoiceLibrary::Impl {
+    std::filesystem::path directory;
+
+    mutable std::mutex mutex;
+    std::set<uint64_t> known;  // Hashes present on disk
+    std::map<uint64_t, std::shared_ptr<const VoiceEmbedding>> loaded;
+
+    explicit Impl(const std::string& dir) : directory(dir) {
+        std::filesystem::create_directories(directory);
+
+        for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+            if (!entry.is_regular_file() || entry.path().extension() != VOICE_FILE_EXTENSION) {
+                continue;
+            }
+            const std::string stem = entry.path().stem().string();
+            if (stem.size() != 16 || stem.find_first_not_of("0123456789abcdef") != std::string::npos) {
+                continue;
+            }
+            known.insert(std::stoull(stem, nullptr, 16));
+        }
+    }
+
+    std::string pathFor(uint64_t hash) const {
+        return (directory / (hashToHex(hash) + VOICE_FILE_EXTENSION)).string();
+    }
+};
+
+VoiceLibrary::VoiceLibrary(const std::string& directory)
+    : impl_(std::make_unique<Impl>(directory)) {}
+
+VoiceLibrary::~VoiceLibrary() = default;
+
+void VoiceLibrary::put(const VoiceEmbedding& voice) {
+    saveVoice(impl_->pathFor(voice.sourceHash), voice);
+
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->known.insert(voice.sourceHash);
+    impl_->loaded[voice.sourceHash] = std::make_shared<const VoiceEmbedding>(voice);
+}
+
+std::shared_ptr<const VoiceEmbedding> VoiceLibrary::get(uint64_t sourceHash) {
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        auto it = impl_->loaded.find(sourceHash);
+        if (it != impl_->loaded.end()) {
+            return it->second;
+        }
+        if (!impl_->known.count(sourceHash)) {
+            return nullptr;
+        }
+    }
+
+    // Map outside the lock so cold loads of different voices don't serialise
+    auto voice = std::make_shared<const VoiceEmbedding>(loadVoice(impl_->pathFor(sourceHash)));
+
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->loaded.emplace(sourceHash, std::move(voice)).first->second;
+}
+
+bool VoiceLibrary::contains(uint64_t sourceHash) const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->known.count(sourceHash) > 0;
+}
+
+std::vector<uint64_t> VoiceLibrary::list() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return std::vector<uint64_t>(impl_->known.begin(), impl_->known.end());
+}
+
+std::string VoiceLibrary::pathFor(uint64_t sourceHash) const {
+    return impl_->pathFor(sourceHash);
+}
+
+} // namespace pocket_tts
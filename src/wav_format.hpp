@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+namespace pocket_tts {
+
+// ── WAV format structures ──────────────────────────────────────────────
+
+#pragma pack(push, 1)
+struct WavHeader {
+    char     riffId[4];       // "RIFF"
+    uint32_t fileSize;        // file size - 8
+    char     waveId[4];       // "WAVE"
+};
+
+struct WavChunkHeader {
+    char     id[4];
+    uint32_t size;
+};
+
+struct WavFmtChunk {
+    uint16_t audioFormat;     // 1 = PCM, 3 = IEEE float
+    uint16_t numChannels;
+    uint32_t sampleRate;
+    uint32_t byteRate;
+    uint16_t blockAlign;
+    uint16_t bitsPerSample;
+};
+
+// Canonical 44-byte header of a mono file with one fmt and one data chunk
+struct WavFileHeader {
+    WavHeader      riff;
+    WavChunkHeader fmtHeader;
+    WavFmtChunk    fmt;
+    WavChunkHeader dataHeader;
+};
+#pragma pack(pop)
+
+inline bool chunkIdEquals(const char id[4], const char* tag) {
+    return id[0] == tag[0] && id[1] == tag[1] && id[2] == tag[2] && id[3] == tag[3];
+}
+
+inline void copyChunkId(char id[4], const char* tag) {
+    id[0] = tag[0]; id[1] = tag[1]; id[2] = tag[2]; id[3] = tag[3];
+}
+
+// Header for mono audio; audioFormat 1 = PCM, 3 = IEEE float
+inline WavFileHeader makeWavHeader(uint16_t audioFormat, uint16_t bitsPerSample,
+                                   uint32_t sampleRate, uint32_t dataSize) {
+    WavFileHeader h{};
+    copyChunkId(h.riff.riffId, "RIFF");
+    h.riff.fileSize = 4 + (8 + sizeof(WavFmtChunk)) + (8 + dataSize);
+    copyChunkId(h.riff.waveId, "WAVE");
+    copyChunkId(h.fmtHeader.id, "fmt ");
+    h.fmtHeader.size = sizeof(WavFmtChunk);
+    h.fmt.audioFormat = audioFormat;
+    h.fmt.numChannels = 1;
+    h.fmt.sampleRate = sampleRate;
+    h.fmt.bitsPerSample = bitsPerSample;
+    h.fmt.blockAlign = static_cast<uint16_t>(h.fmt.numChannels * (bitsPerSample / 8));
+    h.fmt.byteRate = sampleRate * h.fmt.blockAlign;
+    copyChunkId(h.dataHeader.id, "data");
+    h.dataHeader.size = dataSize;
+    return h;
+}
+
+} // namespace pocket_tts
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pocket_tts {
+
+/**
+ * @brief Fixed set of threads running parallel-for jobs
+ *
+ * The calling thread takes part in the work, and run() returns once every
+ * index has been processed. The first exception thrown by a job is
+ * rethrown from run().
+ */
+class WorkerPool {
+public:
+    explicit WorkerPool(int numThreads) {
+        for (int i = 0; i < numThreads; ++i) {
+            threads_.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /// Call fn(i) for every i in [0, count), spread across the pool
+    void run(size_t count, const std::function<void(size_t)>& fn) {
+        if (count == 0) return;
+
+        std::lock_guard<std::mutex> runLock(runMutex_);
+        if (threads_.empty() || count == 1) {
+            for (size_t i = 0; i < count; ++i) fn(i);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &fn;
+            count_ = count;
+            next_ = 0;
+            pending_ = count;
+            error_ = nullptr;
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        work();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return pending_ == 0; });
+        job_ = nullptr;
+        if (error_) {
+            auto error = error_;
+            error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    int size() const { return static_cast<int>(threads_.size()); }
+
+private:
+    void work() {
+        for (;;) {
+            const std::function<void(size_t)>* job;
+            size_t index;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!job_ || next_ >= count_) return;
+                job = job_;
+                index = next_++;
+            }
+
+            try {
+                (*job)(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) error_ = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) done_.notify_all();
+        }
+    }
+
+    void workerLoop() {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                if (stopping_) return;
+                seen = generation_;
+            }
+            work();
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::mutex runMutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t)>* job_ = nullptr;
+    size_t count_ = 0;
+    size_t next_ = 0;
+    size_t pending_ = 0;
+    uint64_t generation_ = 0;
+    std::exception_ptr error_;
+    bool stopping_ = false;
+};
+
+} // namespace pocket_tts
@@ -14,6 +14,7 @@ namespace PocketTTS
         public IntPtr Data;
         public int SampleCount;
         public int SampleRate;
+        public IntPtr Owner;
     }
 
     /// <summary>
@@ -30,6 +31,18 @@ namespace PocketTTS
     {
         public int ChunkSizeFrames;
         public IntPtr UserData;
+        public int Pipelined;
+        public int QueueDepth;
+        public IntPtr ChunkSchedule;
+        public int ChunkScheduleLength;
+        public int FirstChunkFrames;
+        public float ChunkGrowth;
+        public float TargetLatencyMs;
+
+        public int FixedSeed;
+        public ulong Seed;
+
+        public IntPtr CancelToken;
     }
 
     /// <summary>
@@ -50,6 +63,106 @@ namespace PocketTTS
         public float Temperature;
         public int LsdSteps;
         public int MaxFrames;
+
+        public int IntraOpThreads;
+        public int InterOpThreads;
+        public int DisableSpinning;
+
+        [MarshalAs(UnmanagedType.LPStr)]
+        public string ThreadAffinity;
+
+        public int TextConditionerThreads;
+        public int FlowLmMainThreads;
+        public int FlowLmFlowThreads;
+        public int MimiDecoderThreads;
+        public int MimiEncoderThreads;
+
+        [MarshalAs(UnmanagedType.LPStr)]
+        public string ExecutionProvider;
+
+        public int DeviceId;
+
+        public IntPtr StageTimingCallback;
+        public IntPtr StageTimingUserData;
+
+        [MarshalAs(UnmanagedType.LPStr)]
+        public string OptimizedModelCacheDir;
+
+        public int LazyLoad;
+        public int DisablePrepackedSharing;
+        public int DisableModelMapping;
+
+        public int FlowSolver;
+        public int FlowSchedule;
+        public int PostEosLsdSteps;
+
+        public int DisableOverlapDecode;
+
+        public int TextCacheMb;
+        public int AudioCacheMb;
+
+        public int FixedSeed;
+        public ulong Seed;
+
+        public int ContextWindowFrames;
+        public int ContextKeepFrames;
+
+        public int GlobalThreadPools;
+        public int DisableCpuArena;
+        public int SharedArena;
+        [MarshalAs(UnmanagedType.LPStr)]
+        public string ArenaExtendStrategy;
+        public int ArenaMaxMb;
+        public int ArenaShrinkage;
+    }
+
+    /// <summary>
+    /// Counters of the last generate call.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct GenerationStats
+    {
+        public int TextTokens;
+        public int FramesGenerated;
+        public int EosStep;
+        public int AudioSamples;
+        public int VoicePrefixCached;
+
+        public int TextConditionerRuns;
+        public double TextConditionerMs;
+        public int FlowLmMainRuns;
+        public double FlowLmMainMs;
+        public int FlowLmFlowRuns;
+        public double FlowLmFlowMs;
+        public int MimiDecoderRuns;
+        public double MimiDecoderMs;
+
+        public ulong StateBytesCopied;
+        public double TimeToFirstAudioMs;
+        public double TotalMs;
+
+        public int TextCached;
+        public int AudioCached;
+        public ulong Seed;
+        public ulong LmStateBytes;
+        public int ContextReprimes;
+        public int Prefetched;
+        public int Cancelled;
+        public ulong StateBytesAllocated;
+    }
+
+    /// <summary>
+    /// Process and cache memory of a model, in bytes.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct MemoryUsage
+    {
+        public ulong ResidentBytes;
+        public ulong PeakResidentBytes;
+        public ulong ModelFileBytes;
+        public ulong VoiceCacheBytes;
+        public ulong TextCacheBytes;
+        public ulong AudioCacheBytes;
     }
 
     /// <summary>
@@ -65,10 +178,30 @@ namespace PocketTTS
         [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
         public static extern void pocket_tts_destroy(IntPtr handle);
 
+        [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr pocket_tts_model_create(IntPtr config);
+
+        [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void pocket_tts_model_destroy(IntPtr model);
+
+        [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr pocket_tts_create_from_model(IntPtr model);
+
         [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
         public static extern IntPtr pocket_tts_encode_voice(IntPtr handle,
             [MarshalAs(UnmanagedType.LPStr)] string audioPath);
 
+        [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr pocket_tts_load_voice(
+            [MarshalAs(UnmanagedType.LPStr)] string voicePath);
+
+        [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int pocket_tts_save_voice(IntPtr voice,
+            [MarshalAs(UnmanagedType.LPStr)] string voicePath);
+
+        [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern ulong pocket_tts_voice_hash(IntPtr voice);
+
         [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
         public static extern void pocket_tts_free_voice(IntPtr voice);
 
@@ -97,9 +230,32 @@ namespace PocketTTS
             AudioChunkCallback callback,
             IntPtr config);  // Overload for null config
 
+        [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int pocket_tts_get_last_stats(IntPtr handle, out GenerationStats stats);
+
+        [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int pocket_tts_prefetch(IntPtr handle,
+            [MarshalAs(UnmanagedType.LPStr)] string text,
+            IntPtr voice);
+
+        [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int pocket_tts_get_memory_usage(IntPtr handle, out MemoryUsage usage);
+
         [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
         public static extern void pocket_tts_cancel_streaming(IntPtr handle);
 
+        [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr pocket_tts_cancel_token_create();
+
+        [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void pocket_tts_cancel_token_cancel(IntPtr token);
+
+        [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int pocket_tts_cancel_token_is_cancelled(IntPtr token);
+
+        [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void pocket_tts_cancel_token_destroy(IntPtr token);
+
         [DllImport(LibName, CallingConvention = CallingConvention.Cdecl)]
         public static extern IntPtr pocket_tts_get_last_error();
 
@@ -277,6 +433,47 @@ namespace PocketTTS
                 throw error;
         }
 
+        /// <summary>
+        /// Stats of the last Generate or GenerateStreaming call.
+        /// </summary>
+        public GenerationStats LastStats
+        {
+            get
+            {
+                if (PocketTTSNative.pocket_tts_get_last_stats(_handle, out var stats) != 0)
+                {
+                    throw new Exception($"Failed to get stats: {GetLastError()}");
+                }
+                return stats;
+            }
+        }
+
+        /// <summary>
+        /// Prepare the next sentence in the background while the current one plays.
+        /// </summary>
+        public void Prefetch(string text, Voice voice)
+        {
+            if (PocketTTSNative.pocket_tts_prefetch(_handle, text, voice.Handle) != 0)
+            {
+                throw new Exception($"Failed to prefetch: {GetLastError()}");
+            }
+        }
+
+        /// <summary>
+        /// Process RSS and the model's cache sizes.
+        /// </summary>
+        public MemoryUsage MemoryUsage
+        {
+            get
+            {
+                if (PocketTTSNative.pocket_tts_get_memory_usage(_handle, out var usage) != 0)
+                {
+                    throw new Exception($"Failed to get memory usage: {GetLastError()}");
+                }
+                return usage;
+            }
+        }
+
         /// <summary>
         /// Cancel ongoing streaming generation.
         /// </summary>
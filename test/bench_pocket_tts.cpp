@@ -0,0 +1,382 @@
+#include "pocket_tts/pocket_tts.hpp"
+#include "pocket_tts/voice_store.hpp"
+#include "process_memory.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Fixed corpus so numbers are comparable across releases
+const std::vector<std::string> CORPUS = {
+    "Hello, world!",
+    "The quick brown fox jumps over the lazy dog.",
+    "Streaming speech synthesis lets a voice assistant start talking before the full answer is ready.",
+    "On a clear autumn morning, the old lighthouse keeper climbed the spiral stairs one last time, "
+    "counting each of the two hundred steps as he had done for forty years.",
+};
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Distribution {
+    std::vector<double> samples;
+
+    void add(double v) { samples.push_back(v); }
+
+    double percentile(double p) const {
+        if (samples.empty()) return 0.0;
+        std::vector<double> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+        size_t idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[std::min(idx, sorted.size() - 1)];
+    }
+
+    double mean() const {
+        if (samples.empty()) return 0.0;
+        double sum = 0.0;
+        for (double v : samples) sum += v;
+        return sum / static_cast<double>(samples.size());
+    }
+
+    std::string json() const {
+        std::ostringstream out;
+        out << "{\"count\": " << samples.size()
+            << ", \"mean\": " << mean()
+            << ", \"p50\": " << percentile(0.5)
+            << ", \"p90\": " << percentile(0.9)
+            << ", \"p99\": " << percentile(0.99)
+            << ", \"max\": " << percentile(1.0) << "}";
+        return out.str();
+    }
+};
+
+struct BenchCase {
+    std::string precision;
+    int lsdSteps;
+    int threads;
+    int chunkSize;
+    pocket_tts::FlowSolver solver;
+    pocket_tts::FlowSchedule schedule;
+};
+
+struct BenchResult {
+    BenchCase params;
+    double loadMs = 0.0;
+    std::map<std::string, Distribution> stages;
+    Distribution timeToFirstChunkMs;
+    Distribution rtfx;
+    Distribution flowRunsPerFrame;
+    Distribution snrDb;           // --quality: against the reference integration
+    double audioSeconds = 0.0;
+    double wallSeconds = 0.0;
+    size_t peakRss = 0;
+};
+
+std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+std::vector<int> splitInts(const std::string& value) {
+    std::vector<int> items;
+    for (const auto& item : splitList(value)) items.push_back(std::stoi(item));
+    return items;
+}
+
+// Signal-to-noise ratio of audio against reference over their common length
+double snrDb(const std::vector<float>& reference, const std::vector<float>& audio) {
+    const size_t n = std::min(reference.size(), audio.size());
+    double signal = 0.0;
+    double noise = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        signal += static_cast<double>(reference[i]) * reference[i];
+        const double diff = static_cast<double>(reference[i]) - audio[i];
+        noise += diff * diff;
+    }
+    // Length mismatch (EOS moved) counts as error too
+    for (size_t i = n; i < reference.size(); ++i) noise += static_cast<double>(reference[i]) * reference[i];
+    for (size_t i = n; i < audio.size(); ++i) noise += static_cast<double>(audio[i]) * audio[i];
+    if (noise <= 0.0) return 120.0;
+    return 10.0 * std::log10(std::max(signal, 1e-12) / noise);
+}
+
+void printUsage(const char* progName) {
+    std::cout << "Pocket TTS benchmark\n\n";
+    std::cout << "Usage: " << progName << " [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --models-dir <path>   Models directory (default: models/onnx)\n";
+    std::cout << "  --tokenizer <path>    Tokenizer path (default: models/tokenizer.model)\n";
+    std::cout << "  --voice <path>        Reference WAV or .ptv voice (default: models/reference_sample.wav)\n";
+    std::cout << "  --precisions <list>   Comma-separated, e.g. int8,fp32 (default: int8)\n";
+    std::cout << "  --lsd-steps <list>    Comma-separated (default: 10)\n";
+    std::cout << "  --threads <list>      Intra-op threads, comma-separated (default: 3)\n";
+    std::cout << "  --chunk-sizes <list>  Streaming chunk sizes in frames (default: 5)\n";
+    std::cout << "  --solvers <list>      Flow solvers: euler,heun (default: euler)\n";
+    std::cout << "  --schedules <list>    Flow time grids: uniform,cosine,quadratic (default: uniform)\n";
+    std::cout << "  --post-eos-steps <n>  Flow steps after EOS (default: same as --lsd-steps)\n";
+    std::cout << "  --quality             Also score each setting against a 64-step Euler reference\n";
+    std::cout << "                        (SNR in dB; runs everything at temperature 0)\n";
+    std::cout << "  --runs <n>            Measured passes over the corpus (default: 3)\n";
+    std::cout << "  --no-prefix-cache     Run the voice prefill on every request\n";
+    std::cout << "  --json <path>         Write results as JSON\n";
+    std::cout << "  -h, --help            Show this help message\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string modelsDir = "models/onnx";
+    std::string tokenizerPath = "models/tokenizer.model";
+    std::string voicePath = "models/reference_sample.wav";
+    std::vector<std::string> precisions = {"int8"};
+    std::vector<int> lsdSteps = {10};
+    std::vector<int> threads = {3};
+    std::vector<int> chunkSizes = {5};
+    std::vector<pocket_tts::FlowSolver> solvers = {pocket_tts::FlowSolver::Euler};
+    std::vector<pocket_tts::FlowSchedule> schedules = {pocket_tts::FlowSchedule::Uniform};
+    int postEosSteps = 0;
+    bool quality = false;
+    int runs = 3;
+    bool prefixCache = true;
+    std::string jsonPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "--models-dir" && i + 1 < argc) {
+            modelsDir = argv[++i];
+        } else if (arg == "--tokenizer" && i + 1 < argc) {
+            tokenizerPath = argv[++i];
+        } else if (arg == "--voice" && i + 1 < argc) {
+            voicePath = argv[++i];
+        } else if (arg == "--precisions" && i + 1 < argc) {
+            precisions = splitList(argv[++i]);
+        } else if (arg == "--lsd-steps" && i + 1 < argc) {
+            lsdSteps = splitInts(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = splitInts(argv[++i]);
+        } else if (arg == "--chunk-sizes" && i + 1 < argc) {
+            chunkSizes = splitInts(argv[++i]);
+        } else if (arg == "--solvers" && i + 1 < argc) {
+            solvers.clear();
+            for (const auto& name : splitList(argv[++i])) solvers.push_back(pocket_tts::parseFlowSolver(name));
+        } else if (arg == "--schedules" && i + 1 < argc) {
+            schedules.clear();
+            for (const auto& name : splitList(argv[++i])) schedules.push_back(pocket_tts::parseFlowSchedule(name));
+        } else if (arg == "--post-eos-steps" && i + 1 < argc) {
+            postEosSteps = std::stoi(argv[++i]);
+        } else if (arg == "--quality") {
+            quality = true;
+        } else if (arg == "--runs" && i + 1 < argc) {
+            runs = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--no-prefix-cache") {
+            prefixCache = false;
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    const std::string ext = pocket_tts::VOICE_FILE_EXTENSION;
+    const bool savedVoice = voicePath.size() > ext.size() &&
+                            voicePath.compare(voicePath.size() - ext.size(), ext.size(), ext) == 0;
+
+    std::vector<BenchResult> results;
+    // Reference audio per precision and corpus entry for --quality
+    std::map<std::string, std::vector<std::vector<float>>> references;
+
+    try {
+        std::vector<BenchCase> cases;
+        for (const auto& precision : precisions)
+            for (int steps : lsdSteps)
+                for (int threadCount : threads)
+                    for (int chunkSize : chunkSizes)
+                        for (auto solver : solvers)
+                            for (auto schedule : schedules)
+                                cases.push_back({precision, steps, threadCount, chunkSize, solver, schedule});
+
+        for (const auto& params : cases) {
+            const auto& precision = params.precision;
+            const int steps = params.lsdSteps;
+            const int threadCount = params.threads;
+            const int chunkSize = params.chunkSize;
+            const auto solver = params.solver;
+            const auto schedule = params.schedule;
+
+            BenchResult result;
+            result.params = params;
+
+            std::mutex stageMutex;
+            bool recording = false;
+
+            pocket_tts::PocketTTSConfig config;
+            config.modelsDir = modelsDir;
+            config.tokenizerPath = tokenizerPath;
+            config.precision = precision;
+            config.lsdSteps = steps;
+            config.intraOpThreads = threadCount;
+            config.loadVoiceEncoder = !savedVoice;
+            config.voicePrefixCacheSize = prefixCache ? config.voicePrefixCacheSize : 0;
+            config.verbose = false;
+            config.temperature = quality ? 0.0f : config.temperature;
+            config.flow.solver = solver;
+            config.flow.schedule = schedule;
+            config.flow.postEosSteps = postEosSteps;
+            config.onStageTiming = [&](pocket_tts::Stage stage, double ms) {
+                std::lock_guard<std::mutex> lock(stageMutex);
+                if (recording) result.stages[pocket_tts::stageName(stage)].add(ms);
+            };
+
+            std::cout << precision << " lsd=" << steps << " " << pocket_tts::flowSolverName(solver)
+                      << "/" << pocket_tts::flowScheduleName(schedule) << " threads=" << threadCount
+                      << " chunk=" << chunkSize << " ..." << std::flush;
+
+            auto loadStart = Clock::now();
+            pocket_tts::PocketTTS tts(config);
+            result.loadMs = msSince(loadStart);
+
+            auto voice = savedVoice ? pocket_tts::loadVoice(voicePath)
+                                    : tts.encodeVoiceEmbedding(voicePath);
+
+            pocket_tts::StreamingConfig streamCfg;
+            streamCfg.chunkSizeFrames = chunkSize;
+
+            auto runOnce = [&](const std::string& text, bool measure) {
+                auto start = Clock::now();
+                bool gotFirst = false;
+                int samples = tts.generateStreaming(
+                    text, voice.embeddings, voice.shape,
+                    [&](const float*, int, bool) {
+                        if (!gotFirst && measure) {
+                            result.timeToFirstChunkMs.add(msSince(start));
+                        }
+                        gotFirst = true;
+                    },
+                    streamCfg);
+                double wall = msSince(start) / 1000.0;
+                const auto& stats = tts.lastStats();
+                if (measure && stats.framesGenerated > 0) {
+                    result.flowRunsPerFrame.add(static_cast<double>(stats.flowLmFlow.runs) /
+                                                stats.framesGenerated);
+                }
+                if (measure && wall > 0.0) {
+                    double audio = static_cast<double>(samples) / pocket_tts::PocketTTS::SAMPLE_RATE;
+                    result.rtfx.add(audio / wall);
+                    result.audioSeconds += audio;
+                    result.wallSeconds += wall;
+                }
+            };
+
+            // Warm-up pass (allocations, prefix cache, page faults)
+            runOnce(CORPUS.front(), false);
+
+            {
+                std::lock_guard<std::mutex> lock(stageMutex);
+                recording = true;
+            }
+            for (int run = 0; run < runs; ++run) {
+                for (const auto& text : CORPUS) {
+                    runOnce(text, true);
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(stageMutex);
+                recording = false;
+            }
+
+            if (quality) {
+                auto& reference = references[precision];
+                const auto flow = tts.flowConfig();
+                if (reference.empty()) {
+                    pocket_tts::FlowConfig referenceFlow;
+                    referenceFlow.steps = 64;
+                    referenceFlow.solver = pocket_tts::FlowSolver::Euler;
+                    tts.setFlowConfig(referenceFlow);
+                    for (const auto& text : CORPUS) {
+                        reference.push_back(tts.generateWithEmbeddings(text, voice.embeddings, voice.shape));
+                    }
+                    tts.setFlowConfig(flow);
+                }
+                for (size_t t = 0; t < CORPUS.size(); ++t) {
+                    auto audio = tts.generateWithEmbeddings(CORPUS[t], voice.embeddings, voice.shape);
+                    result.snrDb.add(snrDb(reference[t], audio));
+                }
+            }
+
+            result.peakRss = pocket_tts::processMemory().peakResident;
+            std::printf(" RTFx %.2f, TTFC p50 %.1f ms, main_step p50 %.2f ms, flow runs/frame %.1f",
+                        result.wallSeconds > 0 ? result.audioSeconds / result.wallSeconds : 0.0,
+                        result.timeToFirstChunkMs.percentile(0.5),
+                        result.stages["main_step"].percentile(0.5),
+                        result.flowRunsPerFrame.mean());
+            if (quality) std::printf(", SNR %.1f dB", result.snrDb.mean());
+            std::printf("\n");
+            results.push_back(std::move(result));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "\nError: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        if (!out) {
+            std::cerr << "Failed to write " << jsonPath << std::endl;
+            return 1;
+        }
+        out << "{\n  \"version\": \"1.0.0\",\n  \"runs\": " << runs
+            << ",\n  \"prefix_cache\": " << (prefixCache ? "true" : "false")
+            << ",\n  \"post_eos_steps\": " << postEosSteps
+            << ",\n  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const auto& r = results[i];
+            out << "    {\n";
+            out << "      \"precision\": \"" << r.params.precision << "\",\n";
+            out << "      \"lsd_steps\": " << r.params.lsdSteps << ",\n";
+            out << "      \"solver\": \"" << pocket_tts::flowSolverName(r.params.solver) << "\",\n";
+            out << "      \"schedule\": \"" << pocket_tts::flowScheduleName(r.params.schedule) << "\",\n";
+            out << "      \"threads\": " << r.params.threads << ",\n";
+            out << "      \"chunk_size\": " << r.params.chunkSize << ",\n";
+            out << "      \"load_ms\": " << r.loadMs << ",\n";
+            out << "      \"rtfx\": " << (r.wallSeconds > 0 ? r.audioSeconds / r.wallSeconds : 0.0) << ",\n";
+            out << "      \"rtfx_per_utterance\": " << r.rtfx.json() << ",\n";
+            out << "      \"time_to_first_chunk_ms\": " << r.timeToFirstChunkMs.json() << ",\n";
+            out << "      \"flow_runs_per_frame\": " << r.flowRunsPerFrame.json() << ",\n";
+            if (quality) out << "      \"snr_db\": " << r.snrDb.json() << ",\n";
+            out << "      \"peak_rss_bytes\": " << r.peakRss << ",\n";
+            out << "      \"stages_ms\": {";
+            bool first = true;
+            for (const auto& [name, dist] : r.stages) {
+                out << (first ? "\n" : ",\n") << "        \"" << name << "\": " << dist.json();
+                first = false;
+            }
+            out << "\n      }\n    }" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        std::cout << "Wrote " << jsonPath << std::endl;
+    }
+
+    return 0;
+}
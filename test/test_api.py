@@ -69,7 +69,8 @@ class AudioResult(ctypes.Structure):
     _fields_ = [
         ('data', ctypes.POINTER(ctypes.c_float)),
         ('sample_count', ctypes.c_int),
-        ('sample_rate', ctypes.c_int)
+        ('sample_rate', ctypes.c_int),
+        ('owner', ctypes.c_void_p)
     ]
 
 
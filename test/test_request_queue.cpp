@@ -0,0 +1,216 @@
+#include "request_queue.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using pocket_tts::BatchRequest;
+using pocket_tts::RequestPriority;
+using pocket_tts::RequestStatus;
+using Clock = std::chrono::steady_clock;
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "[PASS] " : "[FAIL] ") << what << std::endl;
+    if (!ok) ++failures;
+}
+
+// Stand-in for BatchScheduler's per-request state; no engine involved
+struct Entry {
+    int id = -1;
+    BatchRequest request;
+    bool finished = false;
+};
+
+using Queue = pocket_tts::RequestQueue<Entry>;
+using Entries = std::vector<std::unique_ptr<Entry>>;
+
+BatchRequest makeRequest(RequestPriority priority, Clock::time_point deadline = Clock::time_point::max()) {
+    BatchRequest request;
+    request.priority = priority;
+    request.deadline = deadline;
+    return request;
+}
+
+// One frame boundary of the scheduler: admit into active with the
+// default preemption rule; returns the ids of newly admitted entries
+std::vector<int> admit(Queue& queue, Entries& active, size_t capacity) {
+    Entries admitted;
+    queue.admit(active, admitted, capacity, [](const Entry& e) { return !e.finished; });
+    std::vector<int> ids;
+    for (auto& entry : admitted) {
+        ids.push_back(entry->id);
+        active.push_back(std::move(entry));
+    }
+    return ids;
+}
+
+std::vector<int> activeIds(const Entries& active) {
+    std::vector<int> ids;
+    for (const auto& entry : active) ids.push_back(entry->id);
+    return ids;
+}
+
+// Run to completion one at a time, returning the admission order
+std::vector<int> drain(Queue& queue) {
+    Entries active;
+    std::vector<int> order;
+    while (!queue.empty()) {
+        for (int id : admit(queue, active, 1)) order.push_back(id);
+        active.clear();
+    }
+    return order;
+}
+
+void testPriorityOrder() {
+    Queue queue;
+    const int bulk = queue.submit(makeRequest(RequestPriority::Bulk));
+    const int normal = queue.submit(makeRequest(RequestPriority::Normal));
+    const int interactive = queue.submit(makeRequest(RequestPriority::Interactive));
+    check(queue.queuedCount() == 3 && queue.status(normal) == RequestStatus::Queued, "submitted requests are queued");
+    check(drain(queue) == std::vector<int>{interactive, normal, bulk}, "admitted by priority class");
+}
+
+void testDeadlineOrder() {
+    const auto now = Clock::now();
+    Queue queue;
+    const int noDeadline = queue.submit(makeRequest(RequestPriority::Normal));
+    const int late = queue.submit(makeRequest(RequestPriority::Normal, now + std::chrono::hours(2)));
+    const int soon = queue.submit(makeRequest(RequestPriority::Normal, now + std::chrono::hours(1)));
+    const int sameAsSoon = queue.submit(makeRequest(RequestPriority::Normal, now + std::chrono::hours(1)));
+    const int urgentBulk = queue.submit(makeRequest(RequestPriority::Bulk, now + std::chrono::minutes(1)));
+    check(drain(queue) == std::vector<int>{soon, sameAsSoon, late, noDeadline, urgentBulk},
+          "within a class: earliest deadline, then submission order");
+}
+
+void testExpiryAndQueuedCancel() {
+    const auto now = Clock::now();
+    Queue queue;
+    const int expired = queue.submit(makeRequest(RequestPriority::Interactive, now - std::chrono::seconds(1)));
+    const int cancelled = queue.submit(makeRequest(RequestPriority::Interactive));
+    const int kept = queue.submit(makeRequest(RequestPriority::Bulk, now + std::chrono::hours(1)));
+    check(queue.cancel(cancelled), "cancel() finds a queued request");
+    check(!queue.cancel(1000), "cancel() of an unknown id returns false");
+
+    std::vector<std::pair<int, RequestStatus>> dropped;
+    queue.dropQueued(now, [&](int id, RequestStatus status) { dropped.emplace_back(id, status); });
+    check(dropped == std::vector<std::pair<int, RequestStatus>>{{expired, RequestStatus::Expired},
+                                                                {cancelled, RequestStatus::Cancelled}},
+          "dropQueued() reports expired and cancelled requests");
+    check(queue.status(expired) == RequestStatus::Unknown && queue.status(kept) == RequestStatus::Queued,
+          "dropped requests leave the queue, the rest stay");
+}
+
+void testActiveCancel() {
+    Queue queue;
+    Entries active;
+    for (int i = 0; i < 3; ++i) queue.submit(makeRequest(RequestPriority::Normal));
+    admit(queue, active, 3);
+
+    active[1]->request.cancellation.cancel();
+    Entries cancelled;
+    queue.takeCancelled(active, cancelled);
+    check(cancelled.size() == 1 && cancelled[0]->id == 1 && activeIds(active) == std::vector<int>{0, 2},
+          "takeCancelled() moves cancelled active entries out");
+}
+
+void testPreemptAndResume() {
+    Queue queue;
+    Entries active;
+    const int bulk = queue.submit(makeRequest(RequestPriority::Bulk));
+    admit(queue, active, 1);
+
+    const int normal = queue.submit(makeRequest(RequestPriority::Normal));
+    check(admit(queue, active, 1) == std::vector<int>{normal} && activeIds(active) == std::vector<int>{normal},
+          "a better request preempts a full batch");
+    check(queue.status(bulk) == RequestStatus::Paused && queue.pausedCount() == 1, "the preempted request is paused");
+
+    const int sameClass = queue.submit(makeRequest(RequestPriority::Normal));
+    check(admit(queue, active, 1).empty() && queue.status(sameClass) == RequestStatus::Queued,
+          "an equal-priority request does not preempt");
+
+    // Paused requests keep their state and come back without a prefill
+    active.clear();
+    check(admit(queue, active, 1) == std::vector<int>{sameClass}, "the better queued request goes before a paused one");
+    active.clear();
+    check(admit(queue, active, 1).empty() && activeIds(active) == std::vector<int>{bulk} && queue.empty(),
+          "the paused request resumes into active");
+}
+
+void testPausedTiesAndOrder() {
+    Queue queue;
+    Entries active;
+    const int first = queue.submit(makeRequest(RequestPriority::Bulk));
+    const int second = queue.submit(makeRequest(RequestPriority::Bulk));
+    admit(queue, active, 2);
+
+    // Each preemption pauses the most recently submitted of the worst class
+    const int a = queue.submit(makeRequest(RequestPriority::Interactive));
+    const int b = queue.submit(makeRequest(RequestPriority::Interactive));
+    check(admit(queue, active, 2) == std::vector<int>{a, b}, "two interactive requests preempt both bulk ones");
+
+    const int queuedBulk = queue.submit(makeRequest(RequestPriority::Bulk));
+    active.clear();
+    admit(queue, active, 1);
+    check(activeIds(active) == std::vector<int>{second}, "paused requests resume oldest paused first");
+    active.clear();
+    admit(queue, active, 1);
+    check(activeIds(active) == std::vector<int>{first}, "a paused request wins a tie with a queued one");
+    active.clear();
+    check(admit(queue, active, 1) == std::vector<int>{queuedBulk}, "then the queued request is admitted");
+
+    // Cancelling a paused request takes it out of the paused list
+    Queue other;
+    Entries running;
+    const int paused = other.submit(makeRequest(RequestPriority::Bulk));
+    admit(other, running, 1);
+    other.submit(makeRequest(RequestPriority::Interactive));
+    admit(other, running, 1);
+    check(other.cancel(paused), "cancel() finds a paused request");
+    Entries cancelled;
+    other.takeCancelled(running, cancelled);
+    check(cancelled.size() == 1 && cancelled[0]->id == paused && other.pausedCount() == 0,
+          "takeCancelled() moves cancelled paused entries out");
+}
+
+void testPreemptionVeto() {
+    Queue queue;
+    Entries active;
+    queue.submit(makeRequest(RequestPriority::Bulk));
+    admit(queue, active, 1);
+    active[0]->finished = true;  // Done generating, only waiting to be retired
+
+    const int interactive = queue.submit(makeRequest(RequestPriority::Interactive));
+    check(admit(queue, active, 1).empty() && queue.status(interactive) == RequestStatus::Queued &&
+          queue.pausedCount() == 0,
+          "entries the caller marks non-preemptible are never paused");
+}
+
+} // namespace
+
+int main() {
+    std::cout << "=== Pocket TTS Request Queue Test ===" << std::endl;
+
+    try {
+        testPriorityOrder();
+        testDeadlineOrder();
+        testExpiryAndQueuedCancel();
+        testActiveCancel();
+        testPreemptAndResume();
+        testPausedTiesAndOrder();
+        testPreemptionVeto();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << (failures ? "\nFAILED: " + std::to_string(failures) + " check(s)" : std::string("\nAll checks passed"))
+              << std::endl;
+    return failures ? 1 : 0;
+}
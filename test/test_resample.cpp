@@ -0,0 +1,159 @@
+#include "pocket_tts/audio_utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "[PASS] " : "[FAIL] ") << what << std::endl;
+    if (!ok) ++failures;
+}
+
+// Tones plus deterministic noise, within [-1, 1]
+std::vector<float> testSignal(size_t n, int rate) {
+    std::vector<float> x(n);
+    uint32_t state = 12345;
+    for (size_t i = 0; i < n; ++i) {
+        state = state * 1664525u + 1013904223u;
+        const double t = static_cast<double>(i) / rate;
+        const double noise = static_cast<double>(state >> 8) / (1 << 24) - 0.5;
+        x[i] = static_cast<float>(0.4 * std::sin(2 * 3.14159265358979 * 440 * t) +
+                                  0.3 * std::sin(2 * 3.14159265358979 * 3100 * t) + 0.2 * noise);
+    }
+    return x;
+}
+
+double lanczos(double x, int a) {
+    if (x == 0.0) return 1.0;
+    if (x < -a || x > a) return 0.0;
+    const double pi = 3.14159265358979323846;
+    return (std::sin(pi * x) / (pi * x)) * (std::sin(pi * x / a) / (pi * x / a));
+}
+
+// Per-sample Lanczos-8, the definition the polyphase bank tabulates
+std::vector<float> referenceResample(const std::vector<float>& input, int inRate, int outRate) {
+    constexpr int A = 8;
+    const double ratio = static_cast<double>(outRate) / inRate;
+    const double filterScale = std::min(ratio, 1.0);
+    const double radius = A / filterScale;
+    const int length = static_cast<int>(input.size());
+    std::vector<float> output(static_cast<size_t>(std::ceil(input.size() * ratio)));
+    for (size_t i = 0; i < output.size(); ++i) {
+        const double srcPos = static_cast<double>(i) * inRate / outRate;
+        const int center = static_cast<int>(std::floor(srcPos));
+        const double frac = srcPos - center;
+        double sample = 0.0;
+        double weightSum = 0.0;
+        for (int j = static_cast<int>(std::ceil(-radius + frac)); j <= static_cast<int>(std::floor(radius + frac)); ++j) {
+            const int idx = center + j;
+            if (idx < 0 || idx >= length) continue;
+            const double w = lanczos((j - frac) * filterScale, A);
+            sample += input[idx] * w;
+            weightSum += w;
+        }
+        output[i] = weightSum > 0.0 ? static_cast<float>(sample / weightSum) : 0.0f;
+    }
+    return output;
+}
+
+float maxAbsDiff(const std::vector<float>& a, const std::vector<float>& b) {
+    float diff = 0.0f;
+    for (size_t i = 0; i < std::min(a.size(), b.size()); ++i) {
+        diff = std::max(diff, std::abs(a[i] - b[i]));
+    }
+    return diff;
+}
+
+void testPolyphaseMatchesDirect() {
+    // The last pair has too many phases to tabulate and takes the direct path
+    const int pairs[][2] = {{16000, 24000}, {44100, 24000}, {24000, 8000}, {48000, 24000}, {22050, 24000},
+                            {24000, 44101}};
+    for (const auto& pair : pairs) {
+        const auto input = testSignal(5000, pair[0]);
+        const auto expected = referenceResample(input, pair[0], pair[1]);
+        const auto actual = pocket_tts::AudioUtils::resample(input, pair[0], pair[1]);
+        const std::string name = std::to_string(pair[0]) + " -> " + std::to_string(pair[1]);
+        check(actual.size() == expected.size(), name + ": output length");
+        check(maxAbsDiff(actual, expected) < 1e-4f, name + ": matches direct Lanczos-8");
+    }
+}
+
+void testThreadedMatchesSerial() {
+    const auto input = testSignal(300000, 16000);
+    const auto serial = pocket_tts::AudioUtils::resample(input, 16000, 24000, 1);
+    const auto threaded = pocket_tts::AudioUtils::resample(input, 16000, 24000, 4);
+    check(serial == threaded, "16000 -> 24000: threaded split is bit-exact");
+}
+
+void testStreamingMatchesWhole() {
+    const int pairs[][2] = {{24000, 48000}, {24000, 44100}, {24000, 16000}};
+    const size_t chunkSizes[] = {1, 7, 160, 4099, 20000};
+    for (const auto& pair : pairs) {
+        const auto input = testSignal(12000, pair[0]);
+        const auto whole = pocket_tts::AudioUtils::resample(input, pair[0], pair[1]);
+        pocket_tts::StreamingResampler resampler(pair[0], pair[1]);
+        for (size_t chunk : chunkSizes) {
+            // Twice per chunk size: flush() must leave the resampler ready for a new signal
+            for (int pass = 0; pass < 2; ++pass) {
+                std::vector<float> streamed;
+                for (size_t pos = 0; pos < input.size(); pos += chunk) {
+                    resampler.process(input.data() + pos, std::min(chunk, input.size() - pos), streamed);
+                }
+                resampler.flush(streamed);
+                check(streamed.size() == whole.size() && maxAbsDiff(streamed, whole) < 1e-6f,
+                      std::to_string(pair[0]) + " -> " + std::to_string(pair[1]) + ", chunks of " +
+                      std::to_string(chunk) + ", pass " + std::to_string(pass + 1) + ": matches resample()");
+            }
+        }
+    }
+
+    pocket_tts::StreamingResampler resampler(24000, 48000);
+    const auto input = testSignal(1000, 24000);
+    std::vector<float> discarded;
+    resampler.process(input.data(), 500, discarded);
+    resampler.reset();
+    std::vector<float> streamed;
+    resampler.process(input.data(), input.size(), streamed);
+    resampler.flush(streamed);
+    check(maxAbsDiff(streamed, pocket_tts::AudioUtils::resample(input, 24000, 48000)) < 1e-6f &&
+          streamed.size() == pocket_tts::AudioUtils::resample(input, 24000, 48000).size(),
+          "reset() discards buffered input");
+}
+
+void testInvalidRates() {
+    bool threw = false;
+    try {
+        pocket_tts::StreamingResampler resampler(0, 24000);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    check(threw, "StreamingResampler rejects a zero rate");
+}
+
+} // namespace
+
+int main() {
+    std::cout << "=== Pocket TTS Resampler Test ===" << std::endl;
+
+    try {
+        testPolyphaseMatchesDirect();
+        testThreadedMatchesSerial();
+        testStreamingMatchesWhole();
+        testInvalidRates();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << (failures ? "\nFAILED: " + std::to_string(failures) + " check(s)" : std::string("\nAll checks passed"))
+              << std::endl;
+    return failures ? 1 : 0;
+}
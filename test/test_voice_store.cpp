@@ -0,0 +1,234 @@
+#include "pocket_tts/voice_store.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "[PASS] " : "[FAIL] ") << what << std::endl;
+    if (!ok) ++failures;
+}
+
+// Header field offsets of the .ptv format (see voice_store.hpp)
+constexpr size_t MAGIC_OFFSET = 0;
+constexpr size_t VERSION_OFFSET = 8;
+constexpr size_t RANK_OFFSET = 12;
+constexpr size_t SHAPE_OFFSET = 16;
+constexpr size_t DATA_OFFSET_OFFSET = 56;
+constexpr size_t ELEMENT_COUNT_OFFSET = 64;
+constexpr size_t DATA_START = 128;
+
+std::filesystem::path tempDir() {
+    auto dir = std::filesystem::temp_directory_path() / "pocket_tts_test_voices";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+pocket_tts::VoiceEmbedding sampleVoice() {
+    pocket_tts::VoiceEmbedding voice;
+    voice.shape = {1, 3, 4};
+    for (int i = 0; i < 12; ++i) {
+        voice.embeddings.push_back(static_cast<float>(i) * 0.25f - 1.0f);
+    }
+    voice.sourceHash = pocket_tts::hashAudio(voice.embeddings.data(), voice.embeddings.size());
+    return voice;
+}
+
+bool sameVoice(const pocket_tts::VoiceEmbedding& a, const pocket_tts::VoiceEmbedding& b) {
+    return a.embeddings == b.embeddings && a.shape == b.shape && a.sourceHash == b.sourceHash &&
+           a.modelVersion == b.modelVersion;
+}
+
+std::vector<uint8_t> readBytes(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+void writeBytes(const std::string& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+template<typename T>
+void patch(std::vector<uint8_t>& bytes, size_t offset, T value) {
+    std::memcpy(bytes.data() + offset, &value, sizeof(value));
+}
+
+bool loadRejects(const std::string& path) {
+    try {
+        pocket_tts::loadVoice(path);
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void testRoundTrip(const std::filesystem::path& dir) {
+    const auto path = (dir / "voice.ptv").string();
+    const auto voice = sampleVoice();
+    pocket_tts::saveVoice(path, voice);
+    check(sameVoice(pocket_tts::loadVoice(path), voice), "saveVoice/loadVoice round-trip");
+    check(!std::filesystem::exists(path + ".tmp"), "no temporary file left behind");
+
+    auto renamed = voice;
+    renamed.modelVersion = "another-model";
+    renamed.shape = {12};
+    pocket_tts::saveVoice(path, renamed);
+    check(sameVoice(pocket_tts::loadVoice(path), renamed), "overwrite keeps the new shape and model version");
+
+    pocket_tts::VoiceEmbedding empty;
+    empty.shape = {1, 0, 1024};
+    pocket_tts::saveVoice(path, empty);
+    check(sameVoice(pocket_tts::loadVoice(path), empty), "empty voice round-trip");
+}
+
+void testSaveRejects(const std::filesystem::path& dir) {
+    const auto path = (dir / "bad.ptv").string();
+    auto saveRejects = [&](const pocket_tts::VoiceEmbedding& voice) {
+        try {
+            pocket_tts::saveVoice(path, voice);
+        } catch (const std::runtime_error&) {
+            return !std::filesystem::exists(path);
+        }
+        return false;
+    };
+
+    auto mismatched = sampleVoice();
+    mismatched.shape = {1, 4, 4};
+    check(saveRejects(mismatched), "saveVoice rejects a shape that doesn't match the embeddings");
+
+    auto negative = sampleVoice();
+    negative.shape = {-1, -12};
+    check(saveRejects(negative), "saveVoice rejects negative dims");
+
+    auto noShape = sampleVoice();
+    noShape.shape = {};
+    check(saveRejects(noShape), "saveVoice rejects an empty shape");
+
+    auto tooManyDims = sampleVoice();
+    tooManyDims.shape = {1, 1, 1, 3, 4};
+    check(saveRejects(tooManyDims), "saveVoice rejects more than 4 dims");
+}
+
+void testCorrupt(const std::filesystem::path& dir) {
+    const auto goodPath = (dir / "good.ptv").string();
+    pocket_tts::saveVoice(goodPath, sampleVoice());
+    const auto good = readBytes(goodPath);
+    const auto path = (dir / "corrupt.ptv").string();
+
+    auto expectRejected = [&](const std::vector<uint8_t>& bytes, const std::string& what) {
+        writeBytes(path, bytes);
+        check(loadRejects(path), "loadVoice rejects " + what);
+    };
+
+    auto bytes = good;
+    bytes[MAGIC_OFFSET] = 'X';
+    expectRejected(bytes, "a bad magic");
+
+    bytes = good;
+    patch<uint32_t>(bytes, VERSION_OFFSET, pocket_tts::VOICE_FILE_FORMAT_VERSION + 1);
+    expectRejected(bytes, "an unknown format version");
+
+    expectRejected(std::vector<uint8_t>(good.begin(), good.begin() + 40), "a truncated header");
+    expectRejected(std::vector<uint8_t>(good.begin(), good.end() - 4), "truncated data");
+
+    bytes = good;
+    patch<uint32_t>(bytes, RANK_OFFSET, 0);
+    expectRejected(bytes, "rank 0");
+
+    bytes = good;
+    patch<uint32_t>(bytes, RANK_OFFSET, 5);
+    expectRejected(bytes, "rank above 4");
+
+    bytes = good;
+    patch<int64_t>(bytes, SHAPE_OFFSET + 8, 4);
+    expectRejected(bytes, "a shape that doesn't match elementCount");
+
+    bytes = good;
+    patch<int64_t>(bytes, SHAPE_OFFSET, -1);
+    patch<int64_t>(bytes, SHAPE_OFFSET + 8, -3);
+    expectRejected(bytes, "negative dims");
+
+    // 4 * (2^62 + 3) wraps to the stored element count, 12
+    bytes = good;
+    patch<int64_t>(bytes, SHAPE_OFFSET, 4);
+    patch<int64_t>(bytes, SHAPE_OFFSET + 8, (int64_t{1} << 62) + 3);
+    patch<int64_t>(bytes, SHAPE_OFFSET + 16, 1);
+    expectRejected(bytes, "dims whose product overflows");
+
+    bytes = good;
+    patch<int64_t>(bytes, SHAPE_OFFSET + 8, int64_t{1} << 40);
+    patch<uint64_t>(bytes, ELEMENT_COUNT_OFFSET, uint64_t{4} << 40);
+    expectRejected(bytes, "an element count beyond the file");
+
+    bytes = good;
+    patch<uint64_t>(bytes, DATA_OFFSET_OFFSET, 16);
+    expectRejected(bytes, "a data offset inside the header");
+
+    bytes = good;
+    patch<uint64_t>(bytes, DATA_OFFSET_OFFSET, ~uint64_t{0} - 8);
+    expectRejected(bytes, "a data offset beyond the file");
+
+    check(loadRejects((dir / "missing.ptv").string()), "loadVoice rejects a missing file");
+
+    // An unaligned data offset is still read correctly
+    bytes = good;
+    bytes.insert(bytes.begin() + DATA_START, 2, 0);
+    patch<uint64_t>(bytes, DATA_OFFSET_OFFSET, DATA_START + 2);
+    writeBytes(path, bytes);
+    check(sameVoice(pocket_tts::loadVoice(path), sampleVoice()), "loadVoice reads an unaligned data offset");
+}
+
+void testLibrary(const std::filesystem::path& dir) {
+    const auto libraryDir = (dir / "library").string();
+    const auto voice = sampleVoice();
+    {
+        pocket_tts::VoiceLibrary library(libraryDir);
+        check(!library.contains(voice.sourceHash), "new library is empty");
+        library.put(voice);
+        check(library.contains(voice.sourceHash), "put() makes the voice available");
+    }
+    // A stray file that isn't named by a hash is ignored
+    writeBytes((std::filesystem::path(libraryDir) / "notes.ptv").string(), {1, 2, 3});
+
+    pocket_tts::VoiceLibrary reopened(libraryDir);
+    const auto hashes = reopened.list();
+    check(hashes.size() == 1 && hashes[0] == voice.sourceHash, "reopened library lists the saved voice only");
+    const auto loaded = reopened.get(voice.sourceHash);
+    check(loaded && sameVoice(*loaded, voice), "get() loads the saved voice");
+    check(!reopened.get(voice.sourceHash + 1), "get() of an unknown hash returns null");
+}
+
+} // namespace
+
+int main() {
+    std::cout << "=== Pocket TTS Voice Store Test ===" << std::endl;
+
+    const auto dir = tempDir();
+    try {
+        testRoundTrip(dir);
+        testSaveRejects(dir);
+        testCorrupt(dir);
+        testLibrary(dir);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        std::filesystem::remove_all(dir);
+        return 1;
+    }
+    std::filesystem::remove_all(dir);
+
+    std::cout << (failures ? "\nFAILED: " + std::to_string(failures) + " check(s)" : std::string("\nAll checks passed"))
+              << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,260 @@
+#include "pocket_tts/audio_utils.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "[PASS] " : "[FAIL] ") << what << std::endl;
+    if (!ok) ++failures;
+}
+
+void put16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+void put32(std::vector<uint8_t>& out, uint32_t v) {
+    put16(out, static_cast<uint16_t>(v));
+    put16(out, static_cast<uint16_t>(v >> 16));
+}
+
+void putId(std::vector<uint8_t>& out, const char* id) {
+    out.insert(out.end(), id, id + 4);
+}
+
+struct WavSpec {
+    uint16_t format = 1;             // 1 = PCM, 3 = float, 0xFFFE = extensible
+    uint16_t subFormat = 1;          // Format tag in the extensible GUID
+    uint16_t channels = 1;
+    uint32_t sampleRate = 24000;
+    uint16_t bitsPerSample = 16;
+    uint16_t blockAlign = 0xFFFF;    // 0xFFFF = channels * bytes per sample
+    int64_t declaredDataSize = -1;   // < 0 = the real size
+    bool oddChunkFirst = false;      // An odd-sized LIST chunk before fmt
+};
+
+std::vector<uint8_t> makeWav(const WavSpec& spec, const std::vector<uint8_t>& data) {
+    const bool extensible = spec.format == 0xFFFE;
+    std::vector<uint8_t> out;
+    putId(out, "RIFF");
+    put32(out, 0);  // Patched below
+    putId(out, "WAVE");
+    if (spec.oddChunkFirst) {
+        putId(out, "LIST");
+        put32(out, 3);
+        out.insert(out.end(), {'a', 'b', 'c', 0});  // Plus the pad byte
+    }
+    putId(out, "fmt ");
+    put32(out, extensible ? 40 : 16);
+    put16(out, spec.format);
+    put16(out, spec.channels);
+    put32(out, spec.sampleRate);
+    const uint16_t blockAlign = spec.blockAlign != 0xFFFF
+        ? spec.blockAlign : static_cast<uint16_t>(spec.channels * (spec.bitsPerSample / 8));
+    put32(out, spec.sampleRate * blockAlign);
+    put16(out, blockAlign);
+    put16(out, spec.bitsPerSample);
+    if (extensible) {
+        put16(out, 22);                  // cbSize
+        put16(out, spec.bitsPerSample);  // Valid bits
+        put32(out, 0);                   // Channel mask
+        put16(out, spec.subFormat);
+        out.insert(out.end(), 14, 0);    // Rest of the GUID
+    }
+    putId(out, "data");
+    put32(out, static_cast<uint32_t>(spec.declaredDataSize < 0 ? data.size() : spec.declaredDataSize));
+    out.insert(out.end(), data.begin(), data.end());
+    const uint32_t riffSize = static_cast<uint32_t>(out.size() - 8);
+    std::memcpy(&out[4], &riffSize, 4);
+    return out;
+}
+
+std::string writeFile(const std::string& name, const std::vector<uint8_t>& bytes) {
+    const auto path = (std::filesystem::temp_directory_path() / ("pocket_tts_test_" + name + ".wav")).string();
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return path;
+}
+
+std::vector<float> load(const std::string& name, const WavSpec& spec, const std::vector<uint8_t>& data,
+                        size_t maxSamples = 0) {
+    const auto path = writeFile(name, makeWav(spec, data));
+    auto audio = pocket_tts::AudioUtils::loadWav(path, spec.sampleRate, maxSamples);
+    std::filesystem::remove(path);
+    return audio;
+}
+
+bool rejects(const std::string& name, const std::vector<uint8_t>& bytes) {
+    const auto path = writeFile(name, bytes);
+    bool threw = false;
+    try {
+        pocket_tts::AudioUtils::loadWav(path);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    std::filesystem::remove(path);
+    return threw;
+}
+
+bool near(const std::vector<float>& actual, const std::vector<float>& expected, float tolerance = 1e-6f) {
+    if (actual.size() != expected.size()) return false;
+    for (size_t i = 0; i < actual.size(); ++i) {
+        if (std::abs(actual[i] - expected[i]) > tolerance) return false;
+    }
+    return true;
+}
+
+void testBitDepths() {
+    WavSpec u8;
+    u8.bitsPerSample = 8;
+    check(near(load("u8", u8, {128, 192, 64, 160}), {0.0f, 0.5f, -0.5f, 0.25f}), "PCM 8-bit (unsigned)");
+
+    // 0x200000 = 0.25, 0xE00000 = -0.25, 0x000001 = 2^-23
+    WavSpec s24;
+    s24.bitsPerSample = 24;
+    check(near(load("s24", s24, {0x00, 0x00, 0x20, 0x00, 0x00, 0xE0, 0x01, 0x00, 0x00}),
+               {0.25f, -0.25f, 1.0f / 8388608.0f}),
+          "PCM 24-bit, sign extended");
+
+    // Stereo frames average to mono
+    WavSpec stereo24 = s24;
+    stereo24.channels = 2;
+    check(near(load("s24_stereo", stereo24, {0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE0, 0x00, 0x00, 0xE0}),
+               {0.125f, -0.25f}),
+          "PCM 24-bit stereo downmix");
+
+    WavSpec f64;
+    f64.format = 3;
+    f64.bitsPerSample = 64;
+    std::vector<uint8_t> data(16);
+    const double values[] = {0.375, -0.125};
+    std::memcpy(data.data(), values, sizeof(values));
+    check(near(load("f64", f64, data), {0.375f, -0.125f}), "IEEE float 64-bit");
+}
+
+void testExtensible() {
+    WavSpec pcm;
+    pcm.format = 0xFFFE;
+    pcm.subFormat = 1;
+    pcm.channels = 2;
+    std::vector<uint8_t> data;
+    put16(data, 0x2000);  // 0.25
+    put16(data, 0x1000);  // 0.125
+    check(near(load("ext_pcm", pcm, data), {0.1875f}), "EXTENSIBLE PCM 16-bit stereo");
+
+    WavSpec flt = pcm;
+    flt.subFormat = 3;
+    flt.channels = 1;
+    flt.bitsPerSample = 32;
+    std::vector<uint8_t> floats(8);
+    const float values[] = {0.5f, -0.5f};
+    std::memcpy(floats.data(), values, sizeof(values));
+    check(near(load("ext_float", flt, floats), {0.5f, -0.5f}), "EXTENSIBLE IEEE float 32-bit");
+
+    WavSpec unsupported = pcm;
+    unsupported.subFormat = 2;  // ADPCM
+    check(rejects("ext_adpcm", makeWav(unsupported, data)), "EXTENSIBLE with an unsupported sub-format is rejected");
+
+    // Declared extensible but only 16 bytes of fmt
+    auto shortFmt = makeWav(WavSpec{}, data);
+    shortFmt[20] = 0xFE;
+    shortFmt[21] = 0xFF;
+    check(rejects("ext_short", shortFmt), "EXTENSIBLE without its extension is rejected");
+}
+
+void testLayoutQuirks() {
+    WavSpec zeroAlign;
+    zeroAlign.blockAlign = 0;
+    std::vector<uint8_t> data;
+    put16(data, 0x2000);
+    put16(data, 0xE000);
+    check(near(load("zero_align", zeroAlign, data), {0.25f, -0.25f}), "blockAlign of zero uses the packed frame size");
+
+    WavSpec odd;
+    odd.oddChunkFirst = true;
+    check(near(load("odd_chunk", odd, data), {0.25f, -0.25f}), "odd-sized chunk before fmt is skipped with its pad byte");
+
+    check(load("max_samples", WavSpec{}, data, 1).size() == 1, "maxSamples limits the output");
+
+    // 65535 channels of 64-bit samples: a frame is larger than uint16_t
+    WavSpec wide;
+    wide.format = 3;
+    wide.bitsPerSample = 64;
+    wide.channels = 65535;
+    wide.blockAlign = 0;
+    std::vector<uint8_t> frame(static_cast<size_t>(wide.channels) * 8);
+    const double first = 0.5 * wide.channels;  // The rest are zero
+    std::memcpy(frame.data(), &first, sizeof(first));
+    check(near(load("wide", wide, frame), {0.5f}), "65535-channel frame");
+}
+
+void testTruncated() {
+    std::vector<uint8_t> data;
+    for (int16_t v : {0x1000, 0x2000, 0x3000}) put16(data, static_cast<uint16_t>(v));
+
+    WavSpec claimsMore;
+    claimsMore.declaredDataSize = 1000;
+    check(near(load("truncated_data", claimsMore, data), {0.125f, 0.25f, 0.375f}),
+          "data chunk cut short keeps the samples present");
+
+    WavSpec streaming;
+    streaming.declaredDataSize = 0xFFFFFFFF;
+    check(near(load("streaming_size", streaming, data), {0.125f, 0.25f, 0.375f}),
+          "0xFFFFFFFF data size reads to the end of the file");
+
+    auto partialFrame = makeWav(WavSpec{}, data);
+    partialFrame.pop_back();
+    const auto path = writeFile("partial_frame", partialFrame);
+    check(near(pocket_tts::AudioUtils::loadWav(path), {0.125f, 0.25f}), "trailing partial frame is dropped");
+    std::filesystem::remove(path);
+
+    const auto whole = makeWav(WavSpec{}, data);
+    check(rejects("riff_only", std::vector<uint8_t>(whole.begin(), whole.begin() + 8)), "file shorter than RIFF header");
+    check(rejects("fmt_cut", std::vector<uint8_t>(whole.begin(), whole.begin() + 28)), "file cut inside fmt");
+    check(rejects("no_data", std::vector<uint8_t>(whole.begin(), whole.begin() + 36)), "file without a data chunk");
+    check(rejects("empty_data", makeWav(WavSpec{}, {0x00})), "data chunk shorter than one frame");
+
+    auto notWave = whole;
+    notWave[8] = 'X';
+    check(rejects("not_wave", notWave), "non-WAVE RIFF file");
+
+    WavSpec bits12;
+    bits12.bitsPerSample = 12;
+    check(rejects("bits12", makeWav(bits12, data)), "unsupported bit depth");
+
+    WavSpec noChannels;
+    noChannels.channels = 0;
+    noChannels.blockAlign = 2;
+    check(rejects("no_channels", makeWav(noChannels, data)), "zero channels");
+}
+
+} // namespace
+
+int main() {
+    std::cout << "=== Pocket TTS WAV Parsing Test ===" << std::endl;
+
+    try {
+        testBitDepths();
+        testExtensible();
+        testLayoutQuirks();
+        testTruncated();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << (failures ? "\nFAILED: " + std::to_string(failures) + " check(s)" : std::string("\nAll checks passed"))
+              << std::endl;
+    return failures ? 1 : 0;
+}